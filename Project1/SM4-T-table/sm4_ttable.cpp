@@ -0,0 +1,186 @@
+#include <string.h>
+#include "sm4_ttable.h"
+#include "../SM4-aesni/sm4_sbox.h"
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_ULONG_BE 
+#define GET_ULONG_BE(n,b,i)                   \
+{                                             \
+    (n) = ( (u32) (b)[(i)    ] << 24 )        \
+        | ( (u32) (b)[(i) + 1] << 16 )        \
+        | ( (u32) (b)[(i) + 2] <<  8 )        \
+        | ( (u32) (b)[(i) + 3]       );       \
+}
+#endif
+
+#ifndef PUT_ULONG_BE
+#define PUT_ULONG_BE(n,b,i)          \
+{                                    \
+    (b)[(i)    ] = ((u8*)&(n))[3];   \
+	(b)[(i) + 1] = ((u8*)&(n))[2];   \
+    (b)[(i) + 2] = ((u8*)&(n))[1];   \
+    (b)[(i) + 3] = ((u8*)&(n))[0];   \
+}
+#endif
+
+ /*
+  *rotate shift right marco definition
+  *
+  */
+#define ROTR(x,n) (((x) >> n) | ((x) << (32 - n)))
+
+/*
+ * ұڱΨһ S  (sm4_sbox.h) Ա任 L , ģѡ:
+ *   SM4_TTABLE_4X1K    Tk[x] = L(S[x] << (24 - 8k)), 4 Ź 4KB, ÿ 4 β + 3 
+ *   SM4_TTABLE_1K_ROT  ֻ T0 (1KB); L ѭλɽ, Tk[x] = ROTR(T0[x], 8k)
+ *   SM4_TTABLE_SBOX_L  ֻ 256 ֽ S ,  L
+ * ԽС L1 ռԽ, ÿָԽ
+ */
+static constexpr u8 SM4_Sbox[256] = { SM4_SBOX_VALUES };
+
+static constexpr u32 sm4_rotl(u32 x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+static constexpr u32 sm4_L(u32 b)
+{
+    return b ^ sm4_rotl(b, 2) ^ sm4_rotl(b, 10) ^ sm4_rotl(b, 18) ^ sm4_rotl(b, 24);
+}
+
+template <int Tables>
+struct sm4_ttable_data
+{
+    u32 t[Tables][256];
+};
+
+/* C++14 constexpr ѭ, űΪŽֻݶ */
+template <int Tables>
+static constexpr sm4_ttable_data<Tables> sm4_make_ttable()
+{
+    sm4_ttable_data<Tables> d = {};
+    for (int k = 0; k < Tables; k++)
+        for (int x = 0; x < 256; x++)
+            d.t[k][x] = sm4_L((u32)SM4_Sbox[x] << (24 - 8 * k));
+    return d;
+}
+
+static constexpr sm4_ttable_data<4> SM4_T4 = sm4_make_ttable<4>();
+static constexpr sm4_ttable_data<1> SM4_T1 = sm4_make_ttable<1>();
+
+static_assert(SM4_T4.t[3][0x00] == sm4_L(0xd6), "T3 must be L(S[x])");
+static_assert(SM4_T4.t[1][0xff] == ROTR(SM4_T1.t[0][0xff], 8),
+    "Tk must be T0 rotated right by 8k");
+
+/* ֺ T(x) = L(tau(x)) ڸµʵ */
+template <int Layout>
+struct sm4_round;
+
+template <>
+struct sm4_round<SM4_TTABLE_4X1K>
+{
+    static inline u32 T(u32 ka)
+    {
+        return SM4_T4.t[0][ka >> 24]
+            ^ SM4_T4.t[1][(ka >> 16) & 0xff]
+            ^ SM4_T4.t[2][(ka >> 8) & 0xff]
+            ^ SM4_T4.t[3][ka & 0xff];
+    }
+};
+
+template <>
+struct sm4_round<SM4_TTABLE_1K_ROT>
+{
+    static inline u32 T(u32 ka)
+    {
+        const u32* t0 = SM4_T1.t[0];
+        return t0[ka >> 24]
+            ^ ROTR(t0[(ka >> 16) & 0xff], 8)
+            ^ ROTR(t0[(ka >> 8) & 0xff], 16)
+            ^ ROTR(t0[ka & 0xff], 24);
+    }
+};
+
+template <>
+struct sm4_round<SM4_TTABLE_SBOX_L>
+{
+    static inline u32 T(u32 ka)
+    {
+        u32 bb = ((u32)SM4_Sbox[ka >> 24] << 24)
+            | ((u32)SM4_Sbox[(ka >> 16) & 0xff] << 16)
+            | ((u32)SM4_Sbox[(ka >> 8) & 0xff] << 8)
+            | (u32)SM4_Sbox[ka & 0xff];
+        return sm4_L(bb);
+    }
+};
+
+/*
+ * SM4-ECB block encryption/decryption
+ */
+template <int Layout>
+static void sm4_crypt(const SM4_Key* key, int enc,
+    const u8 input[SM4_BLOCK_SIZE],
+    u8 output[SM4_BLOCK_SIZE])
+{
+    u32 i = 0;
+    u32 ka = 0;
+    u32 t0, t1, t2, t3, t4;
+    const u32* rk = (enc == 0) ? key->rk : key->rk_dec;
+
+    GET_ULONG_BE(t0, input, 0)
+        GET_ULONG_BE(t1, input, 4)
+        GET_ULONG_BE(t2, input, 8)
+        GET_ULONG_BE(t3, input, 12)
+
+        while (i < 32)
+        {
+            ka = t1 ^ t2 ^ t3 ^ rk[i];
+            t0 ^= sm4_round<Layout>::T(ka);
+
+            t4 = t0; t0 = t1;
+            t1 = t2; t2 = t3;
+            t3 = t4;
+            ++i;
+        }
+    PUT_ULONG_BE(t3, output, 0);
+    PUT_ULONG_BE(t2, output, 4);
+    PUT_ULONG_BE(t1, output, 8);
+    PUT_ULONG_BE(t0, output, 12);
+}
+
+template <int Layout>
+static void sm4_crypt_blocks(const SM4_Key* key, const u8* in, u8* out,
+    size_t nblocks, int enc)
+{
+    size_t i;
+
+    /* sm4_crypt д, in  out ͬ */
+    for (i = 0; i < nblocks; i++)
+    {
+        sm4_crypt<Layout>(key, enc, in + SM4_BLOCK_SIZE * i, out + SM4_BLOCK_SIZE * i);
+    }
+}
+
+void sm4_ttable_crypt_blocks(const SM4_Key* key, const u8* in, u8* out,
+    size_t nblocks, int enc)
+{
+    sm4_crypt_blocks<SM4_TTABLE_LAYOUT>(key, in, out, nblocks, enc);
+}
+
+void sm4_ttable_crypt_blocks_layout(const SM4_Key* key, const u8* in, u8* out,
+    size_t nblocks, int enc, int layout)
+{
+    switch (layout)
+    {
+    case SM4_TTABLE_1K_ROT:
+        sm4_crypt_blocks<SM4_TTABLE_1K_ROT>(key, in, out, nblocks, enc);
+        break;
+    case SM4_TTABLE_SBOX_L:
+        sm4_crypt_blocks<SM4_TTABLE_SBOX_L>(key, in, out, nblocks, enc);
+        break;
+    default:
+        sm4_crypt_blocks<SM4_TTABLE_4X1K>(key, in, out, nblocks, enc);
+        break;
+    }
+}
\ No newline at end of file
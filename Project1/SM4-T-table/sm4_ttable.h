@@ -2,51 +2,47 @@
 #ifndef XYSSL_SM4_H
 #define XYSSL_SM4_H
 
-#define SM4_ENCRYPT     1
-#define SM4_DECRYPT     0
 #define SM4_KEY_SIZE    16
 #define SM4_BLOCK_SIZE  16
 
 
 typedef unsigned int u32;
 typedef unsigned char u8;
-typedef struct
-{
-    u32 sk[32];       /*!<  SM4 subkeys       */
-    int mode;                   /*!<  encrypt/decrypt   */
-}
-sm4_context;
 
+#include "../SM4-aesni/sm4_aesni.h"
+
+/* ұ,  sm4_ttable.cpp */
+#define SM4_TTABLE_4X1K     0   /* 4  1KB  */
+#define SM4_TTABLE_1K_ROT   1   /* 1  1KB  + ѭλ */
+#define SM4_TTABLE_SBOX_L   2   /* 256 ֽ S  + Ա任 L */
+
+/* ʹõĲ, ڱʱ -DSM4_TTABLE_LAYOUT=... Ŀ CPU ָ */
+#ifndef SM4_TTABLE_LAYOUT
+#define SM4_TTABLE_LAYOUT   SM4_TTABLE_4X1K
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
     /**
-     * \brief          SM4 key schedule (128-bit, encryption)
-     *
-     * \param ctx      SM4 context to be initialized
-     * \param key      16-byte secret key
-     */
-    void sm4_setkey_enc(sm4_context* ctx, const u8 key[SM4_KEY_SIZE]);
-
-    /**
-     * \brief          SM4 key schedule (128-bit, decryption)
-     *
-     * \param ctx      SM4 context to be initialized
-     * \param key      16-byte secret key
+     * \brief          SM4 T-table ECB, Ϊͳһ T 
+     *                 (Կ SM4_KeyInit )
+     * \param key      SM4 key
+     * \param in       input blocks
+     * \param out      output blocks, may equal in
+     * \param nblocks  number of 16-byte blocks
+     * \param enc      0: encrypt, 1: decrypt
      */
-    void sm4_setkey_dec(sm4_context* ctx, const u8 key[SM4_KEY_SIZE]);
+    void sm4_ttable_crypt_blocks(const SM4_Key* key, const u8* in, u8* out,
+        size_t nblocks, int enc);
 
     /**
-     * \brief          SM4 one block encryption/decryption
-     * \param ctx      SM4 context
-     * \param input    input block  //
-     * \param output   output block
+     * \brief          ͬ, ʱָұ (SM4_TTABLE_*), ڱȽ
+     *                 L1 ռָ
      */
-    void sm4_crypt(sm4_context* ctx,
-        const u8 input[SM4_BLOCK_SIZE],
-        u8 output[SM4_BLOCK_SIZE]);
+    void sm4_ttable_crypt_blocks_layout(const SM4_Key* key, const u8* in, u8* out,
+        size_t nblocks, int enc, int layout);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sm4_ttable.h"
+
+int main() {
+    SM4_Key sm4_key;
+    unsigned char key[16] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    unsigned char plaintext[16] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    unsigned char ciphertext[16];
+    unsigned char decrypted_text[16];
+    int i;
+
+    clock_t start, end;
+    double cpu_time_used;
+    const int iterations = 100000; // ѭ
+
+    // 1. Կչʱ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        SM4_KeyInit(key, &sm4_key);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("Կչƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // 2. ܹ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        sm4_ttable_crypt_blocks(&sm4_key, plaintext, ciphertext, 1, 0);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    printf("ԭʼ (Plaintext): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", plaintext[i]);
+    }
+    printf("\n\n");
+
+    printf("ܽ (Ciphertext): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", ciphertext[i]);
+    }
+    printf("\n\n");
+
+    // 3. ܹ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        sm4_ttable_crypt_blocks(&sm4_key, ciphertext, decrypted_text, 1, 1);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // 4. ܽ
+    printf("ܽ (Decrypted Text): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", decrypted_text[i]);
+    }
+    printf("\n\n");
+
+    // 5. ֤ܽ
+    if (memcmp(plaintext, decrypted_text, 16) == 0) {
+        printf("֤ɹܽԭʼһ¡\n");
+    }
+    else {
+        printf("֤ʧܣܽԭʼĲһ£\n");
+    }
+
+
+    // 6. ұ: һ, Ƚ 64KB ݵļʱ
+    {
+        static const char* names[3] = { "4x1KB", "1KB+λ", "S+L" };
+        static unsigned char buf[64 * 1024], tmp[64 * 1024], out[3][64 * 1024];
+        const int rounds = 200;
+        int layout;
+        for (i = 0; i < (int)sizeof(buf); i++) buf[i] = (unsigned char)(i * 31);
+        for (layout = SM4_TTABLE_4X1K; layout <= SM4_TTABLE_SBOX_L; layout++) {
+            sm4_ttable_crypt_blocks_layout(&sm4_key, buf, out[layout], sizeof(buf) / 16,
+                0, layout);
+            start = clock();
+            for (i = 0; i < rounds; ++i) {
+                sm4_ttable_crypt_blocks_layout(&sm4_key, buf, tmp, sizeof(buf) / 16,
+                    0, layout);
+            }
+            end = clock();
+            cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+            printf(" %-8s: %.2f MB/s%s\n", names[layout],
+                (double)sizeof(buf) * rounds / 1e6 / cpu_time_used,
+                (layout == SM4_TTABLE_LAYOUT) ? " (Ĭ)" : "");
+        }
+        if (memcmp(out[0], out[1], sizeof(buf)) == 0 &&
+            memcmp(out[0], out[2], sizeof(buf)) == 0) {
+            printf("ֽһ\n");
+        }
+        else {
+            printf("ֽһ£\n");
+        }
+    }
+    return 0;
+}
\ No newline at end of file
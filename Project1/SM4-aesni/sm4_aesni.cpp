@@ -4,7 +4,15 @@
 #include <immintrin.h>
 #include <time.h> 
 #include "sm4_aesni.h"
+#include "sm4_bitslice.h"
+#include "sm4_sbox.h"
+#include "../SM4-T-table/sm4_ttable.h"
 #include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
 // sm4.c 
 static uint32_t FK[4] = { 0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc };
 static uint32_t CK[32] = {
@@ -14,29 +22,7 @@ static uint32_t CK[32] = {
     0xf8ff060d, 0x141b2229, 0x30373e45, 0x4c535a61, 0x686f767d, 0x848b9299,
     0xa0a7aeb5, 0xbcc3cad1, 0xd8dfe6ed, 0xf4fb0209, 0x10171e25, 0x2c333a41,
     0x484f565d, 0x646b7279 };
-static uint8_t SBox[256] = {
-    0xD6, 0x90, 0xE9, 0xFE, 0xCC, 0xE1, 0x3D, 0xB7, 0x16, 0xB6, 0x14, 0xC2,
-    0x28, 0xFB, 0x2C, 0x05, 0x2B, 0x67, 0x9A, 0x76, 0x2A, 0xBE, 0x04, 0xC3,
-    0xAA, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99, 0x9C, 0x42, 0x50, 0xF4,
-    0x91, 0xEF, 0x98, 0x7A, 0x33, 0x54, 0x0B, 0x43, 0xED, 0xCF, 0xAC, 0x62,
-    0xE4, 0xB3, 0x1C, 0xA9, 0xC9, 0x08, 0xE8, 0x95, 0x80, 0xDF, 0x94, 0xFA,
-    0x75, 0x8F, 0x3F, 0xA6, 0x47, 0x07, 0xA7, 0xFC, 0xF3, 0x73, 0x17, 0xBA,
-    0x83, 0x59, 0x3C, 0x19, 0xE6, 0x85, 0x4F, 0xA8, 0x68, 0x6B, 0x81, 0xB2,
-    0x71, 0x64, 0xDA, 0x8B, 0xF8, 0xEB, 0x0F, 0x4B, 0x70, 0x56, 0x9D, 0x35,
-    0x1E, 0x24, 0x0E, 0x5E, 0x63, 0x58, 0xD1, 0xA2, 0x25, 0x22, 0x7C, 0x3B,
-    0x01, 0x21, 0x78, 0x87, 0xD4, 0x00, 0x46, 0x57, 0x9F, 0xD3, 0x27, 0x52,
-    0x4C, 0x36, 0x02, 0xE7, 0xA0, 0xC4, 0xC8, 0x9E, 0xEA, 0xBF, 0x8A, 0xD2,
-    0x40, 0xC7, 0x38, 0xB5, 0xA3, 0xF7, 0xF2, 0xCE, 0xF9, 0x61, 0x15, 0xA1,
-    0xE0, 0xAE, 0x5D, 0xA4, 0x9B, 0x34, 0x1A, 0x55, 0xAD, 0x93, 0x32, 0x30,
-    0xF5, 0x8C, 0xB1, 0xE3, 0x1D, 0xF6, 0xE2, 0x2E, 0x82, 0x66, 0xCA, 0x60,
-    0xC0, 0x29, 0x23, 0xAB, 0x0D, 0x53, 0x4E, 0x6F, 0xD5, 0xDB, 0x37, 0x45,
-    0xDE, 0xFD, 0x8E, 0x2F, 0x03, 0xFF, 0x6A, 0x72, 0x6D, 0x6C, 0x5B, 0x51,
-    0x8D, 0x1B, 0xAF, 0x92, 0xBB, 0xDD, 0xBC, 0x7F, 0x11, 0xD9, 0x5C, 0x41,
-    0x1F, 0x10, 0x5A, 0xD8, 0x0A, 0xC1, 0x31, 0x88, 0xA5, 0xCD, 0x7B, 0xBD,
-    0x2D, 0x74, 0xD0, 0x12, 0xB8, 0xE5, 0xB4, 0xB0, 0x89, 0x69, 0x97, 0x4A,
-    0x0C, 0x96, 0x77, 0x7E, 0x65, 0xB9, 0xF1, 0x09, 0xC5, 0x6E, 0xC6, 0x84,
-    0x18, 0xF0, 0x7D, 0xEC, 0x3A, 0xDC, 0x4D, 0x20, 0x79, 0xEE, 0x5F, 0x3E,
-    0xD7, 0xCB, 0x39, 0x48 };
+const uint8_t SM4_SBOX[256] = { SM4_SBOX_VALUES };
 
 #define rotl32(value, shift) ((value << shift) | value >> (32 - shift))
 
@@ -56,10 +42,11 @@ void SM4_KeyInit(uint8_t* key, SM4_Key* sm4_key) {
         tmp = k[1] ^ k[2] ^ k[3] ^ CK[i];
         // SBox б任
         for (int j = 0; j < 4; j++) {
-            tmp_ptr8[j] = SBox[tmp_ptr8[j]];
+            tmp_ptr8[j] = SM4_SBOX[tmp_ptr8[j]];
         }
         // Ա任
         sm4_key->rk[i] = k[0] ^ tmp ^ rotl32(tmp, 13) ^ rotl32(tmp, 23);
+        sm4_key->rk_dec[31 - i] = sm4_key->rk[i];
         // λ
         k[0] = k[1];
         k[1] = k[2];
@@ -69,17 +56,6 @@ void SM4_KeyInit(uint8_t* key, SM4_Key* sm4_key) {
 }
 
 // sm4_aesni_x4.c 
-static void SM4_AESNI_do(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc);
-
-void SM4_AESNI_Encrypt_x4(uint8_t* plaintext, uint8_t* ciphertext,
-    SM4_Key* sm4_key) {
-    SM4_AESNI_do(plaintext, ciphertext, sm4_key, 0);
-}
-
-void SM4_AESNI_Decrypt_x4(uint8_t* ciphertext, uint8_t* plaintext,
-    SM4_Key* sm4_key) {
-    SM4_AESNI_do(ciphertext, plaintext, sm4_key, 1);
-}
 
 #define MM_PACK0_EPI32(a, b, c, d) \
     _mm_unpacklo_epi64(_mm_unpacklo_epi32(a, b), _mm_unpacklo_epi32(c, d))
@@ -98,8 +74,30 @@ void SM4_AESNI_Decrypt_x4(uint8_t* ciphertext, uint8_t* plaintext,
 #define MM_ROTL_EPI32(a, n) \
     MM_XOR2(_mm_slli_epi32(a, n), _mm_srli_epi32(a, 32 - n))
 
+SM4_TARGET("aes,ssse3")
 static __m128i SM4_SBox(__m128i x);
 
+// Sз任õĲ, 128/256/512λ汾
+#define SM4_ATA_HIGHER                                                       \
+    0x14, 0x07, 0xc6, 0xd5, 0x6c, 0x7f, 0xbe, 0xad, 0xb9, 0xaa, 0x6b, 0x78,  \
+        0xc1, 0xd2, 0x13, 0x00
+#define SM4_ATA_LOWER                                                        \
+    0xd8, 0xb8, 0xfa, 0x9a, 0xc5, 0xa5, 0xe7, 0x87, 0x5f, 0x3f, 0x7d, 0x1d,  \
+        0x42, 0x22, 0x60, 0x00
+#define SM4_TA_HIGHER                                                        \
+    0x22, 0x58, 0x1a, 0x60, 0x02, 0x78, 0x3a, 0x40, 0x62, 0x18, 0x5a, 0x20,  \
+        0x42, 0x38, 0x7a, 0x00
+#define SM4_TA_LOWER                                                         \
+    0xe2, 0x28, 0x95, 0x5f, 0x69, 0xa3, 0x1e, 0xd4, 0x36, 0xfc, 0x41, 0x8b,  \
+        0xbd, 0x77, 0xca, 0x00
+#define SM4_INV_SHIFTROWS                                                    \
+    0x03, 0x06, 0x09, 0x0c, 0x0f, 0x02, 0x05, 0x08, 0x0b, 0x0e, 0x01, 0x04,  \
+        0x07, 0x0a, 0x0d, 0x00
+#define SM4_BSWAP32_R 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+#define SM4_TC 0b00100011
+#define SM4_ATAC 0b00111011
+
+SM4_TARGET("ssse3")
 static __m128i MulMatrix(__m128i x, __m128i higherMask, __m128i lowerMask) {
     __m128i tmp1, tmp2;
     __m128i andMask = _mm_set1_epi32(0x0f0f0f0f);
@@ -112,164 +110,1218 @@ static __m128i MulMatrix(__m128i x, __m128i higherMask, __m128i lowerMask) {
     return tmp1;
 }
 
+SM4_TARGET("ssse3")
 static __m128i MulMatrixATA(__m128i x) {
-    __m128i higherMask =
-        _mm_set_epi8(0x14, 0x07, 0xc6, 0xd5, 0x6c, 0x7f, 0xbe, 0xad, 0xb9, 0xaa,
-            0x6b, 0x78, 0xc1, 0xd2, 0x13, 0x00);
-    __m128i lowerMask =
-        _mm_set_epi8(0xd8, 0xb8, 0xfa, 0x9a, 0xc5, 0xa5, 0xe7, 0x87, 0x5f, 0x3f,
-            0x7d, 0x1d, 0x42, 0x22, 0x60, 0x00);
+    __m128i higherMask = _mm_set_epi8(SM4_ATA_HIGHER);
+    __m128i lowerMask = _mm_set_epi8(SM4_ATA_LOWER);
     return MulMatrix(x, higherMask, lowerMask);
 }
 
+SM4_TARGET("ssse3")
 static __m128i MulMatrixTA(__m128i x) {
-    __m128i higherMask =
-        _mm_set_epi8(0x22, 0x58, 0x1a, 0x60, 0x02, 0x78, 0x3a, 0x40, 0x62, 0x18,
-            0x5a, 0x20, 0x42, 0x38, 0x7a, 0x00);
-    __m128i lowerMask =
-        _mm_set_epi8(0xe2, 0x28, 0x95, 0x5f, 0x69, 0xa3, 0x1e, 0xd4, 0x36, 0xfc,
-            0x41, 0x8b, 0xbd, 0x77, 0xca, 0x00);
+    __m128i higherMask = _mm_set_epi8(SM4_TA_HIGHER);
+    __m128i lowerMask = _mm_set_epi8(SM4_TA_LOWER);
     return MulMatrix(x, higherMask, lowerMask);
 }
 
 static __m128i AddTC(__m128i x) {
-    __m128i TC = _mm_set1_epi8(0b00100011);
+    __m128i TC = _mm_set1_epi8(SM4_TC);
     return _mm_xor_si128(x, TC);
 }
 
 static __m128i AddATAC(__m128i x) {
-    __m128i ATAC = _mm_set1_epi8(0b00111011);
+    __m128i ATAC = _mm_set1_epi8(SM4_ATAC);
     return _mm_xor_si128(x, ATAC);
 }
 
+SM4_TARGET("aes,ssse3")
 static __m128i SM4_SBox(__m128i x) {
-    __m128i MASK = _mm_set_epi8(0x03, 0x06, 0x09, 0x0c, 0x0f, 0x02, 0x05, 0x08,
-        0x0b, 0x0e, 0x01, 0x04, 0x07, 0x0a, 0x0d, 0x00);
+    __m128i MASK = _mm_set_epi8(SM4_INV_SHIFTROWS);
     x = _mm_shuffle_epi8(x, MASK);  // λ
     x = AddTC(MulMatrixTA(x));
     x = _mm_aesenclast_si128(x, _mm_setzero_si128());
     return AddATAC(MulMatrixATA(x));
 }
 
-static void SM4_AESNI_do(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc) {
-    __m128i X[4], Tmp[4];
-    __m128i vindex;
-    // Load Data
+// GFNI: SM4 S = A2 * Inv(A1 * x + C1) + C2, Inv Ϊ AES  (0x11b) ϵ.
+// A1/C1  TA/TC, A2/C2  ATA  AES 任ϲõ
+#define SM4_GFNI_A1 0x06170a353a729b0dULL
+#define SM4_GFNI_C1 0x23
+#define SM4_GFNI_A2 0xaf4db0439a96b349ULL
+#define SM4_GFNI_C2 0xd3
+
+SM4_TARGET("gfni")
+static inline __m128i SM4_SBox_GFNI(__m128i x) {
+    x = _mm_gf2p8affine_epi64_epi8(x, _mm_set1_epi64x((long long)SM4_GFNI_A1),
+        SM4_GFNI_C1);
+    return _mm_gf2p8affineinv_epi64_epi8(x,
+        _mm_set1_epi64x((long long)SM4_GFNI_A2), SM4_GFNI_C2);
+}
+
+// Load Data, Pack Data, Shuffle Endian
+SM4_TARGET("ssse3")
+static inline void SM4_Load_x4(const uint8_t* in, __m128i X[4]) {
+    __m128i Tmp[4];
+    __m128i vindex = _mm_setr_epi8(SM4_BSWAP32_R);
     Tmp[0] = _mm_loadu_si128((const __m128i*)in + 0);
     Tmp[1] = _mm_loadu_si128((const __m128i*)in + 1);
     Tmp[2] = _mm_loadu_si128((const __m128i*)in + 2);
     Tmp[3] = _mm_loadu_si128((const __m128i*)in + 3);
-    vindex =
-        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
-    // Pack Data
-    X[0] = MM_PACK0_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]);
-    X[1] = MM_PACK1_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]);
-    X[2] = MM_PACK2_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]);
-    X[3] = MM_PACK3_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]);
-    // Shuffle Endian
+    X[0] = _mm_shuffle_epi8(MM_PACK0_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[1] = _mm_shuffle_epi8(MM_PACK1_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[2] = _mm_shuffle_epi8(MM_PACK2_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[3] = _mm_shuffle_epi8(MM_PACK3_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+}
+
+// Shuffle Endian, Pack and Store ()
+SM4_TARGET("ssse3")
+static inline void SM4_Store_x4(uint8_t* out, __m128i X[4]) {
+    __m128i vindex = _mm_setr_epi8(SM4_BSWAP32_R);
     X[0] = _mm_shuffle_epi8(X[0], vindex);
     X[1] = _mm_shuffle_epi8(X[1], vindex);
     X[2] = _mm_shuffle_epi8(X[2], vindex);
     X[3] = _mm_shuffle_epi8(X[3], vindex);
-    // Loop
+    _mm_storeu_si128((__m128i*)out + 0, MM_PACK0_EPI32(X[3], X[2], X[1], X[0]));
+    _mm_storeu_si128((__m128i*)out + 1, MM_PACK1_EPI32(X[3], X[2], X[1], X[0]));
+    _mm_storeu_si128((__m128i*)out + 2, MM_PACK2_EPI32(X[3], X[2], X[1], X[0]));
+    _mm_storeu_si128((__m128i*)out + 3, MM_PACK3_EPI32(X[3], X[2], X[1], X[0]));
+}
+
+// X0 ^ L(t)
+static inline __m128i SM4_L(__m128i x0, __m128i t) {
+    return MM_XOR6(x0, t, MM_ROTL_EPI32(t, 2), MM_ROTL_EPI32(t, 10),
+        MM_ROTL_EPI32(t, 18), MM_ROTL_EPI32(t, 24));
+}
+
+SM4_TARGET("aes,ssse3")
+static void SM4_AESNI_do(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc) {
+    __m128i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x4(in, X);
     for (int i = 0; i < 32; i++) {
-        __m128i k =
-            _mm_set1_epi32((enc == 0) ? sm4_key->rk[i] : sm4_key->rk[31 - i]);
-        Tmp[0] = MM_XOR4(X[1], X[2], X[3], k);
-        // SBox
-        Tmp[0] = SM4_SBox(Tmp[0]);
-        // L
-        Tmp[0] = MM_XOR6(X[0], Tmp[0], MM_ROTL_EPI32(Tmp[0], 2),
-            MM_ROTL_EPI32(Tmp[0], 10), MM_ROTL_EPI32(Tmp[0], 18),
-            MM_ROTL_EPI32(Tmp[0], 24));
-        //
+        __m128i k = _mm_set1_epi32(rk[i]);
+        Tmp = SM4_SBox(MM_XOR4(X[1], X[2], X[3], k));
+        Tmp = SM4_L(X[0], Tmp);
         X[0] = X[1];
         X[1] = X[2];
         X[2] = X[3];
-        X[3] = Tmp[0];
+        X[3] = Tmp;
+    }
+    SM4_Store_x4(out, X);
+}
+
+SM4_TARGET("gfni,ssse3")
+static void SM4_GFNI_do(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc) {
+    __m128i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x4(in, X);
+    for (int i = 0; i < 32; i++) {
+        __m128i k = _mm_set1_epi32(rk[i]);
+        Tmp = SM4_SBox_GFNI(MM_XOR4(X[1], X[2], X[3], k));
+        Tmp = SM4_L(X[0], Tmp);
+        X[0] = X[1];
+        X[1] = X[2];
+        X[2] = X[3];
+        X[3] = Tmp;
+    }
+    SM4_Store_x4(out, X);
+}
+
+// CPU Լ
+static void SM4_Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t SM4_Xgetbv(void) {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static int SM4_DetectCpu(void) {
+    unsigned int regs[4];
+    int features = 0;
+    SM4_Cpuid(0, 0, regs);
+    unsigned int max_leaf = regs[0];
+    SM4_Cpuid(1, 0, regs);
+    if (regs[2] & (1u << 1)) features |= SM4_CPU_PCLMUL;
+    if ((regs[2] & (1u << 25)) && (regs[2] & (1u << 9))) features |= SM4_CPU_AESNI;
+    if (max_leaf < 7) return features;
+    int osxsave_avx = (regs[2] & (1u << 27)) && (regs[2] & (1u << 28));
+    uint64_t xcr0 = osxsave_avx ? SM4_Xgetbv() : 0;
+    SM4_Cpuid(7, 0, regs);
+    // 128 λ GFNI ֻ SSE ״̬
+    if (regs[2] & (1u << 8)) features |= SM4_CPU_GFNI;
+    // չҪϵͳ YMM ( ZMM) ״̬
+    if ((xcr0 & 0x06) != 0x06) return features;
+    if (regs[2] & (1u << 9)) features |= SM4_CPU_VAES;
+    if (regs[1] & (1u << 5)) features |= SM4_CPU_AVX2;
+    if ((regs[1] & (1u << 16)) && (regs[1] & (1u << 30)) &&
+        (xcr0 & 0xe0) == 0xe0) {
+        features |= SM4_CPU_AVX512;  // AVX512F + AVX512BW
+    }
+    return features;
+}
+
+int SM4_CpuFeatures(void) {
+    static const int features = SM4_DetectCpu();
+    return features;
+}
+
+// sm4_aesni_x8: 256 λ, ÿ 128 λͨϵ x4 ȫͬ
+#define MM256_PACK0_EPI32(a, b, c, d)                  \
+    _mm256_unpacklo_epi64(_mm256_unpacklo_epi32(a, b), \
+        _mm256_unpacklo_epi32(c, d))
+#define MM256_PACK1_EPI32(a, b, c, d)                  \
+    _mm256_unpackhi_epi64(_mm256_unpacklo_epi32(a, b), \
+        _mm256_unpacklo_epi32(c, d))
+#define MM256_PACK2_EPI32(a, b, c, d)                  \
+    _mm256_unpacklo_epi64(_mm256_unpackhi_epi32(a, b), \
+        _mm256_unpackhi_epi32(c, d))
+#define MM256_PACK3_EPI32(a, b, c, d)                  \
+    _mm256_unpackhi_epi64(_mm256_unpackhi_epi32(a, b), \
+        _mm256_unpackhi_epi32(c, d))
+
+#define MM256_XOR2(a, b) _mm256_xor_si256(a, b)
+#define MM256_XOR3(a, b, c) MM256_XOR2(a, MM256_XOR2(b, c))
+#define MM256_XOR4(a, b, c, d) MM256_XOR2(a, MM256_XOR3(b, c, d))
+#define MM256_XOR6(a, b, c, d, e, f) \
+    MM256_XOR2(MM256_XOR3(a, b, c), MM256_XOR3(d, e, f))
+#define MM256_ROTL_EPI32(a, n) \
+    MM256_XOR2(_mm256_slli_epi32(a, n), _mm256_srli_epi32(a, 32 - n))
+#define MM256_BROADCAST(...) \
+    _mm256_broadcastsi128_si256(_mm_set_epi8(__VA_ARGS__))
+
+SM4_TARGET("avx2,vaes")
+static inline __m256i MulMatrix256(__m256i x, __m256i higherMask,
+    __m256i lowerMask) {
+    __m256i andMask = _mm256_set1_epi32(0x0f0f0f0f);
+    __m256i tmp2 = _mm256_and_si256(_mm256_srli_epi16(x, 4), andMask);
+    __m256i tmp1 = _mm256_and_si256(x, andMask);
+    tmp1 = _mm256_shuffle_epi8(lowerMask, tmp1);
+    tmp2 = _mm256_shuffle_epi8(higherMask, tmp2);
+    return _mm256_xor_si256(tmp1, tmp2);
+}
+
+SM4_TARGET("avx2,vaes")
+static inline __m256i SM4_SBox256(__m256i x) {
+    x = _mm256_shuffle_epi8(x, MM256_BROADCAST(SM4_INV_SHIFTROWS));
+    x = MulMatrix256(x, MM256_BROADCAST(SM4_TA_HIGHER),
+        MM256_BROADCAST(SM4_TA_LOWER));
+    x = _mm256_xor_si256(x, _mm256_set1_epi8(SM4_TC));
+    x = _mm256_aesenclast_epi128(x, _mm256_setzero_si256());
+    x = MulMatrix256(x, MM256_BROADCAST(SM4_ATA_HIGHER),
+        MM256_BROADCAST(SM4_ATA_LOWER));
+    return _mm256_xor_si256(x, _mm256_set1_epi8(SM4_ATAC));
+}
+
+SM4_TARGET("avx2,gfni")
+static inline __m256i SM4_SBox256_GFNI(__m256i x) {
+    x = _mm256_gf2p8affine_epi64_epi8(x,
+        _mm256_set1_epi64x((long long)SM4_GFNI_A1), SM4_GFNI_C1);
+    return _mm256_gf2p8affineinv_epi64_epi8(x,
+        _mm256_set1_epi64x((long long)SM4_GFNI_A2), SM4_GFNI_C2);
+}
+
+// ÿ 256 λĴװ 2 
+SM4_TARGET("avx2")
+static inline void SM4_Load_x8(const uint8_t* in, __m256i X[4]) {
+    __m256i Tmp[4];
+    __m256i vindex = _mm256_broadcastsi128_si256(_mm_setr_epi8(SM4_BSWAP32_R));
+    Tmp[0] = _mm256_loadu_si256((const __m256i*)in + 0);
+    Tmp[1] = _mm256_loadu_si256((const __m256i*)in + 1);
+    Tmp[2] = _mm256_loadu_si256((const __m256i*)in + 2);
+    Tmp[3] = _mm256_loadu_si256((const __m256i*)in + 3);
+    X[0] = _mm256_shuffle_epi8(MM256_PACK0_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[1] = _mm256_shuffle_epi8(MM256_PACK1_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[2] = _mm256_shuffle_epi8(MM256_PACK2_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[3] = _mm256_shuffle_epi8(MM256_PACK3_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+}
+
+SM4_TARGET("avx2")
+static inline void SM4_Store_x8(uint8_t* out, __m256i X[4]) {
+    __m256i vindex = _mm256_broadcastsi128_si256(_mm_setr_epi8(SM4_BSWAP32_R));
+    X[0] = _mm256_shuffle_epi8(X[0], vindex);
+    X[1] = _mm256_shuffle_epi8(X[1], vindex);
+    X[2] = _mm256_shuffle_epi8(X[2], vindex);
+    X[3] = _mm256_shuffle_epi8(X[3], vindex);
+    _mm256_storeu_si256((__m256i*)out + 0, MM256_PACK0_EPI32(X[3], X[2], X[1], X[0]));
+    _mm256_storeu_si256((__m256i*)out + 1, MM256_PACK1_EPI32(X[3], X[2], X[1], X[0]));
+    _mm256_storeu_si256((__m256i*)out + 2, MM256_PACK2_EPI32(X[3], X[2], X[1], X[0]));
+    _mm256_storeu_si256((__m256i*)out + 3, MM256_PACK3_EPI32(X[3], X[2], X[1], X[0]));
+}
+
+SM4_TARGET("avx2")
+static inline __m256i SM4_L256(__m256i x0, __m256i t) {
+    return MM256_XOR6(x0, t, MM256_ROTL_EPI32(t, 2), MM256_ROTL_EPI32(t, 10),
+        MM256_ROTL_EPI32(t, 18), MM256_ROTL_EPI32(t, 24));
+}
+
+SM4_TARGET("avx2,vaes")
+static void SM4_AESNI_do_x8(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    __m256i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x8(in, X);
+    for (int i = 0; i < 32; i++) {
+        __m256i k = _mm256_set1_epi32(rk[i]);
+        Tmp = SM4_SBox256(MM256_XOR4(X[1], X[2], X[3], k));
+        Tmp = SM4_L256(X[0], Tmp);
+        X[0] = X[1];
+        X[1] = X[2];
+        X[2] = X[3];
+        X[3] = Tmp;
+    }
+    SM4_Store_x8(out, X);
+}
+
+SM4_TARGET("avx2,gfni")
+static void SM4_GFNI_do_x8(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    __m256i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x8(in, X);
+    for (int i = 0; i < 32; i++) {
+        __m256i k = _mm256_set1_epi32(rk[i]);
+        Tmp = SM4_SBox256_GFNI(MM256_XOR4(X[1], X[2], X[3], k));
+        Tmp = SM4_L256(X[0], Tmp);
+        X[0] = X[1];
+        X[1] = X[2];
+        X[2] = X[3];
+        X[3] = Tmp;
+    }
+    SM4_Store_x8(out, X);
+}
+
+// sm4_aesni_x16: AVX-512
+#define MM512_PACK0_EPI32(a, b, c, d)                  \
+    _mm512_unpacklo_epi64(_mm512_unpacklo_epi32(a, b), \
+        _mm512_unpacklo_epi32(c, d))
+#define MM512_PACK1_EPI32(a, b, c, d)                  \
+    _mm512_unpackhi_epi64(_mm512_unpacklo_epi32(a, b), \
+        _mm512_unpacklo_epi32(c, d))
+#define MM512_PACK2_EPI32(a, b, c, d)                  \
+    _mm512_unpacklo_epi64(_mm512_unpackhi_epi32(a, b), \
+        _mm512_unpackhi_epi32(c, d))
+#define MM512_PACK3_EPI32(a, b, c, d)                  \
+    _mm512_unpackhi_epi64(_mm512_unpackhi_epi32(a, b), \
+        _mm512_unpackhi_epi32(c, d))
+
+// 0x96: a ^ b ^ c
+#define MM512_XOR3(a, b, c) _mm512_ternarylogic_epi32(a, b, c, 0x96)
+#define MM512_BROADCAST(...) _mm512_broadcast_i32x4(_mm_set_epi8(__VA_ARGS__))
+
+SM4_TARGET("avx512f,avx512bw,vaes")
+static inline __m512i MulMatrix512(__m512i x, __m512i higherMask,
+    __m512i lowerMask) {
+    __m512i andMask = _mm512_set1_epi32(0x0f0f0f0f);
+    __m512i tmp2 = _mm512_and_si512(_mm512_srli_epi16(x, 4), andMask);
+    __m512i tmp1 = _mm512_and_si512(x, andMask);
+    tmp1 = _mm512_shuffle_epi8(lowerMask, tmp1);
+    tmp2 = _mm512_shuffle_epi8(higherMask, tmp2);
+    return _mm512_xor_si512(tmp1, tmp2);
+}
+
+SM4_TARGET("avx512f,avx512bw,vaes")
+static inline __m512i SM4_SBox512(__m512i x) {
+    x = _mm512_shuffle_epi8(x, MM512_BROADCAST(SM4_INV_SHIFTROWS));
+    x = MulMatrix512(x, MM512_BROADCAST(SM4_TA_HIGHER),
+        MM512_BROADCAST(SM4_TA_LOWER));
+    x = _mm512_xor_si512(x, _mm512_set1_epi8(SM4_TC));
+    x = _mm512_aesenclast_epi128(x, _mm512_setzero_si512());
+    x = MulMatrix512(x, MM512_BROADCAST(SM4_ATA_HIGHER),
+        MM512_BROADCAST(SM4_ATA_LOWER));
+    return _mm512_xor_si512(x, _mm512_set1_epi8(SM4_ATAC));
+}
+
+SM4_TARGET("avx512f,avx512bw,gfni")
+static inline __m512i SM4_SBox512_GFNI(__m512i x) {
+    x = _mm512_gf2p8affine_epi64_epi8(x,
+        _mm512_set1_epi64((long long)SM4_GFNI_A1), SM4_GFNI_C1);
+    return _mm512_gf2p8affineinv_epi64_epi8(x,
+        _mm512_set1_epi64((long long)SM4_GFNI_A2), SM4_GFNI_C2);
+}
+
+// ÿ 512 λĴװ 4 
+SM4_TARGET("avx512f,avx512bw")
+static inline void SM4_Load_x16(const uint8_t* in, __m512i X[4]) {
+    __m512i Tmp[4];
+    __m512i vindex = _mm512_broadcast_i32x4(_mm_setr_epi8(SM4_BSWAP32_R));
+    Tmp[0] = _mm512_loadu_si512((const __m512i*)in + 0);
+    Tmp[1] = _mm512_loadu_si512((const __m512i*)in + 1);
+    Tmp[2] = _mm512_loadu_si512((const __m512i*)in + 2);
+    Tmp[3] = _mm512_loadu_si512((const __m512i*)in + 3);
+    X[0] = _mm512_shuffle_epi8(MM512_PACK0_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[1] = _mm512_shuffle_epi8(MM512_PACK1_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[2] = _mm512_shuffle_epi8(MM512_PACK2_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+    X[3] = _mm512_shuffle_epi8(MM512_PACK3_EPI32(Tmp[0], Tmp[1], Tmp[2], Tmp[3]), vindex);
+}
+
+SM4_TARGET("avx512f,avx512bw")
+static inline void SM4_Store_x16(uint8_t* out, __m512i X[4]) {
+    __m512i vindex = _mm512_broadcast_i32x4(_mm_setr_epi8(SM4_BSWAP32_R));
+    X[0] = _mm512_shuffle_epi8(X[0], vindex);
+    X[1] = _mm512_shuffle_epi8(X[1], vindex);
+    X[2] = _mm512_shuffle_epi8(X[2], vindex);
+    X[3] = _mm512_shuffle_epi8(X[3], vindex);
+    _mm512_storeu_si512((__m512i*)out + 0, MM512_PACK0_EPI32(X[3], X[2], X[1], X[0]));
+    _mm512_storeu_si512((__m512i*)out + 1, MM512_PACK1_EPI32(X[3], X[2], X[1], X[0]));
+    _mm512_storeu_si512((__m512i*)out + 2, MM512_PACK2_EPI32(X[3], X[2], X[1], X[0]));
+    _mm512_storeu_si512((__m512i*)out + 3, MM512_PACK3_EPI32(X[3], X[2], X[1], X[0]));
+}
+
+SM4_TARGET("avx512f,avx512bw")
+static inline __m512i SM4_L512(__m512i x0, __m512i t) {
+    return _mm512_xor_si512(
+        MM512_XOR3(x0, t, _mm512_rol_epi32(t, 2)),
+        MM512_XOR3(_mm512_rol_epi32(t, 10), _mm512_rol_epi32(t, 18),
+            _mm512_rol_epi32(t, 24)));
+}
+
+SM4_TARGET("avx512f,avx512bw,vaes")
+static void SM4_AESNI_do_x16(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    __m512i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x16(in, X);
+    for (int i = 0; i < 32; i++) {
+        __m512i k = _mm512_set1_epi32(rk[i]);
+        Tmp = _mm512_xor_si512(MM512_XOR3(X[1], X[2], X[3]), k);
+        Tmp = SM4_L512(X[0], SM4_SBox512(Tmp));
+        X[0] = X[1];
+        X[1] = X[2];
+        X[2] = X[3];
+        X[3] = Tmp;
+    }
+    SM4_Store_x16(out, X);
+}
+
+SM4_TARGET("avx512f,avx512bw,gfni")
+static void SM4_GFNI_do_x16(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    __m512i X[4], Tmp;
+    const uint32_t* rk = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    SM4_Load_x16(in, X);
+    for (int i = 0; i < 32; i++) {
+        __m512i k = _mm512_set1_epi32(rk[i]);
+        Tmp = _mm512_xor_si512(MM512_XOR3(X[1], X[2], X[3]), k);
+        Tmp = SM4_L512(X[0], SM4_SBox512_GFNI(Tmp));
+        X[0] = X[1];
+        X[1] = X[2];
+        X[2] = X[3];
+        X[3] = Tmp;
+    }
+    SM4_Store_x16(out, X);
+}
+
+// Կչ: ÿͨһԿ, ںһתװ, ֺ S Ҳ.
+//  i ָͨԿȴ浽 rks[i * width + e], ַԿ rk/rk_dec.
+// x8/x16 װ밴 128 λֶν:  q ε p  32 λͨǵ p * (width / 4) + q Կ
+typedef void (*SM4_Keys_Fn)(const uint8_t* keys, SM4_Key* out);
+
+static void SM4_KeysStore(const uint32_t* rks, int width, SM4_Key* out) {
+    for (int e = 0; e < width; e++) {
+        SM4_Key* key = &out[(e & 3) * (width / 4) + (e >> 2)];
+        for (int i = 0; i < 32; i++) {
+            key->rk[i] = rks[i * width + e];
+            key->rk_dec[31 - i] = rks[i * width + e];
+        }
+    }
+}
+
+SM4_TARGET("aes,ssse3")
+static void SM4_AESNI_keys_x4(const uint8_t* keys, SM4_Key* out) {
+    __m128i K[4], Tmp;
+    uint32_t rks[32 * 4];
+    SM4_Load_x4(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = MM_XOR2(K[j], _mm_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = SM4_SBox(MM_XOR4(K[1], K[2], K[3], _mm_set1_epi32(CK[i])));
+        Tmp = MM_XOR4(K[0], Tmp, MM_ROTL_EPI32(Tmp, 13), MM_ROTL_EPI32(Tmp, 23));
+        _mm_storeu_si128((__m128i*)(rks + 4 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 4, out);
+}
+
+SM4_TARGET("gfni,ssse3")
+static void SM4_GFNI_keys_x4(const uint8_t* keys, SM4_Key* out) {
+    __m128i K[4], Tmp;
+    uint32_t rks[32 * 4];
+    SM4_Load_x4(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = MM_XOR2(K[j], _mm_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = SM4_SBox_GFNI(MM_XOR4(K[1], K[2], K[3], _mm_set1_epi32(CK[i])));
+        Tmp = MM_XOR4(K[0], Tmp, MM_ROTL_EPI32(Tmp, 13), MM_ROTL_EPI32(Tmp, 23));
+        _mm_storeu_si128((__m128i*)(rks + 4 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 4, out);
+}
+
+SM4_TARGET("avx2,vaes")
+static void SM4_AESNI_keys_x8(const uint8_t* keys, SM4_Key* out) {
+    __m256i K[4], Tmp;
+    uint32_t rks[32 * 8];
+    SM4_Load_x8(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = MM256_XOR2(K[j], _mm256_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = SM4_SBox256(MM256_XOR4(K[1], K[2], K[3], _mm256_set1_epi32(CK[i])));
+        Tmp = MM256_XOR4(K[0], Tmp, MM256_ROTL_EPI32(Tmp, 13),
+            MM256_ROTL_EPI32(Tmp, 23));
+        _mm256_storeu_si256((__m256i*)(rks + 8 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 8, out);
+}
+
+SM4_TARGET("avx2,gfni")
+static void SM4_GFNI_keys_x8(const uint8_t* keys, SM4_Key* out) {
+    __m256i K[4], Tmp;
+    uint32_t rks[32 * 8];
+    SM4_Load_x8(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = MM256_XOR2(K[j], _mm256_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = SM4_SBox256_GFNI(MM256_XOR4(K[1], K[2], K[3], _mm256_set1_epi32(CK[i])));
+        Tmp = MM256_XOR4(K[0], Tmp, MM256_ROTL_EPI32(Tmp, 13),
+            MM256_ROTL_EPI32(Tmp, 23));
+        _mm256_storeu_si256((__m256i*)(rks + 8 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 8, out);
+}
+
+SM4_TARGET("avx512f,avx512bw,vaes")
+static void SM4_AESNI_keys_x16(const uint8_t* keys, SM4_Key* out) {
+    __m512i K[4], Tmp;
+    uint32_t rks[32 * 16];
+    SM4_Load_x16(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = _mm512_xor_si512(K[j], _mm512_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = _mm512_xor_si512(MM512_XOR3(K[1], K[2], K[3]), _mm512_set1_epi32(CK[i]));
+        Tmp = SM4_SBox512(Tmp);
+        Tmp = _mm512_xor_si512(MM512_XOR3(K[0], Tmp, _mm512_rol_epi32(Tmp, 13)),
+            _mm512_rol_epi32(Tmp, 23));
+        _mm512_storeu_si512((__m512i*)(rks + 16 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 16, out);
+}
+
+SM4_TARGET("avx512f,avx512bw,gfni")
+static void SM4_GFNI_keys_x16(const uint8_t* keys, SM4_Key* out) {
+    __m512i K[4], Tmp;
+    uint32_t rks[32 * 16];
+    SM4_Load_x16(keys, K);
+    for (int j = 0; j < 4; j++) K[j] = _mm512_xor_si512(K[j], _mm512_set1_epi32(FK[j]));
+    for (int i = 0; i < 32; i++) {
+        Tmp = _mm512_xor_si512(MM512_XOR3(K[1], K[2], K[3]), _mm512_set1_epi32(CK[i]));
+        Tmp = SM4_SBox512_GFNI(Tmp);
+        Tmp = _mm512_xor_si512(MM512_XOR3(K[0], Tmp, _mm512_rol_epi32(Tmp, 13)),
+            _mm512_rol_epi32(Tmp, 23));
+        _mm512_storeu_si512((__m512i*)(rks + 16 * i), Tmp);
+        K[0] = K[1];
+        K[1] = K[2];
+        K[2] = K[3];
+        K[3] = Tmp;
+    }
+    SM4_KeysStore(rks, 16, out);
+}
+
+// ״ʹʱ CPUID (򻷾 SM4_BACKEND) ѡ˼ȵں
+typedef void (*SM4_Kernel_Fn)(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc);
+
+//  ECB, λƬԼ, ӿֱӽ
+typedef void (*SM4_Blocks_Fn)(const SM4_Key* sm4_key, const uint8_t* in,
+    uint8_t* out, size_t nblocks, int enc);
+
+typedef struct {
+    int backend;
+    SM4_Kernel_Fn x4;
+    SM4_Kernel_Fn x8;
+    SM4_Kernel_Fn x16;
+    SM4_Blocks_Fn blocks;   // Ϊʱӿڰ x4/x8/x16 
+    SM4_Keys_Fn keys_x4;    // Կչ, Ϊʱ SM4_KeyInit
+    SM4_Keys_Fn keys_x8;
+    SM4_Keys_Fn keys_x16;
+} SM4_Kernels;
+
+static const SM4_Kernels* SM4_GetKernels(void);
+
+// ֶ֧Ӧָʱ˻Ϊνխں˵
+static void SM4_Fallback_x8(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    SM4_GetKernels()->x4(in, out, sm4_key, enc);
+    SM4_GetKernels()->x4(in + 64, out + 64, sm4_key, enc);
+}
+
+static void SM4_Fallback_x16(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    SM4_GetKernels()->x8(in, out, sm4_key, enc);
+    SM4_GetKernels()->x8(in + 128, out + 128, sm4_key, enc);
+}
+
+//  SIMD ˵ x4 , ֱӵ x4/x8/x16 ģʽ (CBC, XTS ) ʹ
+static void SM4_Ref_x4(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc) {
+    sm4_ref_crypt_blocks(sm4_key, in, out, 4, enc);
+}
+
+static void SM4_TTable_x4(uint8_t* in, uint8_t* out, SM4_Key* sm4_key, int enc) {
+    sm4_ttable_crypt_blocks(sm4_key, in, out, 4, enc);
+}
+
+static void SM4_Bitslice_x4(uint8_t* in, uint8_t* out, SM4_Key* sm4_key,
+    int enc) {
+    SM4_BS_Crypt(sm4_key, in, out, 4, enc);
+}
+
+static const char* const sm4_backend_names[] = {
+    "ref", "ttable", "bitslice", "aesni", "gfni" };
+
+const char* SM4_BackendName(int backend) {
+    if (backend < SM4_BACKEND_REF || backend > SM4_BACKEND_GFNI) return "auto";
+    return sm4_backend_names[backend];
+}
+
+static int SM4_BackendSupported(int backend) {
+    int features = SM4_CpuFeatures();
+    if (backend == SM4_BACKEND_AESNI) return (features & SM4_CPU_AESNI) != 0;
+    if (backend == SM4_BACKEND_GFNI) return (features & SM4_CPU_GFNI) != 0;
+    return backend >= SM4_BACKEND_REF && backend <= SM4_BACKEND_BITSLICE;
+}
+
+static int SM4_AutoBackend(void) {
+    if (SM4_BackendSupported(SM4_BACKEND_GFNI)) return SM4_BACKEND_GFNI;
+    if (SM4_BackendSupported(SM4_BACKEND_AESNI)) return SM4_BACKEND_AESNI;
+    return SM4_BACKEND_BITSLICE;
+}
+
+//  SM4_BACKEND ָĺ, δá޷ʶ CPU ֧ʱԶѡ
+static int SM4_EnvBackend(void) {
+    const char* env = getenv("SM4_BACKEND");
+    if (env == NULL || *env == '\0') return SM4_AutoBackend();
+    for (int b = SM4_BACKEND_REF; b <= SM4_BACKEND_GFNI; b++) {
+        if (strcmp(env, sm4_backend_names[b]) != 0) continue;
+        if (SM4_BackendSupported(b)) return b;
+        fprintf(stderr, "SM4_BACKEND=%s: CPU ֧, ΪԶѡ\n", env);
+        return SM4_AutoBackend();
+    }
+    fprintf(stderr, "SM4_BACKEND=%s: δ֪, ΪԶѡ\n", env);
+    return SM4_AutoBackend();
+}
+
+static SM4_Kernels SM4_SelectKernels(int backend) {
+    int features = SM4_CpuFeatures();
+    SM4_Kernels kernels;
+    kernels.backend = backend;
+    kernels.x8 = SM4_Fallback_x8;
+    kernels.x16 = SM4_Fallback_x16;
+    kernels.blocks = NULL;
+    kernels.keys_x4 = NULL;
+    kernels.keys_x8 = NULL;
+    kernels.keys_x16 = NULL;
+    switch (backend) {
+    case SM4_BACKEND_REF:
+        kernels.x4 = SM4_Ref_x4;
+        kernels.blocks = sm4_ref_crypt_blocks;
+        break;
+    case SM4_BACKEND_TTABLE:
+        kernels.x4 = SM4_TTable_x4;
+        kernels.blocks = sm4_ttable_crypt_blocks;
+        break;
+    case SM4_BACKEND_BITSLICE:
+        kernels.x4 = SM4_Bitslice_x4;
+        kernels.blocks = SM4_BS_Crypt;
+        break;
+    case SM4_BACKEND_GFNI:
+        kernels.x4 = SM4_GFNI_do;
+        kernels.keys_x4 = SM4_GFNI_keys_x4;
+        if (features & SM4_CPU_AVX2) {
+            kernels.x8 = SM4_GFNI_do_x8;
+            kernels.keys_x8 = SM4_GFNI_keys_x8;
+        }
+        if (features & SM4_CPU_AVX512) {
+            kernels.x16 = SM4_GFNI_do_x16;
+            kernels.keys_x16 = SM4_GFNI_keys_x16;
+        }
+        break;
+    default:
+        kernels.x4 = SM4_AESNI_do;
+        kernels.keys_x4 = SM4_AESNI_keys_x4;
+        if ((features & SM4_CPU_AVX2) && (features & SM4_CPU_VAES)) {
+            kernels.x8 = SM4_AESNI_do_x8;
+            kernels.keys_x8 = SM4_AESNI_keys_x8;
+        }
+        if ((features & SM4_CPU_AVX512) && (features & SM4_CPU_VAES)) {
+            kernels.x16 = SM4_AESNI_do_x16;
+            kernels.keys_x16 = SM4_AESNI_keys_x16;
+        }
+        break;
+    }
+    return kernels;
+}
+
+static SM4_Kernels sm4_kernels;
+
+static const SM4_Kernels* SM4_GetKernels(void) {
+    // ֲ̬ĳʼִֻһ̰߳ȫ
+    static const int ready = (sm4_kernels = SM4_SelectKernels(SM4_EnvBackend()), 1);
+    (void)ready;
+    return &sm4_kernels;
+}
+
+int SM4_Backend(void) {
+    return SM4_GetKernels()->backend;
+}
+
+int SM4_SetBackend(int backend) {
+    SM4_GetKernels();
+    if (backend == SM4_BACKEND_AUTO) backend = SM4_AutoBackend();
+    if (!SM4_BackendSupported(backend)) return -1;
+    sm4_kernels = SM4_SelectKernels(backend);
+    return 0;
+}
+
+void SM4_AESNI_Encrypt_x4(uint8_t* plaintext, uint8_t* ciphertext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x4(plaintext, ciphertext, sm4_key, 0);
+}
+
+void SM4_AESNI_Decrypt_x4(uint8_t* ciphertext, uint8_t* plaintext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x4(ciphertext, plaintext, sm4_key, 1);
+}
+
+int SM4_AESNI_Width(void) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    if (kernels->x16 != SM4_Fallback_x16) return 16;
+    if (kernels->x8 != SM4_Fallback_x8) return 8;
+    return 4;
+}
+
+void SM4_AESNI_Encrypt_x8(uint8_t* plaintext, uint8_t* ciphertext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x8(plaintext, ciphertext, sm4_key, 0);
+}
+
+void SM4_AESNI_Decrypt_x8(uint8_t* ciphertext, uint8_t* plaintext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x8(ciphertext, plaintext, sm4_key, 1);
+}
+
+void SM4_AESNI_Encrypt_x16(uint8_t* plaintext, uint8_t* ciphertext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x16(plaintext, ciphertext, sm4_key, 0);
+}
+
+void SM4_AESNI_Decrypt_x16(uint8_t* ciphertext, uint8_t* plaintext,
+    SM4_Key* sm4_key) {
+    SM4_GetKernels()->x16(ciphertext, plaintext, sm4_key, 1);
+}
+
+void sm4_expand_keys(const uint8_t* keys, SM4_Key* out, size_t n) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    while (n > 0) {
+        int batch = 4;
+        if (kernels->keys_x16 != NULL && n >= 16) {
+            kernels->keys_x16(keys, out);
+            batch = 16;
+        }
+        else if (kernels->keys_x8 != NULL && n >= 8) {
+            kernels->keys_x8(keys, out);
+            batch = 8;
+        }
+        else if (kernels->keys_x4 != NULL && n >= 4) {
+            kernels->keys_x4(keys, out);
+        }
+        else {
+            SM4_KeyInit((uint8_t*)keys, out);
+            batch = 1;
+        }
+        keys += 16 * batch;
+        out += batch;
+        n -= batch;
+    }
+}
+
+//  ECB/CTR. ںֻԿ, ӿڵԿΪ const, ɿ̹߳
+static void SM4_RunKernel(const SM4_Kernels* kernels, int batch, uint8_t* in,
+    uint8_t* out, const SM4_Key* sm4_key, int enc) {
+    SM4_Key* rk = (SM4_Key*)sm4_key;
+    if (batch == 16) kernels->x16(in, out, rk, enc);
+    else if (batch == 8) kernels->x8(in, out, rk, enc);
+    else kernels->x4(in, out, rk, enc);
+}
+
+// ʣ nblocks ʱ:  width ܸ nblocks С
+static int SM4_BatchBlocks(size_t nblocks, int width) {
+    int batch = 4;
+    while (batch < width && (size_t)batch < nblocks) batch *= 2;
+    return batch;
+}
+
+int sm4_lane_batch(size_t nblocks) {
+    return SM4_BatchBlocks(nblocks, SM4_AESNI_Width());
+}
+
+static void SM4_ECB_do(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks, int enc) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    int width = SM4_AESNI_Width();
+    uint8_t buf[256];
+    if (kernels->blocks != NULL) {
+        kernels->blocks(sm4_key, in, out, nblocks, enc);
+        return;
+    }
+    while (nblocks > 0) {
+        int batch = SM4_BatchBlocks(nblocks, width);
+        if ((size_t)batch <= nblocks) {
+            SM4_RunKernel(kernels, batch, (uint8_t*)in, out, sm4_key, enc);
+            in += 16 * batch;
+            out += 16 * batch;
+            nblocks -= batch;
+        }
+        else {
+            // һʱ뵽ں˿
+            memset(buf, 0, sizeof(buf));
+            memcpy(buf, in, 16 * nblocks);
+            SM4_RunKernel(kernels, batch, buf, buf, sm4_key, enc);
+            memcpy(out, buf, 16 * nblocks);
+            nblocks = 0;
+        }
     }
-    // Shuffle Endian
-    X[0] = _mm_shuffle_epi8(X[0], vindex);
-    X[1] = _mm_shuffle_epi8(X[1], vindex);
-    X[2] = _mm_shuffle_epi8(X[2], vindex);
-    X[3] = _mm_shuffle_epi8(X[3], vindex);
-    // Pack and Store
-    _mm_storeu_si128((__m128i*)out + 0, MM_PACK0_EPI32(X[3], X[2], X[1], X[0]));
-    _mm_storeu_si128((__m128i*)out + 1, MM_PACK1_EPI32(X[3], X[2], X[1], X[0]));
-    _mm_storeu_si128((__m128i*)out + 2, MM_PACK2_EPI32(X[3], X[2], X[1], X[0]));
-    _mm_storeu_si128((__m128i*)out + 3, MM_PACK3_EPI32(X[3], X[2], X[1], X[0]));
 }
 
+void sm4_ecb_encrypt_blocks(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks) {
+    SM4_ECB_do(sm4_key, in, out, nblocks, 0);
+}
 
+void sm4_ecb_decrypt_blocks(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks) {
+    SM4_ECB_do(sm4_key, in, out, nblocks, 1);
+}
+
+static uint64_t SM4_LoadBE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+//  n ļ: СʽڼĴ 64 λӷ,
+// дʱֽڷΪ
+SM4_TARGET("ssse3")
+static void SM4_CtrBlocks(uint64_t hi, uint64_t lo, uint8_t* out, int n) {
+    __m128i bswap128 =
+        _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m128i ctr = _mm_set_epi64x((long long)hi, (long long)lo);
+    __m128i one = _mm_set_epi64x(0, 1);
+    __m128i carry = _mm_set_epi64x(1, 0);
+    for (int i = 0; i < n; i++) {
+        _mm_storeu_si128((__m128i*)out + i, _mm_shuffle_epi8(ctr, bswap128));
+        ctr = _mm_add_epi64(ctr, one);
+        //  64 λʱ 64 λλ
+        if (++lo == 0) ctr = _mm_add_epi64(ctr, carry);
+    }
+}
 
-int main() {
-    SM4_Key sm4_key;
-    unsigned char key[16] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
-                             0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
-    unsigned char plaintext[16 * 4] = {
-        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
-        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
-    unsigned char ciphertext[16 * 4];
-    unsigned char decrypted_text[16 * 4];
-    int i;
+// Կ, bytes һ
+static void SM4_XorKeystream(const uint8_t* in, uint8_t* out, const uint8_t* ks,
+    size_t bytes) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i k = _mm_loadu_si128((const __m128i*)(ks + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(d, k));
+    }
+    for (; i < bytes; i++) {
+        out[i] = in[i] ^ ks[i];
+    }
+}
 
-    clock_t start, end;
-    double cpu_time_used;
-    const int iterations = 100000; // ѭ
+static void SM4_StoreBE64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
 
-    // 1. Կչʱ
-    start = clock();
-    for (i = 0; i < iterations; ++i) {
-        SM4_KeyInit(key, &sm4_key);
+//  SIMD ˵ CTR, ÿ SM4_BS_MAX_BLOCKS ,  SSSE3.
+// ctr32 Ϊ 1 ʱֻ 32 λ (GCM Լ); ʱ ctr Ϊһδõļ
+static void SM4_Blocks_CtrXor(SM4_Blocks_Fn blocks, const SM4_Key* sm4_key,
+    uint8_t ctr[16], int ctr32, const uint8_t* in, uint8_t* out, size_t len) {
+    uint8_t ks[16 * SM4_BS_MAX_BLOCKS];
+    uint64_t hi = SM4_LoadBE64(ctr);
+    uint64_t lo = SM4_LoadBE64(ctr + 8);
+    while (len > 0) {
+        size_t nblocks = (len + 15) / 16;
+        size_t n = (nblocks < SM4_BS_MAX_BLOCKS) ? nblocks : SM4_BS_MAX_BLOCKS;
+        for (size_t i = 0; i < n; i++) {
+            SM4_StoreBE64(ks + 16 * i, hi);
+            SM4_StoreBE64(ks + 16 * i + 8, lo);
+            if (ctr32) lo = (lo & 0xffffffff00000000ULL) | (uint32_t)(lo + 1);
+            else if (++lo == 0) hi++;
+        }
+        blocks(sm4_key, ks, ks, n, 0);
+        size_t bytes = (len < 16 * n) ? len : 16 * n;
+        SM4_XorKeystream(in, out, ks, bytes);
+        in += bytes;
+        out += bytes;
+        len -= bytes;
     }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Կչƽʱ: %.8f \n", cpu_time_used / iterations);
+    SM4_StoreBE64(ctr, hi);
+    SM4_StoreBE64(ctr + 8, lo);
+}
 
-    // 2. ܹ
-    start = clock();
-    for (i = 0; i < iterations; ++i) {
-        SM4_AESNI_Encrypt_x4(plaintext, ciphertext, &sm4_key);
+void sm4_ctr_add(uint8_t ctr[16], uint64_t n) {
+    for (int i = 15; i >= 0 && n; i--) {
+        uint64_t v = ctr[i] + (n & 0xff);
+        ctr[i] = (uint8_t)v;
+        n = (n >> 8) + (v >> 8);
     }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+}
 
-    printf("ԭʼ (Plaintext): \n");
-    for (i = 0; i < 16; i++) {
-        printf("%02x ", plaintext[i]);
+void sm4_ctr_xor(const SM4_Key* sm4_key, const uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t len) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    if (kernels->blocks != NULL) {
+        uint8_t ctr[16];
+        memcpy(ctr, iv, 16);
+        SM4_Blocks_CtrXor(kernels->blocks, sm4_key, ctr, 0, in, out, len);
+        return;
     }
-    printf("\n\n");
+    int width = SM4_AESNI_Width();
+    uint64_t hi = SM4_LoadBE64(iv);
+    uint64_t lo = SM4_LoadBE64(iv + 8);
+    uint8_t ks[256];
+    while (len > 0) {
+        size_t nblocks = (len + 15) / 16;
+        int batch = SM4_BatchBlocks(nblocks, width);
+        SM4_CtrBlocks(hi, lo, ks, batch);
+        SM4_RunKernel(kernels, batch, ks, ks, sm4_key, 0);
+        size_t bytes = (len < (size_t)16 * batch) ? len : (size_t)16 * batch;
+        SM4_XorKeystream(in, out, ks, bytes);
+        if ((lo += batch) < (uint64_t)batch) hi++;
+        in += bytes;
+        out += bytes;
+        len -= bytes;
+    }
+}
+
+//  32 λֽڷ󼴿 paddd  inc32,  96 λλ
+#define SM4_BSWAP_LO32 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 15, 14, 13, 12
+
+// SIMD ˵ inc32 CTR, ֻ x4/x8/x16 ں˿ (ȷ֧ SSSE3) ʱ
+SM4_TARGET("ssse3")
+static void SM4_Ctr32Xor(const SM4_Kernels* kernels, const SM4_Key* sm4_key,
+    uint8_t ctr[16], const uint8_t* in, uint8_t* out, size_t len) {
+    int width = SM4_AESNI_Width();
+    __m128i mask = _mm_setr_epi8(SM4_BSWAP_LO32);
+    __m128i one = _mm_setr_epi32(0, 0, 0, 1);
+    __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ctr), mask);
+    uint8_t ks[256];
+    while (len > 0) {
+        size_t nblocks = (len + 15) / 16;
+        int batch = SM4_BatchBlocks(nblocks, width);
+        size_t bytes = (len < (size_t)16 * batch) ? len : (size_t)16 * batch;
+        for (int i = 0; i < batch; i++) {
+            _mm_storeu_si128((__m128i*)ks + i, _mm_shuffle_epi8(c, mask));
+            c = _mm_add_epi32(c, one);
+        }
+        SM4_RunKernel(kernels, batch, ks, ks, sm4_key, 0);
+        SM4_XorKeystream(in, out, ks, bytes);
+        // õļ
+        int unused = batch - (int)((bytes + 15) / 16);
+        c = _mm_sub_epi32(c, _mm_setr_epi32(0, 0, 0, unused));
+        in += bytes;
+        out += bytes;
+        len -= bytes;
+    }
+    _mm_storeu_si128((__m128i*)ctr, _mm_shuffle_epi8(c, mask));
+}
+
+void sm4_ctr32_xor(const SM4_Key* sm4_key, uint8_t ctr[16], const uint8_t* in,
+    uint8_t* out, size_t len) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    if (kernels->blocks != NULL) {
+        SM4_Blocks_CtrXor(kernels->blocks, sm4_key, ctr, 1, in, out, len);
+        return;
+    }
+    SM4_Ctr32Xor(kernels, sm4_key, ctr, in, out, len);
+}
+
+void sm4_cbc_decrypt(const SM4_Key* sm4_key, uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t nblocks) {
+    int width = SM4_AESNI_Width();
+    uint8_t buf[256];
+    __m128i prev = _mm_loadu_si128((const __m128i*)iv);
+    while (nblocks > 0) {
+        int n = (nblocks < (size_t)width) ? (int)nblocks : width;
+        __m128i last = _mm_loadu_si128((const __m128i*)in + n - 1);
+        SM4_ECB_do(sm4_key, in, buf, n, 1);
+        // Ӻǰ, ԭؽʱḲǻҪõǰһķ
+        for (int i = n - 1; i > 0; i--) {
+            __m128i c = _mm_loadu_si128((const __m128i*)in + i - 1);
+            __m128i p = _mm_loadu_si128((const __m128i*)buf + i);
+            _mm_storeu_si128((__m128i*)out + i, _mm_xor_si128(p, c));
+        }
+        _mm_storeu_si128((__m128i*)out,
+            _mm_xor_si128(_mm_loadu_si128((const __m128i*)buf), prev));
+        prev = last;
+        in += 16 * n;
+        out += 16 * n;
+        nblocks -= n;
+    }
+    _mm_storeu_si128((__m128i*)iv, prev);
+}
+
+void sm4_cbc_encrypt_streams(const SM4_Key* sm4_key, SM4_CBC_Stream* streams,
+    size_t nstreams) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    int width = SM4_AESNI_Width();
+    SM4_CBC_Stream* lane[16];
+    size_t done[16];
+    uint8_t buf[256];
+    size_t next = 0;
+    int active = 0;
+
+    memset(buf, 0, sizeof(buf));
+    for (;;) {
+        // ͨɺ
+        while (active < width && next < nstreams) {
+            if (streams[next].nblocks > 0) {
+                lane[active] = &streams[next];
+                done[active] = 0;
+                active++;
+            }
+            next++;
+        }
+        if (active == 0) {
+            break;
+        }
 
-    printf("ܽ (Ciphertext): \n");
-    for (i = 0; i < 16; i++) {
-        printf("%02x ", ciphertext[i]);
+        int batch = SM4_BatchBlocks((size_t)active, width);
+        for (int i = 0; i < active; i++) {
+            __m128i p = _mm_loadu_si128((const __m128i*)lane[i]->in + done[i]);
+            __m128i v = _mm_loadu_si128((const __m128i*)lane[i]->iv);
+            _mm_storeu_si128((__m128i*)buf + i, _mm_xor_si128(p, v));
+        }
+        SM4_RunKernel(kernels, batch, buf, buf, sm4_key, 0);
+        for (int i = 0; i < active; i++) {
+            __m128i c = _mm_loadu_si128((const __m128i*)buf + i);
+            _mm_storeu_si128((__m128i*)lane[i]->out + done[i], c);
+            _mm_storeu_si128((__m128i*)lane[i]->iv, c);
+            done[i]++;
+        }
+
+        // Ƴѽ
+        for (int i = 0; i < active; ) {
+            if (done[i] == lane[i]->nblocks) {
+                active--;
+                lane[i] = lane[active];
+                done[i] = done[active];
+            }
+            else {
+                i++;
+            }
+        }
     }
-    printf("\n\n");
+}
+
+void sm4_cbc_encrypt(const SM4_Key* sm4_key, uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t nblocks) {
+    SM4_CBC_Stream stream;
+    memcpy(stream.iv, iv, 16);
+    stream.in = in;
+    stream.out = out;
+    stream.nblocks = nblocks;
+    sm4_cbc_encrypt_streams(sm4_key, &stream, 1);
+    memcpy(iv, stream.iv, 16);
+}
+
+// XTS ֵ 128 λС˴,  alpha  1 λ, Ƴ x^128 ʱ
+// ֽ 0x87. Ĵ 64 λλ, Ľλ
+static inline __m128i SM4_XTS_MulX(__m128i t) {
+    __m128i sign = _mm_srai_epi32(t, 31);
+    //  32 λȡ 3  (x^127) ķ,  64 λȡ 1  (x^63) ķ
+    sign = _mm_shuffle_epi32(sign, _MM_SHUFFLE(1, 1, 3, 3));
+    sign = _mm_and_si128(sign, _mm_set_epi64x(1, 0x87));
+    return _mm_xor_si128(_mm_slli_epi64(t, 1), sign);
+}
+
+//  alpha^4: Ƴ 4 λ c ۻΪ c * 0x87 = c ^ c<<1 ^ c<<2 ^ c<<7
+static inline __m128i SM4_XTS_MulX4(__m128i t) {
+    __m128i top = _mm_srli_epi64(t, 60);
+    __m128i c = _mm_srli_si128(top, 8);
+    __m128i r = _mm_xor_si128(c, _mm_slli_epi64(c, 1));
+    r = _mm_xor_si128(r, _mm_slli_epi64(c, 2));
+    r = _mm_xor_si128(r, _mm_slli_epi64(c, 7));
+    t = _mm_xor_si128(_mm_slli_epi64(t, 4), _mm_slli_si128(top, 8));
+    return _mm_xor_si128(t, r);
+}
 
-    // 3. ܹ
-    start = clock();
-    for (i = 0; i < iterations; ++i) {
-        SM4_AESNI_Decrypt_x4(ciphertext, decrypted_text, &sm4_key);
+//  T  n ֵд tw ( 4 ıд, tw ռ),
+// ĸĴԳ alpha^4, ;  T * alpha^n
+static __m128i SM4_XTS_Tweaks(__m128i T, uint8_t* tw, int n) {
+    __m128i t0 = T;
+    __m128i t1 = SM4_XTS_MulX(t0);
+    __m128i t2 = SM4_XTS_MulX(t1);
+    __m128i t3 = SM4_XTS_MulX(t2);
+    for (int i = 0; i < n; i += 4) {
+        _mm_storeu_si128((__m128i*)tw + i, t0);
+        _mm_storeu_si128((__m128i*)tw + i + 1, t1);
+        _mm_storeu_si128((__m128i*)tw + i + 2, t2);
+        _mm_storeu_si128((__m128i*)tw + i + 3, t3);
+        t0 = SM4_XTS_MulX4(t0);
+        t1 = SM4_XTS_MulX4(t1);
+        t2 = SM4_XTS_MulX4(t2);
+        t3 = SM4_XTS_MulX4(t3);
     }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+    if (n % 4 == 0) return t0;
+    return SM4_XTS_MulX(_mm_loadu_si128((const __m128i*)tw + n - 1));
+}
 
-    // 4. ܽ
-    printf("ܽ (Decrypted Text): \n");
-    for (i = 0; i < 16; i++) {
-        printf("%02x ", decrypted_text[i]);
+//  out = SM4(in ^ T) ^ T
+static void SM4_XTS_Block(const SM4_Key* sm4_key, __m128i T, const uint8_t* in,
+    uint8_t* out, int enc) {
+    uint8_t buf[16];
+    _mm_storeu_si128((__m128i*)buf,
+        _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), T));
+    SM4_ECB_do(sm4_key, buf, buf, 1, enc);
+    _mm_storeu_si128((__m128i*)out,
+        _mm_xor_si128(_mm_loadu_si128((const __m128i*)buf), T));
+}
+
+// һݵԪ, T ΪѼܵ׸ֵ, len >= 16
+static void SM4_XTS_do(const SM4_Key* sm4_key, __m128i T, const uint8_t* in,
+    uint8_t* out, size_t len, int enc) {
+    const SM4_Kernels* kernels = SM4_GetKernels();
+    int width = SM4_AESNI_Width();
+    size_t rem = len % 16;
+    size_t nblocks = len / 16 - (rem ? 1 : 0);
+    uint8_t tw[256];
+    uint8_t buf[256];
+
+    while (nblocks > 0) {
+        int n = (nblocks < (size_t)width) ? (int)nblocks : width;
+        int batch = SM4_BatchBlocks((size_t)n, width);
+        T = SM4_XTS_Tweaks(T, tw, n);
+        for (int i = 0; i < n; i++) {
+            __m128i t = _mm_loadu_si128((const __m128i*)tw + i);
+            __m128i d = _mm_loadu_si128((const __m128i*)in + i);
+            _mm_storeu_si128((__m128i*)buf + i, _mm_xor_si128(d, t));
+        }
+        // ں˿ʱͨ,  SM4_ECB_do һ
+        memset(buf + 16 * n, 0, 16 * (size_t)(batch - n));
+        SM4_RunKernel(kernels, batch, buf, buf, sm4_key, enc);
+        for (int i = 0; i < n; i++) {
+            __m128i t = _mm_loadu_si128((const __m128i*)tw + i);
+            __m128i d = _mm_loadu_si128((const __m128i*)buf + i);
+            _mm_storeu_si128((__m128i*)out + i, _mm_xor_si128(d, t));
+        }
+        in += 16 * n;
+        out += 16 * n;
+        nblocks -= n;
     }
-    printf("\n\n");
 
-    // 5. ֤ܽ
-    if (memcmp(plaintext, decrypted_text, 16) == 0) {
-        printf("֤ɹܽԭʼһ¡\n");
+    if (rem) {
+        // ȡ: ڶĩβ rem ֽڽλ.
+        // ܰ T_m-1, T_m ˳, ܷ T_m
+        __m128i T_next = SM4_XTS_MulX(T);
+        uint8_t cc[16];
+        SM4_XTS_Block(sm4_key, enc ? T_next : T, in, cc, enc);
+        for (size_t i = 0; i < rem; i++) {
+            uint8_t b = in[16 + i];
+            out[16 + i] = cc[i];
+            cc[i] = b;
+        }
+        SM4_XTS_Block(sm4_key, enc ? T : T_next, cc, out, enc);
     }
-    else {
-        printf("֤ʧܣܽԭʼĲһ£\n");
+}
+
+static int SM4_XTS_Unit(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    const uint8_t tweak[16], const uint8_t* in, uint8_t* out, size_t len, int enc) {
+    uint8_t T[16];
+    if (len < 16) {
+        return -1;
     }
+    sm4_ecb_encrypt_blocks(tweak_key, tweak, T, 1);
+    SM4_XTS_do(data_key, _mm_loadu_si128((const __m128i*)T), in, out, len, enc);
+    return 0;
+}
+
+int sm4_xts_encrypt(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    const uint8_t tweak[16], const uint8_t* in, uint8_t* out, size_t len) {
+    return SM4_XTS_Unit(data_key, tweak_key, tweak, in, out, len, 0);
+}
+
+int sm4_xts_decrypt(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    const uint8_t tweak[16], const uint8_t* in, uint8_t* out, size_t len) {
+    return SM4_XTS_Unit(data_key, tweak_key, tweak, in, out, len, 1);
+}
 
+// ÿΪ 16 ֵܵ, һں˵
+static int SM4_XTS_Sectors(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    uint64_t sector_start, size_t count, size_t sector_size,
+    const uint8_t* in, uint8_t* out, int enc) {
+    uint8_t T[256];
+    if (sector_size < 16) {
+        return -1;
+    }
+    memset(T, 0, sizeof(T));
+    while (count > 0) {
+        int n = (count < 16) ? (int)count : 16;
+        for (int i = 0; i < n; i++) {
+            uint64_t sector = sector_start + i;
+            _mm_storeu_si128((__m128i*)T + i, _mm_set_epi64x(0, (long long)sector));
+        }
+        sm4_ecb_encrypt_blocks(tweak_key, T, T, n);
+        for (int i = 0; i < n; i++) {
+            SM4_XTS_do(data_key, _mm_loadu_si128((const __m128i*)T + i), in, out,
+                sector_size, enc);
+            in += sector_size;
+            out += sector_size;
+        }
+        sector_start += n;
+        count -= n;
+    }
     return 0;
+}
+
+int sm4_xts_encrypt_sectors(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    uint64_t sector_start, size_t count, size_t sector_size,
+    const uint8_t* in, uint8_t* out) {
+    return SM4_XTS_Sectors(data_key, tweak_key, sector_start, count, sector_size,
+        in, out, 0);
+}
+
+int sm4_xts_decrypt_sectors(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    uint64_t sector_start, size_t count, size_t sector_size,
+    const uint8_t* in, uint8_t* out) {
+    return SM4_XTS_Sectors(data_key, tweak_key, sector_start, count, sector_size,
+        in, out, 1);
 }
\ No newline at end of file
@@ -1,15 +1,40 @@
 #ifndef SM4_AESNI_COMBINED_H
 #define SM4_AESNI_COMBINED_H
 
+// SM4 ͳһĹͷļ: ΨһԿ SM4_Key, /ӿ, ʱѡ.
+// Դļ, ģʽ (GCM/CCM ) ڴ֮:
+//   SM4-aesni/sm4_aesni.cpp      AES-NI/GFNI ں, ģʽ
+//   SM4-aesni/sm4_bitslice.cpp   λƬ
+//   SM4-T-table/sm4_ttable.cpp   T  (ɲұ,  C++14)
+//   SM4ʵ/sm4_ref.c         οʵֺ
+
 #include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// GCC/Clang ҪΪʹչָĺ target, MSVC Ҫ
+#if defined(__GNUC__) || defined(__clang__)
+#define SM4_TARGET(x) __attribute__((target(x)))
+#else
+#define SM4_TARGET(x)
+#endif
 
 /**
- * @brief SM4 Կ
+ * @brief SM4 Կ: Կͬʱ, ں˰ enc ѡһ˳ʹ
  */
 typedef struct _SM4_Key {
-    uint32_t rk[32]; // 32Կ
+    uint32_t rk[32];     // 32Կ
+    uint32_t rk_dec[32]; // Կ, rk_dec[i] = rk[31 - i]
 } SM4_Key;
 
+/**
+ * @brief SM4 S , ˹
+ */
+extern const uint8_t SM4_SBOX[256];
+
 /**
  * @brief ʼ SM4 Կ
  * @param key 128bitԿ
@@ -17,8 +42,179 @@ typedef struct _SM4_Key {
  */
 void SM4_KeyInit(uint8_t* key, SM4_Key* sm4_key);
 
+/**
+ * @brief Կչ, ʺÿỰһԿĳ: 4/8/16 Կռ SIMD
+ *        ĸͨͬʱ 32 Կչ, S ӽں˹ (AES-NI/GFNI);
+ *        ˻ 4 ѵβ SM4_KeyInit
+ * @param keys n  16 ֽԿ, 
+ * @param out n  SM4 Կ,  SM4_KeyInit ͬ
+ */
+void sm4_expand_keys(const uint8_t* keys, SM4_Key* out, size_t n);
+
 void SM4_AESNI_Encrypt_x4(uint8_t* plaintext, uint8_t* ciphertext, SM4_Key* sm4_key);
 
 void SM4_AESNI_Decrypt_x4(uint8_t* ciphertext, uint8_t* plaintext, SM4_Key* sm4_key);
 
+/**
+ * @brief 8  (128 ֽ) ӽ, Ҫ AVX2 + GFNI/VAES, ˻Ϊ x4
+ */
+void SM4_AESNI_Encrypt_x8(uint8_t* plaintext, uint8_t* ciphertext, SM4_Key* sm4_key);
+
+void SM4_AESNI_Decrypt_x8(uint8_t* ciphertext, uint8_t* plaintext, SM4_Key* sm4_key);
+
+/**
+ * @brief 16  (256 ֽ) ӽ, Ҫ AVX-512 + GFNI/VAES, ˻Ϊ x8
+ */
+void SM4_AESNI_Encrypt_x16(uint8_t* plaintext, uint8_t* ciphertext, SM4_Key* sm4_key);
+
+void SM4_AESNI_Decrypt_x16(uint8_t* ciphertext, uint8_t* plaintext, SM4_Key* sm4_key);
+
+#define SM4_CPU_AVX2        0x01
+#define SM4_CPU_AVX512      0x02    // AVX512F + AVX512BW
+#define SM4_CPU_PCLMUL      0x04
+#define SM4_CPU_VAES        0x08
+#define SM4_CPU_GFNI        0x10
+#define SM4_CPU_AESNI       0x20    // AES-NI + SSSE3
+
+/**
+ * @brief ʱ⵽ CPU  (SM4_CPU_* λ), ״εʱ
+ */
+int SM4_CpuFeatures(void);
+
+/**
+ * @brief ǰ CPU ںһδķ: 4, 8  16
+ */
+int SM4_AESNI_Width(void);
+
+#define SM4_BACKEND_AUTO     -1
+#define SM4_BACKEND_REF       0     // ֽڲ S еĲοʵ
+#define SM4_BACKEND_TTABLE    1     // 4  T , 쵫ʱ
+#define SM4_BACKEND_BITSLICE  2     // λƬ, ʱ, ֻ SSE2
+#define SM4_BACKEND_AESNI     3     // AES-NI x4, VAES x8/x16
+#define SM4_BACKEND_GFNI      4     // GFNI x4/x8/x16
+
+/**
+ * @brief ǰʹõĺ (SM4_BACKEND_*). ״ʹʱ CPUID ѡĺ:
+ *        GFNI > AES-NI > λƬ;  SM4_BACKEND=ref/ttable/bitslice/aesni/gfni
+ *        ָ (), CPU ֧ʱ
+ */
+int SM4_Backend(void);
+
+const char* SM4_BackendName(int backend);
+
+/**
+ * @brief л, SM4_BACKEND_AUTO ָԶѡ. ̰߳ȫ, Ӧ߳ʹǰ
+ * @return 0 ɹ, CPU ָ֧úʱ -1 Ҳл
+ */
+int SM4_SetBackend(int backend);
+
+/**
+ * @brief  ECB ӽ, ں, βܸǵխں
+ * @param nblocks  (ÿ 16 ֽ), in  out ͬ
+ */
+void sm4_ecb_encrypt_blocks(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks);
+
+void sm4_ecb_decrypt_blocks(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks);
+
+/**
+ * @brief һִճ nblocks 齻 sm4_ecb_*_blocks ʱӦķ:
+ *        װǵխں˿ (4/8/16,  SM4_AESNI_Width()).
+ *        ͨ (CCM, CMAC) ݴ˲, ÿǡһں˵
+ */
+int sm4_lane_batch(size_t nblocks);
+
+/**
+ * @brief CTR ģʽ,  iv Ϊ׸ (128 λ˵), ⳤ
+ * @param len ֽ, Ҫ 16 ֽڶ; in  out ͬ
+ */
+void sm4_ctr_xor(const SM4_Key* sm4_key, const uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t len);
+
+/**
+ * @brief 128 λ˼ n (ģ 2^128), ʽ sm4_ctr_xor ͬ,
+ *        ƽϲ (Ϣ CTR, CTR_DRBG) ʹ
+ */
+void sm4_ctr_add(uint8_t ctr[16], uint64_t n);
+
+/**
+ * @brief GCM ʽ CTR: ֻĵ 32 λ (, ģ 2^32)
+ * @param ctr Ϊ׸, ʱΪһδʹõļ
+ */
+void sm4_ctr32_xor(const SM4_Key* sm4_key, uint8_t ctr[16], const uint8_t* in,
+    uint8_t* out, size_t len);
+
+/**
+ * @brief CBC , 黥, ں˿ȳ
+ * @param iv Ϊʼ, ʱΪһķ, ɽŽһ
+ * @param nblocks , in  out ͬ
+ */
+void sm4_cbc_decrypt(const SM4_Key* sm4_key, uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t nblocks);
+
+/**
+ * @brief һ CBC 
+ */
+typedef struct _SM4_CBC_Stream {
+    uint8_t iv[16];         // Ϊʼ, ʱΪһķ
+    const uint8_t* in;
+    uint8_t* out;           //  in ͬ
+    size_t nblocks;
+} SM4_CBC_Stream;
+
+/**
+ * @brief  CBC : ÿ, ͬռں˵Ĳͬͨ,
+ *        ʱɺ, ֮䳤ȿԲͬ
+ */
+void sm4_cbc_encrypt_streams(const SM4_Key* sm4_key, SM4_CBC_Stream* streams,
+    size_t nstreams);
+
+/**
+ * @brief  CBC , ֻռں˵һͨ
+ */
+void sm4_cbc_encrypt(const SM4_Key* sm4_key, uint8_t iv[16], const uint8_t* in,
+    uint8_t* out, size_t nblocks);
+
+/**
+ * @brief XTS ӽһݵԪ (IEEE 1619 ֵ˳), Ȳ 16 ıʱ
+ *        ȡ
+ * @param data_key Կ K1, tweak_key ֵԿ K2
+ * @param tweak ݵԪŵ 16 ֽڵֵ,  K2 ܺΪ׸ֵ
+ * @param len ֽ,  16; in  out ͬ
+ * @return 0 ɹ, len С 16 ʱ -1
+ */
+int sm4_xts_encrypt(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    const uint8_t tweak[16], const uint8_t* in, uint8_t* out, size_t len);
+
+int sm4_xts_decrypt(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    const uint8_t tweak[16], const uint8_t* in, uint8_t* out, size_t len);
+
+/**
+ * @brief  XTS: Ŵ sector_start ,  128 λС
+ *        Ϊĵֵ; ĵֵ
+ * @param sector_size ֽ,  16
+ * @return 0 ɹ, sector_size С 16 ʱ -1
+ */
+int sm4_xts_encrypt_sectors(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    uint64_t sector_start, size_t count, size_t sector_size,
+    const uint8_t* in, uint8_t* out);
+
+int sm4_xts_decrypt_sectors(const SM4_Key* data_key, const SM4_Key* tweak_key,
+    uint64_t sector_start, size_t count, size_t sector_size,
+    const uint8_t* in, uint8_t* out);
+
+/**
+ * @brief οʵֺ˵Ķ,  SM4ʵ/sm4_ref.c. ,
+ *        ȴ벻Է ASCII · sm4_ref.h (Դļļϵͳ
+ *        һʱҲļ)
+ * @param enc 0 ܡ1 , in  out ͬ
+ */
+void sm4_ref_crypt_blocks(const SM4_Key* key, const uint8_t* in, uint8_t* out,
+    size_t nblocks, int enc);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // !SM4_AESNI_COMBINED_H
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "sm4_bitslice.h"
+#include <string.h>
+#include <emmintrin.h>
+#include <immintrin.h>
+
+// 32 λ: 32 
+#define BS_W uint32_t
+#define BS_XOR(a, b) ((a) ^ (b))
+#define BS_AND(a, b) ((a) & (b))
+#define BS_NOT(a) (~(a))
+#define BS_MASK(b) ((uint32_t)0 - (uint32_t)(b))
+#define BS_LOAD(p) (*(p))
+#define BS_STORE(p, v) (*(p) = (v))
+#define BS_FN(name) name##_32
+#define BS_TARGET
+#include "sm4_bitslice_core.h"
+#undef BS_W
+#undef BS_MASK
+#undef BS_LOAD
+#undef BS_STORE
+#undef BS_FN
+
+// 64 λ: 64 
+static inline uint64_t SM4_BS_Load64(const uint32_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline void SM4_BS_Store64(uint32_t* p, uint64_t v) {
+    memcpy(p, &v, 8);
+}
+
+#define BS_W uint64_t
+#define BS_MASK(b) ((uint64_t)0 - (uint64_t)(b))
+#define BS_LOAD(p) SM4_BS_Load64(p)
+#define BS_STORE(p, v) SM4_BS_Store64(p, v)
+#define BS_FN(name) name##_64
+#include "sm4_bitslice_core.h"
+#undef BS_W
+#undef BS_XOR
+#undef BS_AND
+#undef BS_NOT
+#undef BS_MASK
+#undef BS_LOAD
+#undef BS_STORE
+#undef BS_FN
+
+// SSE2: 128 , x86-64 ָ
+#define BS_W __m128i
+#define BS_XOR(a, b) _mm_xor_si128(a, b)
+#define BS_AND(a, b) _mm_and_si128(a, b)
+#define BS_NOT(a) _mm_xor_si128(a, _mm_set1_epi32(-1))
+#define BS_MASK(b) _mm_set1_epi32(-(int)(b))
+#define BS_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define BS_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define BS_FN(name) name##_128
+#include "sm4_bitslice_core.h"
+#undef BS_W
+#undef BS_XOR
+#undef BS_AND
+#undef BS_NOT
+#undef BS_MASK
+#undef BS_LOAD
+#undef BS_STORE
+#undef BS_FN
+#undef BS_TARGET
+
+// AVX2: 256 
+#define BS_W __m256i
+#define BS_XOR(a, b) _mm256_xor_si256(a, b)
+#define BS_AND(a, b) _mm256_and_si256(a, b)
+#define BS_NOT(a) _mm256_xor_si256(a, _mm256_set1_epi32(-1))
+#define BS_MASK(b) _mm256_set1_epi32(-(int)(b))
+#define BS_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define BS_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define BS_FN(name) name##_256
+#define BS_TARGET SM4_TARGET("avx2")
+#include "sm4_bitslice_core.h"
+#undef BS_W
+#undef BS_XOR
+#undef BS_AND
+#undef BS_NOT
+#undef BS_MASK
+#undef BS_LOAD
+#undef BS_STORE
+#undef BS_FN
+#undef BS_TARGET
+
+// 32x32 λת (Hacker's Delight), ĸ 32 λͨתһ:
+//  31-c еĵ 31-r λΪԭ r еĵ c λ
+static void SM4_BS_Transpose32(__m128i a[32]) {
+    uint32_t m = 0x0000ffff;
+    for (int j = 16; j != 0; j >>= 1, m ^= m << j) {
+        __m128i mask = _mm_set1_epi32((int)m);
+        __m128i cnt = _mm_cvtsi32_si128(j);
+        for (int k = 0; k < 32; k = (k + j + 1) & ~j) {
+            __m128i t = _mm_and_si128(
+                _mm_xor_si128(a[k], _mm_srl_epi32(a[k + j], cnt)), mask);
+            a[k] = _mm_xor_si128(a[k], t);
+            a[k + j] = _mm_xor_si128(a[k + j], _mm_sll_epi32(t, cnt));
+        }
+    }
+}
+
+// λƬڴа [λ][][] :  w ֵ b λ,  g  32 
+// slices[(4 * b + w) * words + g]. 鰴С, ͨ w  w ,
+// ֵĵ b λСֵĵ b ^ 24 λ, ֽ򿿻±괦
+#define SM4_BS_ROW(b) (31 - ((b) ^ 24))
+
+static void SM4_BS_Pack(const uint8_t* in, size_t nblocks, uint32_t* slices, int words) {
+    __m128i a[32];
+    uint32_t row[4];
+    for (int g = 0; g < words; g++) {
+        for (int j = 0; j < 32; j++) {
+            size_t blk = (size_t)g * 32 + j;
+            a[j] = (blk < nblocks) ? _mm_loadu_si128((const __m128i*)(in + 16 * blk))
+                : _mm_setzero_si128();
+        }
+        SM4_BS_Transpose32(a);
+        for (int b = 0; b < 32; b++) {
+            _mm_storeu_si128((__m128i*)row, a[SM4_BS_ROW(b)]);
+            for (int w = 0; w < 4; w++) {
+                slices[(4 * b + w) * words + g] = row[w];
+            }
+        }
+    }
+}
+
+static void SM4_BS_Unpack(const uint32_t* slices, uint8_t* out, size_t nblocks, int words) {
+    __m128i a[32];
+    uint32_t row[4];
+    for (int g = 0; g < words; g++) {
+        for (int b = 0; b < 32; b++) {
+            for (int w = 0; w < 4; w++) {
+                row[w] = slices[(4 * b + w) * words + g];
+            }
+            a[SM4_BS_ROW(b)] = _mm_loadu_si128((const __m128i*)row);
+        }
+        SM4_BS_Transpose32(a);
+        for (int j = 0; j < 32; j++) {
+            size_t blk = (size_t)g * 32 + j;
+            if (blk < nblocks) _mm_storeu_si128((__m128i*)(out + 16 * blk), a[j]);
+        }
+    }
+}
+
+int SM4_BS_Width(void) {
+    return (SM4_CpuFeatures() & SM4_CPU_AVX2) ? 256 : 128;
+}
+
+void SM4_BS_Crypt(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks, int enc) {
+    int width = SM4_BS_Width();
+    uint32_t slices[128 * 8];
+    while (nblocks > 0) {
+        int lanes = 32;
+        while (lanes < width && (size_t)lanes < nblocks) lanes *= 2;
+        size_t n = (nblocks < (size_t)lanes) ? nblocks : (size_t)lanes;
+        int words = lanes / 32;
+        SM4_BS_Pack(in, n, slices, words);
+        if (lanes == 256) SM4_BS_Rounds_256(slices, sm4_key, enc);
+        else if (lanes == 128) SM4_BS_Rounds_128(slices, sm4_key, enc);
+        else if (lanes == 64) SM4_BS_Rounds_64(slices, sm4_key, enc);
+        else SM4_BS_Rounds_32(slices, sm4_key, enc);
+        SM4_BS_Unpack(slices, out, n, words);
+        in += 16 * n;
+        out += 16 * n;
+        nblocks -= n;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef SM4_BITSLICE_H
+#define SM4_BITSLICE_H
+
+#include "sm4_aesni.h"
+
+/**
+ * @brief λƬ SM4: һ 128 λŽһ, е j λڵ j ,
+ *        S Ϊ·, Ҳݷ֧, ʱԿ޹.
+ *        ֿ 32/64/128/256 λ (uint32_t/uint64_t/SSE2/AVX2), һδͬķ.
+ *        ֻõ SSE2 (AVX2 ʱ), ļɲ -maes/-mssse3 .
+ */
+
+#define SM4_BS_MAX_BLOCKS 256
+
+/**
+ * @brief δ:  AVX2 ʱ 256,  128
+ */
+int SM4_BS_Width(void);
+
+/**
+ * @brief λƬ ECB, ; , βװµխֿ
+ * @param enc 0 , 1  (ʹԿ),  AES-NI ںԼһ
+ * @param nblocks , in  out ͬ
+ */
+void SM4_BS_Crypt(const SM4_Key* sm4_key, const uint8_t* in, uint8_t* out,
+    size_t nblocks, int enc);
+
+#endif // !SM4_BITSLICE_H
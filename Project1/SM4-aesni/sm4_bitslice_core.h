@@ -0,0 +1,272 @@
+// λƬ SM4 ں,  sm4_bitslice.cpp ԲͬͶΰ, ûа.
+// ǰ趨:
+//   BS_W              , ÿһλӦһ
+//   BS_XOR/BS_AND/BS_NOT
+//   BS_MASK(b)        b Ϊ 0/1 ʱõȫ 0/ȫ 1 
+//   BS_LOAD/BS_STORE   uint32_t дһ
+//   BS_FN(name)       ϿȺ׺
+//   BS_TARGET         ָ
+
+// S(x) = A2 * inv(A1 * x + C1) + C2,  GFNI ·ͬ. ڸ
+// GF((2^4)^2) (y^2 + y + 0x8, GF(2^4) ȡ x^4 + x + 1) Ͻ,  AES ֮ͬ
+// Ѳ롢任.  58 AND + 143 XOR + 10 NOT, ɽűɲȫ
+// 256 У
+BS_TARGET
+static inline void BS_FN(SM4_BS_SBox)(const BS_W* x, BS_W* y) {
+    BS_W t0 = BS_XOR(x[0], x[3]);
+    BS_W t1 = BS_XOR(t0, x[4]);
+    BS_W t2 = BS_XOR(t1, x[5]);
+    BS_W t3 = BS_XOR(t2, x[6]);
+    BS_W t4 = BS_XOR(x[1], x[3]);
+    BS_W t5 = BS_XOR(x[0], x[5]);
+    BS_W t6 = BS_XOR(t5, x[6]);
+    BS_W t7 = BS_XOR(t6, x[7]);
+    BS_W t8 = BS_NOT(t7);
+    BS_W t9 = BS_XOR(x[0], x[1]);
+    BS_W t10 = BS_XOR(t9, x[2]);
+    BS_W t11 = BS_XOR(t10, x[3]);
+    BS_W t12 = BS_XOR(x[0], x[1]);
+    BS_W t13 = BS_XOR(t12, x[4]);
+    BS_W t14 = BS_XOR(t13, x[6]);
+    BS_W t15 = BS_XOR(t14, x[7]);
+    BS_W t16 = BS_NOT(t15);
+    BS_W t17 = BS_XOR(x[0], x[1]);
+    BS_W t18 = BS_XOR(t17, x[3]);
+    BS_W t19 = BS_XOR(t18, x[4]);
+    BS_W t20 = BS_XOR(t19, x[5]);
+    BS_W t21 = BS_XOR(t20, x[7]);
+    BS_W t22 = BS_NOT(t21);
+    BS_W t23 = BS_NOT(x[6]);
+    BS_W t24 = BS_XOR(x[0], x[1]);
+    BS_W t25 = BS_XOR(t24, x[2]);
+    BS_W t26 = BS_XOR(t25, x[3]);
+    BS_W t27 = BS_XOR(t26, x[4]);
+    BS_W t28 = BS_XOR(t27, x[5]);
+    BS_W t29 = BS_XOR(t28, x[6]);
+    BS_W t30 = BS_NOT(t29);
+    BS_W t31 = BS_XOR(t22, t23);
+    BS_W t32 = BS_XOR(t31, t30);
+    BS_W t33 = BS_XOR(t16, t23);
+    BS_W t34 = BS_XOR(t33, t30);
+    BS_W t35 = BS_XOR(t3, t8);
+    BS_W t36 = BS_XOR(t4, t11);
+    BS_W t37 = BS_AND(t16, t3);
+    BS_W t38 = BS_AND(t16, t4);
+    BS_W t39 = BS_AND(t16, t8);
+    BS_W t40 = BS_AND(t16, t11);
+    BS_W t41 = BS_AND(t22, t3);
+    BS_W t42 = BS_AND(t22, t4);
+    BS_W t43 = BS_AND(t22, t8);
+    BS_W t44 = BS_AND(t22, t11);
+    BS_W t45 = BS_AND(t23, t3);
+    BS_W t46 = BS_AND(t23, t4);
+    BS_W t47 = BS_AND(t23, t8);
+    BS_W t48 = BS_AND(t23, t11);
+    BS_W t49 = BS_AND(t30, t3);
+    BS_W t50 = BS_AND(t30, t4);
+    BS_W t51 = BS_AND(t30, t8);
+    BS_W t52 = BS_AND(t30, t11);
+    BS_W t53 = BS_XOR(t38, t41);
+    BS_W t54 = BS_XOR(t39, t42);
+    BS_W t55 = BS_XOR(t54, t45);
+    BS_W t56 = BS_XOR(t40, t43);
+    BS_W t57 = BS_XOR(t56, t46);
+    BS_W t58 = BS_XOR(t57, t49);
+    BS_W t59 = BS_XOR(t44, t47);
+    BS_W t60 = BS_XOR(t59, t50);
+    BS_W t61 = BS_XOR(t48, t51);
+    BS_W t62 = BS_XOR(t37, t60);
+    BS_W t63 = BS_XOR(t53, t60);
+    BS_W t64 = BS_XOR(t63, t61);
+    BS_W t65 = BS_XOR(t55, t61);
+    BS_W t66 = BS_XOR(t65, t52);
+    BS_W t67 = BS_XOR(t58, t52);
+    BS_W t68 = BS_XOR(t23, t35);
+    BS_W t69 = BS_XOR(t68, t62);
+    BS_W t70 = BS_XOR(t32, t8);
+    BS_W t71 = BS_XOR(t70, t64);
+    BS_W t72 = BS_XOR(t22, t36);
+    BS_W t73 = BS_XOR(t72, t66);
+    BS_W t74 = BS_XOR(t34, t11);
+    BS_W t75 = BS_XOR(t74, t67);
+    BS_W t76 = BS_XOR(t69, t71);
+    BS_W t77 = BS_XOR(t76, t73);
+    BS_W t78 = BS_AND(t69, t73);
+    BS_W t79 = BS_XOR(t77, t78);
+    BS_W t80 = BS_AND(t71, t73);
+    BS_W t81 = BS_XOR(t79, t80);
+    BS_W t82 = BS_AND(t69, t71);
+    BS_W t83 = BS_AND(t82, t73);
+    BS_W t84 = BS_XOR(t81, t83);
+    BS_W t85 = BS_XOR(t84, t75);
+    BS_W t86 = BS_AND(t80, t75);
+    BS_W t87 = BS_XOR(t85, t86);
+    BS_W t88 = BS_XOR(t82, t78);
+    BS_W t89 = BS_XOR(t88, t80);
+    BS_W t90 = BS_XOR(t89, t75);
+    BS_W t91 = BS_AND(t71, t75);
+    BS_W t92 = BS_XOR(t90, t91);
+    BS_W t93 = BS_AND(t82, t75);
+    BS_W t94 = BS_XOR(t92, t93);
+    BS_W t95 = BS_XOR(t82, t73);
+    BS_W t96 = BS_XOR(t95, t78);
+    BS_W t97 = BS_XOR(t96, t75);
+    BS_W t98 = BS_AND(t69, t75);
+    BS_W t99 = BS_XOR(t97, t98);
+    BS_W t100 = BS_AND(t78, t75);
+    BS_W t101 = BS_XOR(t99, t100);
+    BS_W t102 = BS_XOR(t71, t73);
+    BS_W t103 = BS_XOR(t102, t75);
+    BS_W t104 = BS_XOR(t103, t98);
+    BS_W t105 = BS_XOR(t104, t91);
+    BS_W t106 = BS_AND(t73, t75);
+    BS_W t107 = BS_XOR(t105, t106);
+    BS_W t108 = BS_XOR(t107, t86);
+    BS_W t109 = BS_AND(t16, t87);
+    BS_W t110 = BS_AND(t16, t94);
+    BS_W t111 = BS_AND(t16, t101);
+    BS_W t112 = BS_AND(t16, t108);
+    BS_W t113 = BS_AND(t22, t87);
+    BS_W t114 = BS_AND(t22, t94);
+    BS_W t115 = BS_AND(t22, t101);
+    BS_W t116 = BS_AND(t22, t108);
+    BS_W t117 = BS_AND(t23, t87);
+    BS_W t118 = BS_AND(t23, t94);
+    BS_W t119 = BS_AND(t23, t101);
+    BS_W t120 = BS_AND(t23, t108);
+    BS_W t121 = BS_AND(t30, t87);
+    BS_W t122 = BS_AND(t30, t94);
+    BS_W t123 = BS_AND(t30, t101);
+    BS_W t124 = BS_AND(t30, t108);
+    BS_W t125 = BS_XOR(t110, t113);
+    BS_W t126 = BS_XOR(t111, t114);
+    BS_W t127 = BS_XOR(t126, t117);
+    BS_W t128 = BS_XOR(t112, t115);
+    BS_W t129 = BS_XOR(t128, t118);
+    BS_W t130 = BS_XOR(t129, t121);
+    BS_W t131 = BS_XOR(t116, t119);
+    BS_W t132 = BS_XOR(t131, t122);
+    BS_W t133 = BS_XOR(t120, t123);
+    BS_W t134 = BS_XOR(t109, t132);
+    BS_W t135 = BS_XOR(t125, t132);
+    BS_W t136 = BS_XOR(t135, t133);
+    BS_W t137 = BS_XOR(t127, t133);
+    BS_W t138 = BS_XOR(t137, t124);
+    BS_W t139 = BS_XOR(t130, t124);
+    BS_W t140 = BS_XOR(t16, t3);
+    BS_W t141 = BS_XOR(t22, t4);
+    BS_W t142 = BS_XOR(t23, t8);
+    BS_W t143 = BS_XOR(t30, t11);
+    BS_W t144 = BS_AND(t140, t87);
+    BS_W t145 = BS_AND(t140, t94);
+    BS_W t146 = BS_AND(t140, t101);
+    BS_W t147 = BS_AND(t140, t108);
+    BS_W t148 = BS_AND(t141, t87);
+    BS_W t149 = BS_AND(t141, t94);
+    BS_W t150 = BS_AND(t141, t101);
+    BS_W t151 = BS_AND(t141, t108);
+    BS_W t152 = BS_AND(t142, t87);
+    BS_W t153 = BS_AND(t142, t94);
+    BS_W t154 = BS_AND(t142, t101);
+    BS_W t155 = BS_AND(t142, t108);
+    BS_W t156 = BS_AND(t143, t87);
+    BS_W t157 = BS_AND(t143, t94);
+    BS_W t158 = BS_AND(t143, t101);
+    BS_W t159 = BS_AND(t143, t108);
+    BS_W t160 = BS_XOR(t145, t148);
+    BS_W t161 = BS_XOR(t146, t149);
+    BS_W t162 = BS_XOR(t161, t152);
+    BS_W t163 = BS_XOR(t147, t150);
+    BS_W t164 = BS_XOR(t163, t153);
+    BS_W t165 = BS_XOR(t164, t156);
+    BS_W t166 = BS_XOR(t151, t154);
+    BS_W t167 = BS_XOR(t166, t157);
+    BS_W t168 = BS_XOR(t155, t158);
+    BS_W t169 = BS_XOR(t144, t167);
+    BS_W t170 = BS_XOR(t160, t167);
+    BS_W t171 = BS_XOR(t170, t168);
+    BS_W t172 = BS_XOR(t162, t168);
+    BS_W t173 = BS_XOR(t172, t159);
+    BS_W t174 = BS_XOR(t165, t159);
+    BS_W t175 = BS_XOR(t169, t134);
+    BS_W t176 = BS_XOR(t175, t136);
+    BS_W t177 = BS_XOR(t176, t138);
+    BS_W t178 = BS_NOT(t177);
+    BS_W t179 = BS_XOR(t169, t171);
+    BS_W t180 = BS_XOR(t179, t173);
+    BS_W t181 = BS_XOR(t180, t174);
+    BS_W t182 = BS_XOR(t181, t138);
+    BS_W t183 = BS_XOR(t182, t139);
+    BS_W t184 = BS_NOT(t183);
+    BS_W t185 = BS_XOR(t171, t174);
+    BS_W t186 = BS_XOR(t185, t138);
+    BS_W t187 = BS_XOR(t169, t171);
+    BS_W t188 = BS_XOR(t187, t173);
+    BS_W t189 = BS_XOR(t188, t174);
+    BS_W t190 = BS_XOR(t189, t134);
+    BS_W t191 = BS_XOR(t190, t136);
+    BS_W t192 = BS_XOR(t191, t139);
+    BS_W t193 = BS_XOR(t173, t174);
+    BS_W t194 = BS_XOR(t193, t136);
+    BS_W t195 = BS_XOR(t194, t138);
+    BS_W t196 = BS_NOT(t195);
+    BS_W t197 = BS_XOR(t173, t174);
+    BS_W t198 = BS_XOR(t197, t136);
+    BS_W t199 = BS_XOR(t198, t139);
+    BS_W t200 = BS_XOR(t169, t171);
+    BS_W t201 = BS_XOR(t200, t174);
+    BS_W t202 = BS_XOR(t201, t134);
+    BS_W t203 = BS_XOR(t202, t136);
+    BS_W t204 = BS_XOR(t203, t138);
+    BS_W t205 = BS_NOT(t204);
+    BS_W t206 = BS_XOR(t169, t173);
+    BS_W t207 = BS_XOR(t206, t174);
+    BS_W t208 = BS_XOR(t207, t138);
+    BS_W t209 = BS_XOR(t208, t139);
+    BS_W t210 = BS_NOT(t209);
+    y[0] = t178;
+    y[1] = t184;
+    y[2] = t186;
+    y[3] = t192;
+    y[4] = t196;
+    y[5] = t199;
+    y[6] = t205;
+    y[7] = t210;
+}
+
+// s[32 * w + b] Ϊ w ֵĵ b λ (b = 0 Ϊλ), ڴем SM4_BS_Pack.  r ְѽ
+//  r % 4 , ȥĸֵֻ, 32 ֺ 3,2,1,0 ˳Ϊ
+BS_TARGET
+static void BS_FN(SM4_BS_Rounds)(uint32_t* slices, const SM4_Key* sm4_key, int enc) {
+    const int words = (int)(sizeof(BS_W) / 4);
+    BS_W s[128], t[32], u[32];
+    for (int i = 0; i < 128; i++) {
+        s[i] = BS_LOAD(slices + (4 * (i & 31) + (i >> 5)) * words);
+    }
+    const uint32_t* rks = (enc == 0) ? sm4_key->rk : sm4_key->rk_dec;
+    for (int r = 0; r < 32; r++) {
+        uint32_t rk = rks[r];
+        BS_W* x0 = s + 32 * (r & 3);
+        const BS_W* x1 = s + 32 * ((r + 1) & 3);
+        const BS_W* x2 = s + 32 * ((r + 2) & 3);
+        const BS_W* x3 = s + 32 * ((r + 3) & 3);
+        for (int b = 0; b < 32; b++) {
+            t[b] = BS_XOR(BS_XOR(x1[b], x2[b]), BS_XOR(x3[b], BS_MASK((rk >> b) & 1)));
+        }
+        // 4 ֽڸһ S , ֽڵ i λֵĵ 8k+i λ
+        for (int k = 0; k < 4; k++) {
+            BS_FN(SM4_BS_SBox)(t + 8 * k, u + 8 * k);
+        }
+        // L еѭֻǻ±: rotl(B, n) ĵ b λΪ B ĵ b-n λ
+        for (int b = 0; b < 32; b++) {
+            BS_W l = BS_XOR(BS_XOR(u[b], u[(b - 2) & 31]),
+                BS_XOR(u[(b - 10) & 31], BS_XOR(u[(b - 18) & 31], u[(b - 24) & 31])));
+            x0[b] = BS_XOR(x0[b], l);
+        }
+    }
+    for (int w = 0; w < 4; w++) {
+        for (int b = 0; b < 32; b++) {
+            BS_STORE(slices + (4 * b + w) * words, s[32 * (3 - w) + b]);
+        }
+    }
+}
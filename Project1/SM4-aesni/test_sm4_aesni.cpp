@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "sm4_aesni.h"
+#include "sm4_bitslice.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#define BENCH_BYTES (64 * 1024)
+
+typedef void (*SM4_Batch_Fn)(uint8_t*, uint8_t*, SM4_Key*);
+
+//  rdtsc ʱ, ȡظеСֵ,  cycles/byte
+static double bench_cycles_per_byte(SM4_Batch_Fn fn, int batch_bytes,
+    SM4_Key* sm4_key) {
+    static uint8_t buf[BENCH_BYTES];
+    uint64_t best = UINT64_MAX;
+    for (int rep = 0; rep < 200; rep++) {
+        uint64_t t0 = __rdtsc();
+        for (int off = 0; off < BENCH_BYTES; off += batch_bytes) {
+            fn(buf + off, buf + off, sm4_key);
+        }
+        uint64_t t1 = __rdtsc();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    return (double)best / BENCH_BYTES;
+}
+
+// ֽڵ XTS οʵ, Уֵȡ
+static void xts_mul_alpha_ref(uint8_t* T) {
+    uint8_t carry = T[15] >> 7;
+    for (int i = 15; i > 0; i--) T[i] = (uint8_t)((T[i] << 1) | (T[i - 1] >> 7));
+    T[0] = (uint8_t)(T[0] << 1);
+    if (carry) T[0] ^= 0x87;
+}
+
+static void xts_block_ref(SM4_Key* k, const uint8_t* T, const uint8_t* in,
+    uint8_t* out, int dec) {
+    uint8_t b[16];
+    for (int i = 0; i < 16; i++) b[i] = in[i] ^ T[i];
+    if (dec) sm4_ecb_decrypt_blocks(k, b, b, 1);
+    else sm4_ecb_encrypt_blocks(k, b, b, 1);
+    for (int i = 0; i < 16; i++) out[i] = b[i] ^ T[i];
+}
+
+static void xts_ref(SM4_Key* k1, SM4_Key* k2, const uint8_t* tweak,
+    const uint8_t* in, uint8_t* out, size_t len, int dec) {
+    uint8_t T[16], T2[16], cc[16];
+    size_t rem = len % 16, full = len / 16 - (rem ? 1 : 0);
+    sm4_ecb_encrypt_blocks(k2, tweak, T, 1);
+    for (size_t j = 0; j < full; j++) {
+        xts_block_ref(k1, T, in + 16 * j, out + 16 * j, dec);
+        xts_mul_alpha_ref(T);
+    }
+    if (rem) {
+        in += 16 * full;
+        out += 16 * full;
+        memcpy(T2, T, 16);
+        xts_mul_alpha_ref(T2);
+        xts_block_ref(k1, dec ? T2 : T, in, cc, dec);
+        memcpy(out + 16, cc, rem);
+        memcpy(cc, in + 16, rem);
+        xts_block_ref(k1, dec ? T : T2, cc, out, dec);
+    }
+}
+
+int main() {
+    SM4_Key sm4_key;
+    unsigned char key[16] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+                             0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    unsigned char plaintext[16 * 4] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    unsigned char ciphertext[16 * 4];
+    unsigned char decrypted_text[16 * 4];
+    int i;
+
+    clock_t start, end;
+    double cpu_time_used;
+    const int iterations = 100000; // ѭ
+
+    // 1. Կչʱ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        SM4_KeyInit(key, &sm4_key);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("Կչƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // 2. ܹ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        SM4_AESNI_Encrypt_x4(plaintext, ciphertext, &sm4_key);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    printf("ԭʼ (Plaintext): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", plaintext[i]);
+    }
+    printf("\n\n");
+
+    printf("ܽ (Ciphertext): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", ciphertext[i]);
+    }
+    printf("\n\n");
+
+    // 3. ܹ
+    start = clock();
+    for (i = 0; i < iterations; ++i) {
+        SM4_AESNI_Decrypt_x4(ciphertext, decrypted_text, &sm4_key);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // 4. ܽ
+    printf("ܽ (Decrypted Text): \n");
+    for (i = 0; i < 16; i++) {
+        printf("%02x ", decrypted_text[i]);
+    }
+    printf("\n\n");
+
+    // 5. ֤ܽ
+    if (memcmp(plaintext, decrypted_text, 16) == 0) {
+        printf("֤ɹܽԭʼһ¡\n");
+    }
+    else {
+        printf("֤ʧܣܽԭʼĲһ£\n");
+    }
+
+    // 6. ں
+    printf("\nǰCPUں˿: x%d\n", SM4_AESNI_Width());
+    double cpb4 = bench_cycles_per_byte(SM4_AESNI_Encrypt_x4, 64, &sm4_key);
+    double cpb8 = bench_cycles_per_byte(SM4_AESNI_Encrypt_x8, 128, &sm4_key);
+    double cpb16 = bench_cycles_per_byte(SM4_AESNI_Encrypt_x16, 256, &sm4_key);
+    printf("x4 : %.2f cycles/byte\n", cpb4);
+    printf("x8 : %.2f cycles/byte (%.2fx)\n", cpb8, cpb4 / cpb8);
+    printf("x16: %.2f cycles/byte (%.2fx)\n", cpb16, cpb4 / cpb16);
+
+    // 7. ⳤ ECB/CTR:  x4 ȶ, CTR Ӧԭ
+    static uint8_t bulk_in[BENCH_BYTES + 16], bulk_out[BENCH_BYTES + 16];
+    static uint8_t bulk_ref[BENCH_BYTES + 16];
+    uint8_t iv[16] = { 0 };
+    for (i = 0; i < BENCH_BYTES + 16; i++) bulk_in[i] = (uint8_t)(i * 7);
+    sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_out, 37);
+    for (i = 0; i < 36; i += 4) {
+        SM4_AESNI_Encrypt_x4(bulk_in + 16 * i, bulk_ref + 16 * i, &sm4_key);
+    }
+    memcpy(ciphertext, bulk_in + 16 * 36, 16);
+    SM4_AESNI_Encrypt_x4(ciphertext, ciphertext, &sm4_key);
+    memcpy(bulk_ref + 16 * 36, ciphertext, 16);
+    int ecb_ok = memcmp(bulk_out, bulk_ref, 16 * 37) == 0;
+    sm4_ctr_xor(&sm4_key, iv, bulk_in, bulk_out, BENCH_BYTES + 5);
+    sm4_ctr_xor(&sm4_key, iv, bulk_out, bulk_out, BENCH_BYTES + 5);
+    int ctr_ok = memcmp(bulk_out, bulk_in, BENCH_BYTES + 5) == 0;
+    printf("ECB%s, CTR%s\n", ecb_ok ? "ȷ" : "",
+        ctr_ok ? "ȷ" : "");
+
+    uint64_t best = UINT64_MAX;
+    for (int rep = 0; rep < 200; rep++) {
+        uint64_t t0 = __rdtsc();
+        sm4_ctr_xor(&sm4_key, iv, bulk_in, bulk_out, BENCH_BYTES);
+        uint64_t t1 = __rdtsc();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    printf("CTR: %.2f cycles/byte\n", (double)best / BENCH_BYTES);
+
+    // 8. CBC:  ECB ӵĽȶ; 뵥ܱȶ
+    static uint8_t cbc_ref[BENCH_BYTES], cbc_out[BENCH_BYTES];
+    const size_t cbc_blocks = 41;
+    uint8_t cbc_iv[16], chain[16];
+    for (i = 0; i < 16; i++) cbc_iv[i] = (uint8_t)(0xa0 + i);
+    memcpy(chain, cbc_iv, 16);
+    for (size_t b = 0; b < cbc_blocks; b++) {
+        for (int j = 0; j < 16; j++) chain[j] ^= bulk_in[16 * b + j];
+        sm4_ecb_encrypt_blocks(&sm4_key, chain, chain, 1);
+        memcpy(cbc_ref + 16 * b, chain, 16);
+    }
+    memcpy(iv, cbc_iv, 16);
+    sm4_cbc_encrypt(&sm4_key, iv, bulk_in, cbc_out, cbc_blocks);
+    int cbc_ok = memcmp(cbc_out, cbc_ref, 16 * cbc_blocks) == 0 && memcmp(iv, chain, 16) == 0;
+    memcpy(iv, cbc_iv, 16);
+    sm4_cbc_decrypt(&sm4_key, iv, cbc_out, cbc_out, cbc_blocks);
+    cbc_ok = cbc_ok && memcmp(cbc_out, bulk_in, 16 * cbc_blocks) == 0;
+
+    // 40 Ȳͬ, Խ뵥ͬ
+    SM4_CBC_Stream streams[40];
+    size_t soff = 0;
+    for (i = 0; i < 40; i++) {
+        memset(streams[i].iv, i, 16);
+        streams[i].in = bulk_in + soff;
+        streams[i].out = cbc_out + soff;
+        streams[i].nblocks = (size_t)(i * 5) % 23;
+        soff += 16 * streams[i].nblocks;
+    }
+    sm4_cbc_encrypt_streams(&sm4_key, streams, 40);
+    soff = 0;
+    for (i = 0; i < 40; i++) {
+        memset(iv, i, 16);
+        sm4_cbc_encrypt(&sm4_key, iv, bulk_in + soff, cbc_ref + soff, streams[i].nblocks);
+        cbc_ok = cbc_ok && memcmp(iv, streams[i].iv, 16) == 0;
+        soff += 16 * streams[i].nblocks;
+    }
+    cbc_ok = cbc_ok && memcmp(cbc_out, cbc_ref, soff) == 0;
+    printf("CBC%s\n", cbc_ok ? "ȷ" : "");
+
+    // ÿֻһ; 16 ʱÿں
+    uint64_t best_dec = UINT64_MAX, best_enc1 = UINT64_MAX, best_encn = UINT64_MAX;
+    const size_t nstreams = 16, per_stream = BENCH_BYTES / 16 / nstreams;
+    for (int rep = 0; rep < 50; rep++) {
+        uint64_t t0 = __rdtsc();
+        sm4_cbc_decrypt(&sm4_key, iv, bulk_in, bulk_out, BENCH_BYTES / 16);
+        uint64_t t1 = __rdtsc();
+        sm4_cbc_encrypt(&sm4_key, iv, bulk_in, bulk_out, BENCH_BYTES / 16);
+        uint64_t t2 = __rdtsc();
+        for (size_t s = 0; s < nstreams; s++) {
+            streams[s].in = bulk_in + 16 * per_stream * s;
+            streams[s].out = bulk_out + 16 * per_stream * s;
+            streams[s].nblocks = per_stream;
+        }
+        sm4_cbc_encrypt_streams(&sm4_key, streams, nstreams);
+        uint64_t t3 = __rdtsc();
+        if (t1 - t0 < best_dec) best_dec = t1 - t0;
+        if (t2 - t1 < best_enc1) best_enc1 = t2 - t1;
+        if (t3 - t2 < best_encn) best_encn = t3 - t2;
+    }
+    printf("CBC: %.2f cycles/byte\n", (double)best_dec / BENCH_BYTES);
+    printf("CBC(): %.2f cycles/byte\n", (double)best_enc1 / BENCH_BYTES);
+    printf("CBC(%d): %.2f cycles/byte (%.2fx)\n", (int)nstreams,
+        (double)best_encn / BENCH_BYTES, (double)best_enc1 / best_encn);
+
+    // 9. XTS: ֳ(ȡ)οʵֱȶ, ӿȶ
+    SM4_Key xts_key2;
+    uint8_t key2[16], xts_tweak[16];
+    for (i = 0; i < 16; i++) key2[i] = (uint8_t)(0x5a ^ i);
+    SM4_KeyInit(key2, &xts_key2);
+    int xts_ok = 1;
+    for (size_t len = 16; len <= 600; len += 7) {
+        memset(xts_tweak, (int)len, 16);
+        xts_ref(&sm4_key, &xts_key2, xts_tweak, bulk_in, cbc_ref, len, 0);
+        sm4_xts_encrypt(&sm4_key, &xts_key2, xts_tweak, bulk_in, cbc_out, len);
+        xts_ok = xts_ok && memcmp(cbc_out, cbc_ref, len) == 0;
+        sm4_xts_decrypt(&sm4_key, &xts_key2, xts_tweak, cbc_out, cbc_out, len);
+        xts_ok = xts_ok && memcmp(cbc_out, bulk_in, len) == 0;
+    }
+    const size_t sector = 4096, nsect = BENCH_BYTES / 4096;
+    const uint64_t first_sector = 0xfffffffffffffff8ULL;
+    sm4_xts_encrypt_sectors(&sm4_key, &xts_key2, first_sector, nsect, sector,
+        bulk_in, cbc_out);
+    for (size_t s = 0; s < nsect; s++) {
+        uint64_t num = first_sector + s;
+        memset(xts_tweak, 0, 16);
+        for (int j = 0; j < 8; j++) xts_tweak[j] = (uint8_t)(num >> (8 * j));
+        xts_ref(&sm4_key, &xts_key2, xts_tweak, bulk_in + s * sector,
+            cbc_ref + s * sector, sector, 0);
+    }
+    xts_ok = xts_ok && memcmp(cbc_out, cbc_ref, BENCH_BYTES) == 0;
+    sm4_xts_decrypt_sectors(&sm4_key, &xts_key2, first_sector, nsect, sector,
+        cbc_out, cbc_out);
+    xts_ok = xts_ok && memcmp(cbc_out, bulk_in, BENCH_BYTES) == 0;
+    // IEEE 1619 ֵ˳ SM4-XTS  (56 ֽ, ȡ)
+    {
+        const uint8_t kv_k1[16] = {
+            0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+            0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+        const uint8_t kv_pt[56] = {
+            0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11,
+            0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+            0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46,
+            0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+            0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17 };
+        const uint8_t kv_ct[56] = {
+            0xe9, 0x53, 0x82, 0x51, 0xc7, 0x1d, 0x7b, 0x80, 0xbb, 0xe4, 0x48, 0x3f,
+            0xef, 0x49, 0x7b, 0xd1, 0xb3, 0xdb, 0x1a, 0x3e, 0x60, 0x40, 0x8c, 0x57,
+            0x5d, 0x63, 0xff, 0x7d, 0xb3, 0x9f, 0x83, 0x26, 0x08, 0x69, 0xf9, 0xe2,
+            0x58, 0x5f, 0xec, 0x9f, 0x0b, 0x86, 0x3b, 0xf8, 0xfd, 0x78, 0x4b, 0x86,
+            0x27, 0xd1, 0x6c, 0x0d, 0xb6, 0xd2, 0xcf, 0xc7 };
+        uint8_t kv_k2[16], kv_iv[16], kv_out[56];
+        SM4_Key kv_key1, kv_key2;
+        for (i = 0; i < 16; i++) {
+            kv_k2[i] = (uint8_t)i;
+            kv_iv[i] = (uint8_t)(0xf0 + i);
+        }
+        SM4_KeyInit((uint8_t*)kv_k1, &kv_key1);
+        SM4_KeyInit(kv_k2, &kv_key2);
+        sm4_xts_encrypt(&kv_key1, &kv_key2, kv_iv, kv_pt, kv_out, sizeof(kv_pt));
+        xts_ok = xts_ok && memcmp(kv_out, kv_ct, sizeof(kv_ct)) == 0;
+    }
+    printf("XTS%s\n", xts_ok ? "ȷ" : "");
+
+    uint64_t best_xe = UINT64_MAX, best_xd = UINT64_MAX;
+    for (int rep = 0; rep < 50; rep++) {
+        uint64_t t0 = __rdtsc();
+        sm4_xts_encrypt_sectors(&sm4_key, &xts_key2, 0, nsect, sector, bulk_in, bulk_out);
+        uint64_t t1 = __rdtsc();
+        sm4_xts_decrypt_sectors(&sm4_key, &xts_key2, 0, nsect, sector, bulk_out, bulk_out);
+        uint64_t t2 = __rdtsc();
+        if (t1 - t0 < best_xe) best_xe = t1 - t0;
+        if (t2 - t1 < best_xd) best_xd = t2 - t1;
+    }
+    printf("XTS(4KB):  %.2f,  %.2f cycles/byte\n",
+        (double)best_xe / BENCH_BYTES, (double)best_xd / BENCH_BYTES);
+
+
+    // 10. λƬ: ( 32/64/128/256 ֿβ) AES-NI ں˱ȶ,
+    //     ǿӿλƬ ECB/CTR 벻
+    {
+        static uint8_t bs_out[16 * 600];
+        int bs_ok = 1;
+        for (int n = 1; n <= 600; n += (n < 70) ? 1 : 37) {
+            sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_ref, n);
+            SM4_BS_Crypt(&sm4_key, bulk_in, bs_out, n, 0);
+            bs_ok = bs_ok && memcmp(bs_out, bulk_ref, 16 * n) == 0;
+            SM4_BS_Crypt(&sm4_key, bs_out, bs_out, n, 1);
+            bs_ok = bs_ok && memcmp(bs_out, bulk_in, 16 * n) == 0;
+        }
+        uint8_t ctr_a[16], ctr_b[16];
+        memset(ctr_a, 0xff, 16);
+        ctr_a[0] = 0x12;
+        memcpy(ctr_b, ctr_a, 16);
+        sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_ref, 300);
+        sm4_ctr_xor(&sm4_key, ctr_a, bulk_in, bulk_ref + 4800, 4000 + 7);
+        sm4_ctr32_xor(&sm4_key, ctr_b, bulk_in, bulk_ref + 9000, 4000 + 7);
+        SM4_SetBackend(SM4_BACKEND_BITSLICE);
+        memcpy(ctr_b, ctr_a, 16);
+        sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_out, 300);
+        sm4_ctr_xor(&sm4_key, ctr_a, bulk_in, bulk_out + 4800, 4000 + 7);
+        sm4_ctr32_xor(&sm4_key, ctr_b, bulk_in, bulk_out + 9000, 4000 + 7);
+        bs_ok = bs_ok && memcmp(bulk_out, bulk_ref, 4800 + 4007) == 0 &&
+            memcmp(bulk_out + 9000, bulk_ref + 9000, 4007) == 0;
+
+        uint64_t best_e = UINT64_MAX, best_c = UINT64_MAX;
+        for (int rep = 0; rep < 50; rep++) {
+            uint64_t t0 = __rdtsc();
+            sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_out, BENCH_BYTES / 16);
+            uint64_t t1 = __rdtsc();
+            sm4_ctr_xor(&sm4_key, iv, bulk_in, bulk_out, BENCH_BYTES);
+            uint64_t t2 = __rdtsc();
+            if (t1 - t0 < best_e) best_e = t1 - t0;
+            if (t2 - t1 < best_c) best_c = t2 - t1;
+        }
+        SM4_SetBackend(SM4_BACKEND_AUTO);
+        printf("\nλƬ(ÿ %d )%s: ECB %.2f, CTR %.2f cycles/byte\n",
+            SM4_BS_Width(), bs_ok ? "ȷ" : "",
+            (double)best_e / BENCH_BYTES, (double)best_c / BENCH_BYTES);
+    }
+
+    // 11. ͳһ: л, ECB/CTR/CBC Զѡĺһ
+    {
+        static uint8_t ref_buf[3 * 4096], be_buf[3 * 4096];
+        uint8_t cbc_iv[16];
+        int auto_backend = SM4_Backend();
+        printf("\nԶѡĺ: %s (û SM4_BACKEND ָ)\n",
+            SM4_BackendName(auto_backend));
+        for (int b = SM4_BACKEND_AUTO; b <= SM4_BACKEND_GFNI; b++) {
+            if (SM4_SetBackend(b) != 0) {
+                printf("%-8s: CPU ֧\n", SM4_BackendName(b));
+                continue;
+            }
+            uint8_t* dst = (b == SM4_BACKEND_AUTO) ? ref_buf : be_buf;
+            sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, dst, 255);
+            sm4_ctr_xor(&sm4_key, iv, bulk_in, dst + 4096, 4093);
+            memset(cbc_iv, 0x5a, 16);
+            sm4_cbc_encrypt(&sm4_key, cbc_iv, bulk_in, dst + 8192, 200);
+            if (b == SM4_BACKEND_AUTO) continue;
+            int same = memcmp(ref_buf, be_buf, sizeof(be_buf)) == 0;
+
+            uint64_t best_be = UINT64_MAX;
+            for (int rep = 0; rep < 20; rep++) {
+                uint64_t t0 = __rdtsc();
+                sm4_ecb_encrypt_blocks(&sm4_key, bulk_in, bulk_out, BENCH_BYTES / 16);
+                uint64_t t1 = __rdtsc();
+                if (t1 - t0 < best_be) best_be = t1 - t0;
+            }
+            printf("%-8s: %s, ECB %.2f cycles/byte\n", SM4_BackendName(b),
+                same ? "һ" : "һ", (double)best_be / BENCH_BYTES);
+        }
+        SM4_SetBackend(SM4_BACKEND_AUTO);
+    }
+    // 12. Կչ:  SM4_KeyInit ȶ ( 16/8/4 β),
+    //     rk_dec Ϊ rk ; ȽÿԿչ
+    {
+        const size_t nkeys = 16 + 8 + 4 + 3;
+        const size_t bench_keys = 1024;
+        static uint8_t many_keys[1024 * 16];
+        static SM4_Key batch_keys[1024], single_keys[1024];
+        for (size_t i = 0; i < sizeof(many_keys); i++) many_keys[i] = (uint8_t)(i * 37 + 5);
+        printf("\n");
+        for (int b = SM4_BACKEND_REF; b <= SM4_BACKEND_GFNI; b++) {
+            if (SM4_SetBackend(b) != 0) continue;
+            memset(batch_keys, 0, sizeof(SM4_Key) * nkeys);
+            sm4_expand_keys(many_keys, batch_keys, nkeys);
+            int keys_ok = 1;
+            for (size_t i = 0; i < nkeys; i++) {
+                SM4_KeyInit(many_keys + 16 * i, &single_keys[i]);
+                keys_ok = keys_ok &&
+                    memcmp(&batch_keys[i], &single_keys[i], sizeof(SM4_Key)) == 0;
+                for (int r = 0; r < 32; r++) {
+                    keys_ok = keys_ok && single_keys[i].rk_dec[r] == single_keys[i].rk[31 - r];
+                }
+            }
+
+            uint64_t best_single = UINT64_MAX, best_batch = UINT64_MAX;
+            for (int rep = 0; rep < 20; rep++) {
+                uint64_t t0 = __rdtsc();
+                for (size_t i = 0; i < bench_keys; i++) {
+                    SM4_KeyInit(many_keys + 16 * i, &single_keys[i]);
+                }
+                uint64_t t1 = __rdtsc();
+                sm4_expand_keys(many_keys, batch_keys, bench_keys);
+                uint64_t t2 = __rdtsc();
+                if (t1 - t0 < best_single) best_single = t1 - t0;
+                if (t2 - t1 < best_batch) best_batch = t2 - t1;
+            }
+            printf("%-8s Կչ: %s,  %.1f,  %.1f cycles/key\n",
+                SM4_BackendName(b), keys_ok ? "һ" : "һ",
+                (double)best_single / bench_keys, (double)best_batch / bench_keys);
+        }
+        SM4_SetBackend(SM4_BACKEND_AUTO);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "sm4_ccm.h"
+#include <string.h>
+#include <immintrin.h>
+
+// CBC-MAC յĸʽ: B0, ǰ׺+AAD(), ()
+#define CCM_PHASE_B0      0
+#define CCM_PHASE_AAD     1
+#define CCM_PHASE_PAYLOAD 2
+#define CCM_PHASE_DONE    3
+
+// бʾ "MAC " Ĳλ
+#define CCM_SLOT_MAC ((size_t)-1)
+
+// һϢ CCM ״̬: CBC-MAC ĸʽȺ CTR ļ
+typedef struct {
+    sm4_ccm_msg* msg;
+    const uint8_t* mac_src; // MAC: ܶ in, ܶ out
+    uint8_t B0[16];
+    uint8_t A[16];          // ģ,  L ֽΪ
+    uint8_t hdr[10];        // AADǰ׺
+    size_t hdr_len;
+    int L;
+    int phase;              // CCM_PHASE_*
+    size_t off;
+    size_t mac_blocks;      // յķ
+    size_t ctr_next;        // һҪɵļ, 0 Ӧ S0
+    size_t nblocks;         // ķ
+    uint8_t Y[16];          // CBC-MAC ֵ
+    uint8_t S0[16];
+} ccm_lane;
+
+static int ccm_lane_init(ccm_lane* c, sm4_ccm_msg* msg, size_t tag_len, int dec) {
+    size_t n = msg->nonce_len;
+    int L, i;
+
+    if (n < SM4_CCM_MIN_NONCE || n > SM4_CCM_MAX_NONCE) {
+        return -1;
+    }
+    if (tag_len < 4 || tag_len > 16 || tag_len % 2 != 0) {
+        return -1;
+    }
+    L = 15 - (int)n;
+    if (L < 8 && ((uint64_t)msg->len >> (8 * L)) != 0) {
+        return -1;
+    }
+
+    c->msg = msg;
+    c->mac_src = dec ? msg->out : msg->in;
+    c->L = L;
+
+    // B0 = flags || nonce || [len]L
+    c->B0[0] = (uint8_t)((msg->aad_len ? 0x40 : 0) | (((tag_len - 2) / 2) << 3) | (L - 1));
+    memcpy(c->B0 + 1, msg->nonce, n);
+    for (i = 0; i < L; i++) {
+        c->B0[15 - i] = (uint8_t)((uint64_t)msg->len >> (8 * i));
+    }
+    memset(c->A, 0, 16);
+    c->A[0] = (uint8_t)(L - 1);
+    memcpy(c->A + 1, msg->nonce, n);
+
+    // AADǰ׺: <2^16-2^8 2ֽ, <2^32  0xfffe+4ֽ,  0xffff+8ֽ
+    uint64_t a = msg->aad_len;
+    if (a == 0) {
+        c->hdr_len = 0;
+    }
+    else if (a < 0xff00) {
+        c->hdr[0] = (uint8_t)(a >> 8);
+        c->hdr[1] = (uint8_t)a;
+        c->hdr_len = 2;
+    }
+    else if (a <= 0xffffffffULL) {
+        c->hdr[0] = 0xff;
+        c->hdr[1] = 0xfe;
+        for (i = 0; i < 4; i++) c->hdr[2 + i] = (uint8_t)(a >> (24 - 8 * i));
+        c->hdr_len = 6;
+    }
+    else {
+        c->hdr[0] = 0xff;
+        c->hdr[1] = 0xff;
+        for (i = 0; i < 8; i++) c->hdr[2 + i] = (uint8_t)(a >> (56 - 8 * i));
+        c->hdr_len = 10;
+    }
+
+    c->phase = CCM_PHASE_B0;
+    c->off = 0;
+    c->mac_blocks = 0;
+    c->ctr_next = 0;
+    c->nblocks = (msg->len + 15) / 16;
+    memset(c->Y, 0, 16);
+    return 0;
+}
+
+// ܷƽMAC: ʱ j ķҪ S_j ɲ
+static int ccm_mac_ready(const ccm_lane* c, int dec) {
+    if (c->phase == CCM_PHASE_DONE) return 0;
+    if (dec && c->phase == CCM_PHASE_PAYLOAD) return c->ctr_next >= c->mac_blocks + 2;
+    return 1;
+}
+
+// ܷһ: ʱ S_i Ҫȵ i ķ鱻MAC,
+// ԭؼܲŲȸ
+static int ccm_ctr_ready(const ccm_lane* c, int dec) {
+    if (c->ctr_next > c->nblocks) return 0;
+    return c->ctr_next == 0 || dec || c->ctr_next <= c->mac_blocks;
+}
+
+// ȡһʽ, ֵд blk
+static void ccm_next_block(ccm_lane* c, uint8_t* blk) {
+    const sm4_ccm_msg* msg = c->msg;
+    __m128i y = _mm_loadu_si128((const __m128i*)c->Y);
+    uint8_t b[16];
+    size_t pos = 0, n;
+
+    // ֱ, ʱ
+    if (c->phase == CCM_PHASE_PAYLOAD && msg->len - c->off >= 16) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(c->mac_src + c->off));
+        _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(p, y));
+        c->off += 16;
+        c->mac_blocks++;
+        if (c->off == msg->len) {
+            c->phase = CCM_PHASE_DONE;
+        }
+        return;
+    }
+
+    memset(b, 0, 16);
+    switch (c->phase) {
+    case CCM_PHASE_B0:
+        memcpy(b, c->B0, 16);
+        c->phase = msg->aad_len ? CCM_PHASE_AAD :
+            (msg->len ? CCM_PHASE_PAYLOAD : CCM_PHASE_DONE);
+        break;
+    case CCM_PHASE_AAD:
+        if (c->off == 0) {
+            memcpy(b, c->hdr, c->hdr_len);
+            pos = c->hdr_len;
+        }
+        n = (msg->aad_len - c->off < 16 - pos) ? msg->aad_len - c->off : 16 - pos;
+        memcpy(b + pos, msg->aad + c->off, n);
+        c->off += n;
+        if (c->off == msg->aad_len) {
+            c->phase = msg->len ? CCM_PHASE_PAYLOAD : CCM_PHASE_DONE;
+            c->off = 0;
+        }
+        break;
+    case CCM_PHASE_PAYLOAD:
+        n = msg->len - c->off;
+        memcpy(b, c->mac_src + c->off, n);
+        c->off += n;
+        c->mac_blocks++;
+        c->phase = CCM_PHASE_DONE;
+        break;
+    }
+    _mm_storeu_si128((__m128i*)blk,
+        _mm_xor_si128(_mm_loadu_si128((const __m128i*)b), y));
+}
+
+// ˮ: ÿΪϢһMAC, üѱں˿,
+// һSM4ͬʱƽϢMACCTR
+static void ccm_run(const SM4_Key* key, ccm_lane* lanes, int n, int dec) {
+    int width = SM4_AESNI_Width();
+    uint8_t buf[256];
+    ccm_lane* who[16];
+    size_t slot[16];
+
+    memset(buf, 0, sizeof(buf));
+    for (;;) {
+        int nb = 0, target, l;
+
+        for (l = 0; l < n && nb < width; l++) {
+            if (ccm_mac_ready(&lanes[l], dec)) {
+                ccm_next_block(&lanes[l], buf + 16 * nb);
+                who[nb] = &lanes[l];
+                slot[nb] = CCM_SLOT_MAC;
+                nb++;
+            }
+        }
+        // װȫMACխں; ûMACʱں
+        target = nb ? sm4_lane_batch((size_t)nb) : width;
+        for (l = 0; l < n && nb < target; l++) {
+            ccm_lane* c = &lanes[l];
+            while (nb < target && ccm_ctr_ready(c, dec)) {
+                size_t i = c->ctr_next++;
+                memcpy(buf + 16 * nb, c->A, 16);
+                for (int j = 0; j < c->L; j++) {
+                    buf[16 * nb + 15 - j] = (uint8_t)((uint64_t)i >> (8 * j));
+                }
+                who[nb] = c;
+                slot[nb] = i;
+                nb++;
+            }
+        }
+        if (nb == 0) {
+            break;
+        }
+
+        // 鲻 target ʱ (Ϣ), ʣµĲλ who/slot
+        // , ֱܽӶ
+        sm4_ecb_encrypt_blocks(key, buf, buf, (size_t)target);
+
+        for (int s = 0; s < nb; s++) {
+            ccm_lane* c = who[s];
+            const uint8_t* ks = buf + 16 * s;
+            if (slot[s] == CCM_SLOT_MAC) {
+                memcpy(c->Y, ks, 16);
+            }
+            else if (slot[s] == 0) {
+                memcpy(c->S0, ks, 16);
+            }
+            else {
+                size_t off = (slot[s] - 1) * 16;
+                size_t bytes = (c->msg->len - off < 16) ? c->msg->len - off : 16;
+                if (bytes == 16) {
+                    __m128i d = _mm_loadu_si128((const __m128i*)(c->msg->in + off));
+                    _mm_storeu_si128((__m128i*)(c->msg->out + off),
+                        _mm_xor_si128(d, _mm_loadu_si128((const __m128i*)ks)));
+                    continue;
+                }
+                for (size_t j = 0; j < bytes; j++) {
+                    c->msg->out[off + j] = c->msg->in[off + j] ^ ks[j];
+                }
+            }
+        }
+    }
+}
+
+// дǩ, ܱȶԱǩ(ǰ˳), ʧʱ
+static int ccm_finish(ccm_lane* c, size_t tag_len, int dec) {
+    sm4_ccm_msg* msg = c->msg;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++) {
+        uint8_t t = c->Y[i] ^ c->S0[i];
+        if (dec) diff |= t ^ msg->tag[i];
+        else msg->tag[i] = t;
+    }
+    if (diff != 0) {
+        memset(msg->out, 0, msg->len);
+        return -1;
+    }
+    return 0;
+}
+
+int sm4_ccm_encrypt_batch(const SM4_Key* key, sm4_ccm_msg* msgs, size_t n, size_t tag_len) {
+    ccm_lane lanes[16];
+    int width = SM4_AESNI_Width();
+
+    for (size_t i = 0; i < n; i++) {
+        if (ccm_lane_init(&lanes[0], &msgs[i], tag_len, 0) != 0) {
+            return -1;
+        }
+    }
+    for (size_t base = 0; base < n; base += width) {
+        int cnt = (n - base < (size_t)width) ? (int)(n - base) : width;
+        for (int l = 0; l < cnt; l++) {
+            ccm_lane_init(&lanes[l], &msgs[base + l], tag_len, 0);
+        }
+        ccm_run(key, lanes, cnt, 0);
+        for (int l = 0; l < cnt; l++) {
+            ccm_finish(&lanes[l], tag_len, 0);
+        }
+    }
+    return 0;
+}
+
+int sm4_ccm_decrypt_batch(const SM4_Key* key, sm4_ccm_msg* msgs, size_t n, size_t tag_len) {
+    ccm_lane lanes[16];
+    int width = SM4_AESNI_Width();
+    int failed = 0;
+    size_t next = 0;
+
+    while (next < n) {
+        int cnt = 0;
+        // ϷϢֱΪʧ, ռͨ
+        while (cnt < width && next < n) {
+            sm4_ccm_msg* msg = &msgs[next++];
+            if (ccm_lane_init(&lanes[cnt], msg, tag_len, 1) == 0) {
+                cnt++;
+            }
+            else {
+                msg->result = -1;
+                failed++;
+            }
+        }
+        ccm_run(key, lanes, cnt, 1);
+        for (int l = 0; l < cnt; l++) {
+            lanes[l].msg->result = ccm_finish(&lanes[l], tag_len, 1);
+            if (lanes[l].msg->result != 0) failed++;
+        }
+    }
+    return failed;
+}
+
+int sm4_ccm_encrypt(const SM4_Key* key, const uint8_t* nonce, size_t nonce_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t len,
+    uint8_t* tag, size_t tag_len) {
+    sm4_ccm_msg msg;
+    msg.nonce = nonce;
+    msg.nonce_len = nonce_len;
+    msg.aad = aad;
+    msg.aad_len = aad_len;
+    msg.in = in;
+    msg.out = out;
+    msg.len = len;
+    msg.tag = tag;
+    return sm4_ccm_encrypt_batch(key, &msg, 1, tag_len);
+}
+
+int sm4_ccm_decrypt(const SM4_Key* key, const uint8_t* nonce, size_t nonce_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t len,
+    const uint8_t* tag, size_t tag_len) {
+    sm4_ccm_msg msg;
+    msg.nonce = nonce;
+    msg.nonce_len = nonce_len;
+    msg.aad = aad;
+    msg.aad_len = aad_len;
+    msg.in = in;
+    msg.out = out;
+    msg.len = len;
+    msg.tag = (uint8_t*)tag;    // ֻǩ
+    return sm4_ccm_decrypt_batch(key, &msg, 1, tag_len) == 0 ? 0 : -1;
+}
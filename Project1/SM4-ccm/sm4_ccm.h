@@ -0,0 +1,41 @@
+#ifndef SM4_CCM_H
+#define SM4_CCM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../SM4-aesni/sm4_aesni.h"
+
+#define SM4_CCM_MIN_NONCE 7
+#define SM4_CCM_MAX_NONCE 13
+
+// ӿеһϢ
+typedef struct {
+    const uint8_t* nonce;
+    size_t nonce_len;       // 7..13 ֽ
+    const uint8_t* aad;
+    size_t aad_len;
+    const uint8_t* in;
+    uint8_t* out;           //  in ͬ
+    size_t len;
+    uint8_t* tag;           // ʱ, ʱ
+    int result;             // ʱд: 0 ɹ, -1 ֤ʧܻ
+} sm4_ccm_msg;
+
+// SM4-CCM (RFC 3610 / NIST SP 800-38C). CBC-MAC ÿϢֻܴ,
+// ͬһSM4ں˵һͨƽMAC, ͨCTRԿ.
+// tag_len ȡ 4..16 ż; Ϸ-1
+int sm4_ccm_encrypt(const SM4_Key* key, const uint8_t* nonce, size_t nonce_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t len,
+    uint8_t* tag, size_t tag_len);
+// ֤ʧʱ-1
+int sm4_ccm_decrypt(const SM4_Key* key, const uint8_t* nonce, size_t nonce_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t len,
+    const uint8_t* tag, size_t tag_len);
+
+// ӿ: ϢCBC-MACռں˵Ĳͬͨƽ, ͨCTR.
+// ܷ0, Ϸ-1(κδ);
+// ܷ֤ʧܵϢ, Ϣ result, ʧܵϢ
+int sm4_ccm_encrypt_batch(const SM4_Key* key, sm4_ccm_msg* msgs, size_t n, size_t tag_len);
+int sm4_ccm_decrypt_batch(const SM4_Key* key, sm4_ccm_msg* msgs, size_t n, size_t tag_len);
+
+#endif // SM4_CCM_H
@@ -0,0 +1,141 @@
+#include "sm4_ccm.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void print_hex(const char* label, const uint8_t* data, size_t len) {
+    printf("%s: ", label);
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", data[i]);
+    }
+    printf("\n");
+}
+
+int main() {
+    // 1. RFC 8998 
+    uint8_t key[16] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    const uint8_t nonce[12] = {
+        0x00, 0x00, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x00, 0xab, 0xcd };
+    const uint8_t aad[20] = {
+        0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed,
+        0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2 };
+    const uint8_t kat_ct[64] = {
+        0x48, 0xaf, 0x93, 0x50, 0x1f, 0xa6, 0x2a, 0xdb, 0xcd, 0x41, 0x4c, 0xce,
+        0x60, 0x34, 0xd8, 0x95, 0xdd, 0xa1, 0xbf, 0x8f, 0x13, 0x2f, 0x04, 0x20,
+        0x98, 0x66, 0x15, 0x72, 0xe7, 0x48, 0x30, 0x94, 0xfd, 0x12, 0xe5, 0x18,
+        0xce, 0x06, 0x2c, 0x98, 0xac, 0xee, 0x28, 0xd9, 0x5d, 0xf4, 0x41, 0x6b,
+        0xed, 0x31, 0xa2, 0xf0, 0x44, 0x76, 0xc1, 0x8b, 0xb4, 0x0c, 0x84, 0xa7,
+        0x4b, 0x97, 0xdc, 0x5b };
+    const uint8_t kat_tag[16] = {
+        0x16, 0x84, 0x2d, 0x4f, 0xa1, 0x86, 0xf5, 0x6a,
+        0xb3, 0x32, 0x56, 0x97, 0x1f, 0xa1, 0x10, 0xf4 };
+    const char* fill = "ABCDEFEA";
+    uint8_t pt[64], ct[64], dec[64], tag[16];
+    SM4_Key sm4_key;
+    for (int i = 0; i < 64; i++) {
+        pt[i] = (uint8_t)(0x11 * (fill[i / 8] - 'A' + 0xa));
+    }
+    SM4_KeyInit(key, &sm4_key);
+    sm4_ccm_encrypt(&sm4_key, nonce, sizeof(nonce), aad, sizeof(aad), pt, ct,
+        sizeof(pt), tag, sizeof(tag));
+    print_hex("Ciphertext", ct, sizeof(ct));
+    print_hex("Tag", tag, sizeof(tag));
+    int ok = memcmp(ct, kat_ct, sizeof(ct)) == 0 && memcmp(tag, kat_tag, sizeof(tag)) == 0;
+    ok = ok && sm4_ccm_decrypt(&sm4_key, nonce, sizeof(nonce), aad, sizeof(aad), ct, dec,
+        sizeof(ct), tag, sizeof(tag)) == 0 && memcmp(dec, pt, sizeof(pt)) == 0;
+    ct[5] ^= 1;
+    ok = ok && sm4_ccm_decrypt(&sm4_key, nonce, sizeof(nonce), aad, sizeof(aad), ct, dec,
+        sizeof(ct), tag, sizeof(tag)) == -1;
+    printf("RFC 8998 : %s\n", ok ? "ͨ" : "ʧ");
+
+    // 2. ӿ: ͬ nonce/AAD/, һ, ܿԭؽ
+    static uint8_t src[40 * 600], out[40 * 600], ref[40 * 600];
+    static uint8_t tags[40][16], tags_ref[40][16], nonces[40][13];
+    sm4_ccm_msg msgs[40];
+    for (size_t i = 0; i < sizeof(src); i++) src[i] = (uint8_t)(i * 11);
+    for (int m = 0; m < 40; m++) {
+        memset(nonces[m], m, 13);
+        msgs[m].nonce = nonces[m];
+        msgs[m].nonce_len = 7 + m % 7;
+        msgs[m].aad = src + m;
+        msgs[m].aad_len = (size_t)(m * 3) % 37;
+        msgs[m].in = src + m * 600;
+        msgs[m].out = out + m * 600;
+        msgs[m].len = (size_t)(m * 53) % 600;
+        msgs[m].tag = tags[m];
+        sm4_ccm_encrypt(&sm4_key, msgs[m].nonce, msgs[m].nonce_len, msgs[m].aad,
+            msgs[m].aad_len, msgs[m].in, ref + m * 600, msgs[m].len, tags_ref[m], 12);
+    }
+    sm4_ccm_encrypt_batch(&sm4_key, msgs, 40, 12);
+    int batch_ok = memcmp(out, ref, sizeof(out)) == 0 && memcmp(tags, tags_ref, sizeof(tags)) == 0;
+    tags[7][0] ^= 1;
+    for (int m = 0; m < 40; m++) {
+        msgs[m].in = msgs[m].out;
+    }
+    int failed = sm4_ccm_decrypt_batch(&sm4_key, msgs, 40, 12);
+    for (int m = 0; m < 40; m++) {
+        if (m == 7) {
+            batch_ok = batch_ok && msgs[m].result == -1;
+            continue;
+        }
+        batch_ok = batch_ok && msgs[m].result == 0 &&
+            memcmp(out + m * 600, src + m * 600, msgs[m].len) == 0;
+    }
+    batch_ok = batch_ok && failed == 1;
+    printf("ӿ: %s\n", batch_ok ? "ͨ" : "ʧ");
+
+    // 3. : (CBC-MAC һ, CTR һ) / Ϣˮ / 16 Ϣ
+    {
+        const size_t len = 1024;
+        const int nmsg = 16, rounds = 2000;
+        static uint8_t big_in[16 * 1024], big_out[16 * 1024];
+        uint8_t iv[16] = { 0 };
+        clock_t start, end;
+        double t_naive, t_single, t_batch;
+
+        start = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int m = 0; m < nmsg; m++) {
+                sm4_cbc_encrypt(&sm4_key, iv, big_in + m * len, big_out + m * len, len / 16);
+                sm4_ctr_xor(&sm4_key, iv, big_in + m * len, big_out + m * len, len);
+            }
+        }
+        end = clock();
+        t_naive = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int m = 0; m < nmsg; m++) {
+                sm4_ccm_encrypt(&sm4_key, nonce, sizeof(nonce), aad, sizeof(aad),
+                    big_in + m * len, big_out + m * len, len, tag, sizeof(tag));
+            }
+        }
+        end = clock();
+        t_single = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+        for (int m = 0; m < nmsg; m++) {
+            msgs[m].nonce = nonce;
+            msgs[m].nonce_len = sizeof(nonce);
+            msgs[m].aad = aad;
+            msgs[m].aad_len = sizeof(aad);
+            msgs[m].in = big_in + m * len;
+            msgs[m].out = big_out + m * len;
+            msgs[m].len = len;
+            msgs[m].tag = tags[m];
+        }
+        start = clock();
+        for (int r = 0; r < rounds; r++) {
+            sm4_ccm_encrypt_batch(&sm4_key, msgs, nmsg, 16);
+        }
+        end = clock();
+        t_batch = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+        double total = (double)len * nmsg * rounds / 1e6;
+        printf("1KBϢ:  %.2f MB/s, ˮ %.2f MB/s,  %.2f MB/s\n",
+            total / t_naive, total / t_single, total / t_batch);
+    }
+
+    return 0;
+}
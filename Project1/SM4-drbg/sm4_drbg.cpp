@@ -0,0 +1,275 @@
+#ifdef _WIN32
+#define _CRT_RAND_S
+#endif
+#include "sm4_drbg.h"
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+int sm4_drbg_system_entropy(void* arg, uint8_t* buf, size_t len) {
+    (void)arg;
+#ifdef _WIN32
+    for (size_t i = 0; i < len; i += 4) {
+        unsigned int r;
+        if (rand_s(&r) != 0) return -1;
+        for (size_t j = 0; j < 4 && i + j < len; j++) {
+            buf[i + j] = (uint8_t)(r >> (8 * j));
+        }
+    }
+    return 0;
+#else
+    FILE* fp = fopen("/dev/urandom", "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t got = fread(buf, 1, len, fp);
+    fclose(fp);
+    return got == len ? 0 : -1;
+#endif
+}
+
+// V = (V + 1) mod 2^128
+static void drbg_inc(uint8_t* V) {
+    for (int i = 15; i >= 0; i--) {
+        if (++V[i] != 0) break;
+    }
+}
+
+// CTR_DRBG_Update:  E(Key, V+1) || E(Key, V+2)  provided õµ Key  V;
+// һں˵
+static void drbg_update(sm4_drbg* d, const uint8_t* provided) {
+    uint8_t temp[32];
+    drbg_inc(d->V);
+    memcpy(temp, d->V, 16);
+    drbg_inc(d->V);
+    memcpy(temp + 16, d->V, 16);
+    sm4_ecb_encrypt_blocks(&d->key, temp, temp, 2);
+    if (provided != NULL) {
+        for (int i = 0; i < 32; i++) temp[i] ^= provided[i];
+    }
+    SM4_KeyInit(temp, &d->key);
+    memcpy(d->V, temp + 16, 16);
+    memset(temp, 0, sizeof(temp));
+}
+
+// һ, ΰ˳ƴ, ȸƵһ
+typedef struct {
+    const uint8_t* p;
+    size_t len;
+} drbg_seg;
+
+// Block_Cipher_df,  seedlen ֽ. S = [L]32 || [N]32 || input || 0x80 || 0..,
+//  BCC  (IV = [0]32 || 0..  [1]32 || 0..) ͬ S, ŷŽͬһں˵
+static void drbg_df(const drbg_seg* segs, int nseg, uint8_t* out) {
+    // ̶Կ 00 01 .. 0f Կֻһ
+    static const SM4_Key df_key = []() {
+        SM4_Key k;
+        uint8_t kb[16];
+        for (int i = 0; i < 16; i++) kb[i] = (uint8_t)i;
+        SM4_KeyInit(kb, &k);
+        return k;
+    }();
+    std::vector<uint8_t> S;
+    size_t L = 0;
+    for (int i = 0; i < nseg; i++) L += segs[i].len;
+    S.reserve(L + 8 + 16);
+    for (int i = 3; i >= 0; i--) S.push_back((uint8_t)(L >> (8 * i)));
+    for (int i = 3; i >= 0; i--) S.push_back((uint8_t)(SM4_DRBG_SEED_LEN >> (8 * i)));
+    for (int i = 0; i < nseg; i++) {
+        if (segs[i].len) S.insert(S.end(), segs[i].p, segs[i].p + segs[i].len);
+    }
+    S.push_back(0x80);
+    while (S.size() % 16) S.push_back(0);
+
+    uint8_t chain[64];
+    memset(chain, 0, sizeof(chain));
+    chain[16 + 3] = 1;
+    sm4_ecb_encrypt_blocks(&df_key, chain, chain, 2);
+    for (size_t off = 0; off < S.size(); off += 16) {
+        for (int i = 0; i < 16; i++) {
+            chain[i] ^= S[off + i];
+            chain[16 + i] ^= S[off + i];
+        }
+        sm4_ecb_encrypt_blocks(&df_key, chain, chain, 2);
+    }
+
+    // K = ǰ16ֽ, X = 16ֽ;  E(K, X) || E(K, E(K, X))
+    SM4_Key k;
+    SM4_KeyInit(chain, &k);
+    sm4_ecb_encrypt_blocks(&k, chain + 16, out, 1);
+    sm4_ecb_encrypt_blocks(&k, out, out + 16, 1);
+    memset(chain, 0, sizeof(chain));
+    memset(&k, 0, sizeof(k));
+    std::fill(S.begin(), S.end(), 0);
+}
+
+static int drbg_reseed_inner(sm4_drbg* d, const uint8_t* add, size_t add_len) {
+    uint8_t entropy[SM4_DRBG_ENTROPY_LEN];
+    uint8_t seed[SM4_DRBG_SEED_LEN];
+    if (d->entropy(d->entropy_arg, entropy, sizeof(entropy)) != 0) {
+        return -1;
+    }
+    drbg_seg segs[2] = { { entropy, sizeof(entropy) }, { add, add_len } };
+    drbg_df(segs, 2, seed);
+    drbg_update(d, seed);
+    d->reseed_counter = 1;
+    d->reseeds++;
+    memset(entropy, 0, sizeof(entropy));
+    memset(seed, 0, sizeof(seed));
+    return 0;
+}
+
+int sm4_drbg_instantiate(sm4_drbg* d, sm4_drbg_entropy_fn entropy, void* entropy_arg,
+    const uint8_t* nonce, size_t nonce_len, const uint8_t* pers, size_t pers_len) {
+    uint8_t ent[SM4_DRBG_ENTROPY_LEN];
+    uint8_t seed[SM4_DRBG_SEED_LEN];
+    uint8_t zero_key[16] = { 0 };
+
+    d->entropy = (entropy != NULL) ? entropy : sm4_drbg_system_entropy;
+    d->entropy_arg = entropy_arg;
+    d->reseed_interval = SM4_DRBG_RESEED_INTERVAL;
+    d->prediction_resistance = 0;
+    d->reseeds = 0;
+    d->instantiated = 0;
+    if (d->entropy(d->entropy_arg, ent, sizeof(ent)) != 0) {
+        return -1;
+    }
+    drbg_seg segs[3] = { { ent, sizeof(ent) }, { nonce, nonce_len }, { pers, pers_len } };
+    drbg_df(segs, 3, seed);
+    SM4_KeyInit(zero_key, &d->key);
+    memset(d->V, 0, 16);
+    drbg_update(d, seed);
+    d->reseed_counter = 1;
+    d->instantiated = 1;
+    memset(ent, 0, sizeof(ent));
+    memset(seed, 0, sizeof(seed));
+    return 0;
+}
+
+int sm4_drbg_reseed(sm4_drbg* d, const uint8_t* add, size_t add_len) {
+    if (!d->instantiated) {
+        return -1;
+    }
+    return drbg_reseed_inner(d, add, add_len);
+}
+
+// һ (len <= SM4_DRBG_MAX_REQUEST).  V+1 ʼCTRԿ: 鲿
+// 󽻸 sm4_ctr_xor, ѡں. ĩβһ
+// Update õ, ϲһε
+static void drbg_generate_one(sm4_drbg* d, uint8_t* out, size_t len, const uint8_t* adin) {
+    uint8_t tail[48];
+    size_t full = len - len % 16;
+    size_t tb = (len % 16) ? 1 : 0;
+    if (adin != NULL) {
+        drbg_update(d, adin);
+    }
+    drbg_inc(d->V);
+    if (full > 0) {
+        memset(out, 0, full);
+        sm4_ctr_xor(&d->key, d->V, out, out, full);
+        sm4_ctr_add(d->V, full / 16);
+    }
+    memset(tail, 0, sizeof(tail));
+    sm4_ctr_xor(&d->key, d->V, tail, tail, 16 * (tb + 2));
+    memcpy(out + full, tail, len % 16);
+    sm4_ctr_add(d->V, tb + 1);
+    // V ͣùļ,  drbg_update Ľͬ
+    uint8_t* temp = tail + 16 * tb;
+    if (adin != NULL) {
+        for (int i = 0; i < 32; i++) temp[i] ^= adin[i];
+    }
+    SM4_KeyInit(temp, &d->key);
+    memcpy(d->V, temp + 16, 16);
+    d->reseed_counter++;
+    memset(tail, 0, sizeof(tail));
+}
+
+int sm4_drbg_generate(sm4_drbg* d, uint8_t* out, size_t len,
+    const uint8_t* add, size_t add_len) {
+    uint8_t adin[SM4_DRBG_SEED_LEN];
+    if (!d->instantiated) {
+        return -1;
+    }
+    do {
+        size_t n = (len < SM4_DRBG_MAX_REQUEST) ? len : SM4_DRBG_MAX_REQUEST;
+        const uint8_t* use = NULL;
+        // Ԥ⿹Ի: 벢ز, ֮޸
+        if (d->prediction_resistance || d->reseed_counter > d->reseed_interval) {
+            if (drbg_reseed_inner(d, add, add_len) != 0) {
+                return -1;
+            }
+            add_len = 0;
+        }
+        if (add_len > 0) {
+            drbg_seg seg = { add, add_len };
+            drbg_df(&seg, 1, adin);
+            use = adin;
+            add_len = 0;
+        }
+        drbg_generate_one(d, out, n, use);
+        out += n;
+        len -= n;
+    } while (len > 0);
+    memset(adin, 0, sizeof(adin));
+    return 0;
+}
+
+void sm4_drbg_set_reseed_interval(sm4_drbg* d, uint64_t interval) {
+    if (interval == 0 || interval > SM4_DRBG_RESEED_INTERVAL) {
+        interval = SM4_DRBG_RESEED_INTERVAL;
+    }
+    d->reseed_interval = interval;
+}
+
+void sm4_drbg_set_prediction_resistance(sm4_drbg* d, int enable) {
+    d->prediction_resistance = enable;
+}
+
+void sm4_drbg_uninstantiate(sm4_drbg* d) {
+    volatile uint8_t* p = (volatile uint8_t*)d;
+    for (size_t i = 0; i < sizeof(*d); i++) p[i] = 0;
+}
+
+// ֲ߳̾ʵ, ߳˳ʱ
+struct drbg_thread_slot {
+    sm4_drbg drbg;
+    drbg_thread_slot() {
+        drbg.instantiated = 0;
+    }
+    ~drbg_thread_slot() {
+        sm4_drbg_uninstantiate(&drbg);
+    }
+};
+
+static std::atomic<uint64_t> drbg_thread_seq(0);
+
+sm4_drbg* sm4_drbg_thread(void) {
+    static thread_local drbg_thread_slot slot;
+    if (!slot.drbg.instantiated) {
+        // nonce: ߳ || ʱ, ڸʵͬ
+        uint8_t nonce[16];
+        uint64_t seq = drbg_thread_seq.fetch_add(1);
+        uint64_t t = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32);
+        for (int i = 0; i < 8; i++) {
+            nonce[i] = (uint8_t)(seq >> (8 * i));
+            nonce[8 + i] = (uint8_t)(t >> (8 * i));
+        }
+        static const uint8_t pers[] = "SM4-DRBG thread";
+        if (sm4_drbg_instantiate(&slot.drbg, NULL, NULL, nonce, sizeof(nonce),
+            pers, sizeof(pers) - 1) != 0) {
+            return NULL;
+        }
+    }
+    return &slot.drbg;
+}
+
+int sm4_drbg_rand(uint8_t* out, size_t len) {
+    sm4_drbg* d = sm4_drbg_thread();
+    if (d == NULL) {
+        return -1;
+    }
+    return sm4_drbg_generate(d, out, len, NULL, 0);
+}
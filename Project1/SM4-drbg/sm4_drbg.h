@@ -0,0 +1,53 @@
+#ifndef SM4_DRBG_H
+#define SM4_DRBG_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../SM4-aesni/sm4_aesni.h"
+
+// SM4Ϊ CTR_DRBG (NIST SP 800-90A), ʹ Block_Cipher_df:
+// keylen = outlen = 128 λ, seedlen = 256 λ, Ϊ128λ V.
+//  V+1 CTRԿ,  sm4_ctr_xor ѡں, SM4-CTRͬ
+
+#define SM4_DRBG_SEED_LEN        32                 // seedlen (ֽ)
+#define SM4_DRBG_ENTROPY_LEN     32                 // ÿʵ/زȡ(ֽ)
+#define SM4_DRBG_MAX_REQUEST     (1 << 16)          //  2^19 λ
+#define SM4_DRBG_RESEED_INTERVAL (1ULL << 48)       // زּ
+
+// Դ:  buf д len ֽ, ɹ0
+typedef int (*sm4_drbg_entropy_fn)(void* arg, uint8_t* buf, size_t len);
+
+typedef struct {
+    SM4_Key key;                    // ǰ Key Կ
+    uint8_t V[16];
+    uint64_t reseed_counter;        // ϴ() + 1
+    uint64_t reseed_interval;       //  generate ȴԴز
+    int prediction_resistance;      // 0ʱÿ generate ǰԴز
+    sm4_drbg_entropy_fn entropy;
+    void* entropy_arg;
+    uint64_t reseeds;               // ۼزִ(Զ)
+    int instantiated;
+} sm4_drbg;
+
+// ϵͳԴ: POSIX  /dev/urandom, Windows  rand_s
+int sm4_drbg_system_entropy(void* arg, uint8_t* buf, size_t len);
+
+// entropy Ϊ NULL ʱʹϵͳԴ. nonce/pers Ϊ. Դʧܷ-1
+int sm4_drbg_instantiate(sm4_drbg* drbg, sm4_drbg_entropy_fn entropy, void* entropy_arg,
+    const uint8_t* nonce, size_t nonce_len, const uint8_t* pers, size_t pers_len);
+int sm4_drbg_reseed(sm4_drbg* drbg, const uint8_t* add, size_t add_len);
+//  SM4_DRBG_MAX_REQUEST ޲ɶ, ֻڵһ.
+// زּԤ⿹ʱز, Դʧܷ-1 Ҳ
+int sm4_drbg_generate(sm4_drbg* drbg, uint8_t* out, size_t len,
+    const uint8_t* add, size_t add_len);
+void sm4_drbg_set_reseed_interval(sm4_drbg* drbg, uint64_t interval);
+void sm4_drbg_set_prediction_resistance(sm4_drbg* drbg, int enable);
+// ڲ״̬
+void sm4_drbg_uninstantiate(sm4_drbg* drbg);
+
+// ÿ߳ʵ: ߳״εʱϵͳԴʵ(nonce ߳źʱ),
+// ߳˳ʱ, ֮䲻Ҫ
+sm4_drbg* sm4_drbg_thread(void);
+int sm4_drbg_rand(uint8_t* out, size_t len);
+
+#endif // SM4_DRBG_H
@@ -0,0 +1,125 @@
+#include "sm4_drbg.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <thread>
+#include <vector>
+
+// Ƚʮƴ
+static int hex_equal(const uint8_t* data, const char* hex) {
+    size_t n = strlen(hex) / 2;
+    for (size_t i = 0; i < n; i++) {
+        unsigned int b;
+        sscanf(hex + 2 * i, "%2x", &b);
+        if (data[i] != (uint8_t)b) return 0;
+    }
+    return 1;
+}
+
+// Դ:  base, base+1, ... ; fail 0ʱģԴ
+typedef struct {
+    uint8_t base;
+    int calls;
+    int fail;
+} test_entropy;
+
+static int test_entropy_fn(void* arg, uint8_t* buf, size_t len) {
+    test_entropy* e = (test_entropy*)arg;
+    e->calls++;
+    if (e->fail) return -1;
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(e->base + i);
+    return 0;
+}
+
+int main() {
+    // 1. :  00..1f, nonce a0..a7, Ի "pers"; 80ֽ,  "ad"
+    //    40ֽ, ظΪ 40..5f  "ad" ز, 33ֽ ( OpenSSL 
+    //    SM4-CTR Ϊ㷨 CTR-DRBG һ)
+    test_entropy ent = { 0x00, 0, 0 };
+    const uint8_t nonce[8] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7 };
+    const uint8_t ad[2] = { 'a', 'd' };
+    uint8_t out[80];
+    sm4_drbg drbg;
+    int ok = sm4_drbg_instantiate(&drbg, test_entropy_fn, &ent, nonce, sizeof(nonce),
+        (const uint8_t*)"pers", 4) == 0;
+    sm4_drbg_generate(&drbg, out, 80, NULL, 0);
+    ok = ok && hex_equal(out, "ecbe9a0aacdfc0e1a9d4410b555b87b888a08c66dea5d7c5fbff3923a8ce316c"
+        "db4a979d0684ea72fc34628388638d4ed4de019cbc84788c8092bd9f96c056c578c648759fa8414d"
+        "7a812e316dc076b8");
+    sm4_drbg_generate(&drbg, out, 40, ad, sizeof(ad));
+    ok = ok && hex_equal(out, "9b904d78ced04e1575a0d113d90d775b2aba7494ea79a815a2e90fbe2da85c2c"
+        "303c377d750e3b88");
+    ent.base = 0x40;
+    sm4_drbg_reseed(&drbg, ad, sizeof(ad));
+    sm4_drbg_generate(&drbg, out, 33, NULL, 0);
+    ok = ok && hex_equal(out, "fcf0f3b29f8cdba5d92019f5019be6d159b17dea99ac9e6446feda05018ee3fd61");
+    printf(": %s\n", ok ? "ͨ" : "ʧ");
+
+    // 2. زּԤ⿹: ÿ3Զزһ; Ԥ⿹Ժÿȡ.
+    //    ԴʱʧҲ
+    ent.calls = 0;
+    sm4_drbg_set_reseed_interval(&drbg, 3);
+    for (int i = 0; i < 8; i++) sm4_drbg_generate(&drbg, out, 16, NULL, 0);
+    int reseed_ok = ent.calls == 2;
+    ent.calls = 0;
+    sm4_drbg_set_prediction_resistance(&drbg, 1);
+    for (int i = 0; i < 5; i++) sm4_drbg_generate(&drbg, out, 16, ad, sizeof(ad));
+    reseed_ok = reseed_ok && ent.calls == 5;
+    ent.fail = 1;
+    memset(out, 0x5a, 16);
+    reseed_ok = reseed_ok && sm4_drbg_generate(&drbg, out, 16, NULL, 0) == -1 && out[0] == 0x5a;
+    printf("ز/Ԥ⿹: %s (ۼز %llu )\n", reseed_ok ? "ͨ" : "ʧ",
+        (unsigned long long)drbg.reseeds);
+    sm4_drbg_uninstantiate(&drbg);
+
+    // 3. ÿ߳ʵ: ̵߳ʵͬ
+    const int nthreads = 4;
+    std::vector<std::thread> threads;
+    sm4_drbg* inst[nthreads];
+    uint8_t first[nthreads][32];
+    for (int t = 0; t < nthreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            static thread_local uint8_t buf[1 << 16];
+            inst[t] = sm4_drbg_thread();
+            sm4_drbg_rand(first[t], 32);
+            for (int r = 0; r < 16; r++) sm4_drbg_rand(buf, sizeof(buf));
+        }));
+    }
+    for (int t = 0; t < nthreads; t++) threads[t].join();
+    int thread_ok = 1;
+    for (int a = 0; a < nthreads; a++) {
+        for (int b = a + 1; b < nthreads; b++) {
+            thread_ok = thread_ok && inst[a] != inst[b] && memcmp(first[a], first[b], 32) != 0;
+        }
+    }
+    printf("ÿ߳ʵ: %s\n", thread_ok ? "ͨ" : "ʧ");
+
+    // 4. : ԭʼ SM4-CTR Ƚ; С(16ֽIV)ÿεõĿ
+    {
+        static uint8_t big[1 << 20];
+        uint8_t ctr[16] = { 0 };
+        SM4_Key key;
+        uint8_t user_key[16] = { 0 };
+        SM4_KeyInit(user_key, &key);
+        sm4_drbg_rand(big, 16);
+        const int rounds = 128;
+        clock_t start = clock();
+        for (int r = 0; r < rounds; r++) sm4_ctr_xor(&key, ctr, big, big, sizeof(big));
+        clock_t end = clock();
+        double t_ctr = ((double)(end - start)) / CLOCKS_PER_SEC;
+        start = clock();
+        for (int r = 0; r < rounds; r++) sm4_drbg_rand(big, sizeof(big));
+        end = clock();
+        double t_drbg = ((double)(end - start)) / CLOCKS_PER_SEC;
+        printf("1MB: SM4-CTR %.2f MB/s, DRBG %.2f MB/s\n",
+            rounds / t_ctr, rounds / t_drbg);
+
+        const int small = 200000;
+        start = clock();
+        for (int r = 0; r < small; r++) sm4_drbg_rand(big, 16);
+        end = clock();
+        printf("16ֽ: %.3f us/\n", ((double)(end - start)) / CLOCKS_PER_SEC / small * 1e6);
+    }
+
+    return (ok && reseed_ok && thread_ok) ? 0 : 1;
+}
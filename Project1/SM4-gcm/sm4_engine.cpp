@@ -0,0 +1,393 @@
+#include "sm4_engine.h"
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock sm4_clock;
+
+// н (Vyukov): ÿ۴, CASռ tail, Ψһ
+// ˳ head.  == pos ʾ, == pos + 1 ʾд
+typedef struct {
+    std::atomic<size_t> seq;
+    sm4_job* job;
+} engine_slot;
+
+// tail  head ǰһ, 64ֽڶ
+// (C++14  new ֤ alignas(64))
+#define ENGINE_CACHE_LINE 64
+
+struct engine_ring {
+    std::vector<engine_slot> slots;
+    size_t mask;
+    char pad0[ENGINE_CACHE_LINE];
+    std::atomic<size_t> tail;   // 
+    char pad1[ENGINE_CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> head;   // , ֻͳƶ
+    char pad2[ENGINE_CACHE_LINE - sizeof(std::atomic<size_t>)];
+    // ߳̿ʱڴ˵ȴ, ύ sleeping ȥ
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> sleeping;
+};
+
+static void ring_init(engine_ring* r, size_t size) {
+    size_t n = 2;
+    while (n < size) n *= 2;
+    r->slots = std::vector<engine_slot>(n);
+    for (size_t i = 0; i < n; i++) {
+        r->slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    r->mask = n - 1;
+    r->tail.store(0);
+    r->head.store(0);
+    r->sleeping.store(false);
+}
+
+static bool ring_push(engine_ring* r, sm4_job* job) {
+    size_t pos = r->tail.load(std::memory_order_relaxed);
+    engine_slot* s;
+    for (;;) {
+        s = &r->slots[pos & r->mask];
+        size_t seq = s->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (r->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            return false;   // 
+        }
+        else {
+            pos = r->tail.load(std::memory_order_relaxed);
+        }
+    }
+    s->job = job;
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static sm4_job* ring_pop(engine_ring* r) {
+    size_t pos = r->head.load(std::memory_order_relaxed);
+    engine_slot* s = &r->slots[pos & r->mask];
+    if (s->seq.load(std::memory_order_acquire) != pos + 1) {
+        return NULL;
+    }
+    sm4_job* job = s->job;
+    s->seq.store(pos + r->mask + 1, std::memory_order_release);
+    r->head.store(pos + 1, std::memory_order_relaxed);
+    return job;
+}
+
+static size_t ring_depth(const engine_ring* r) {
+    size_t tail = r->tail.load(std::memory_order_relaxed);
+    size_t head = r->head.load(std::memory_order_relaxed);
+    return (tail > head) ? tail - head : 0;
+}
+
+struct sm4_engine {
+    sm4_engine_config cfg;
+    std::vector<engine_ring*> rings;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stop;
+    std::atomic<unsigned int> next_ring;
+    std::atomic<uint64_t> submitted, completed, rejected;
+    std::atomic<uint64_t> batches, full_batches, deadline_batches;
+    std::atomic<size_t> max_depth;
+};
+
+void sm4_engine_default_config(sm4_engine_config* cfg) {
+    cfg->nworkers = 0;
+    cfg->ring_size = 1024;
+    cfg->batch_jobs = 16;
+    cfg->max_delay_us = 50;
+}
+
+// ϢCTR: ÿϢ256ֽڵĲֱ sm4_ctr_xor, Ϣʣµ
+// ͬһ, 16һSM4
+static void engine_ctr_batch(const SM4_Key* key, sm4_job** jobs, int n) {
+    uint8_t blocks[256];
+    uint8_t* dst[16];
+    const uint8_t* src[16];
+    size_t bytes[16];
+    uint8_t ctr[SM4_ENGINE_MAX_BATCH][16];
+    size_t pos[SM4_ENGINE_MAX_BATCH];
+    int m, nb = 0;
+
+    for (m = 0; m < n; m++) {
+        sm4_job* j = jobs[m];
+        size_t bulk = j->len - j->len % 256;
+        memcpy(ctr[m], j->iv, 16);
+        if (bulk) {
+            sm4_ctr_xor(key, ctr[m], j->in, j->out, bulk);
+            sm4_ctr_add(ctr[m], bulk / 16);
+        }
+        pos[m] = bulk;
+    }
+    for (m = 0; m < n || nb > 0;) {
+        while (nb < 16 && m < n) {
+            sm4_job* j = jobs[m];
+            if (pos[m] == j->len) {
+                m++;
+                continue;
+            }
+            size_t left = j->len - pos[m];
+            memcpy(blocks + 16 * nb, ctr[m], 16);
+            sm4_ctr_add(ctr[m], 1);
+            dst[nb] = j->out + pos[m];
+            src[nb] = j->in + pos[m];
+            bytes[nb] = (left < 16) ? left : 16;
+            pos[m] += bytes[nb];
+            nb++;
+        }
+        if (nb == 0) {
+            break;
+        }
+        sm4_ecb_encrypt_blocks(key, blocks, blocks, nb);
+        for (int i = 0; i < nb; i++) {
+            for (size_t k = 0; k < bytes[i]; k++) {
+                dst[i][k] = src[i][k] ^ blocks[16 * i + k];
+            }
+        }
+        nb = 0;
+    }
+}
+
+// sm4_job.done ȡֵ
+#define JOB_PENDING 0
+#define JOB_DONE    1
+#define JOB_PARKED  2   // ߳ sm4_job_wait 
+
+// ȴַ߰ɢеһ, ش.
+// ͬһͰĶһ, ʱ notify_all Ը
+#define ENGINE_PARK_BUCKETS 64
+
+typedef struct {
+    std::mutex mtx;
+    std::condition_variable cv;
+} engine_park_bucket;
+
+static engine_park_bucket engine_park[ENGINE_PARK_BUCKETS];
+
+static engine_park_bucket* park_bucket(const sm4_job* job) {
+    return &engine_park[((uintptr_t)job / sizeof(sm4_job)) % ENGINE_PARK_BUCKETS];
+}
+
+static void engine_complete(sm4_engine* e, sm4_job* job, int result) {
+    job->result = result;
+    e->completed.fetch_add(1, std::memory_order_relaxed);
+    if (job->callback != NULL) {
+        job->callback(job, job->arg);
+        return;
+    }
+    // ֻеȴʱż; ȴڳʱ JOB_PARKED,
+    // õ˵ѽ wait, ©֪ͨ
+    if (job->done.exchange(JOB_DONE, std::memory_order_acq_rel) == JOB_PARKED) {
+        engine_park_bucket* b = park_bucket(job);
+        std::lock_guard<std::mutex> lk(b->mtx);
+        b->cv.notify_all();
+    }
+}
+
+// ͬͬ͡ԿŽͬһ
+static void engine_run_batch(sm4_engine* e, sm4_job** jobs, int n) {
+    sm4_gcm_msg msgs[SM4_ENGINE_MAX_BATCH];
+    sm4_job* group[SM4_ENGINE_MAX_BATCH];
+    bool taken[SM4_ENGINE_MAX_BATCH] = { false };
+
+    for (int i = 0; i < n; i++) {
+        if (taken[i]) continue;
+        int cnt = 0;
+        for (int k = i; k < n; k++) {
+            if (!taken[k] && jobs[k]->type == jobs[i]->type && jobs[k]->key == jobs[i]->key) {
+                taken[k] = true;
+                group[cnt++] = jobs[k];
+            }
+        }
+        if (jobs[i]->type == SM4_JOB_CTR) {
+            engine_ctr_batch(&jobs[i]->key->sm4_key, group, cnt);
+            for (int k = 0; k < cnt; k++) engine_complete(e, group[k], 0);
+            continue;
+        }
+        for (int k = 0; k < cnt; k++) {
+            sm4_job* j = group[k];
+            msgs[k].iv = j->iv;
+            msgs[k].iv_len = j->iv_len;
+            msgs[k].aad = j->aad;
+            msgs[k].aad_len = j->aad_len;
+            msgs[k].in = j->in;
+            msgs[k].out = j->out;
+            msgs[k].len = j->len;
+            msgs[k].tag = j->tag;
+            msgs[k].result = 0;
+        }
+        int ret = (jobs[i]->type == SM4_JOB_GCM_ENCRYPT) ?
+            sm4_gcm_encrypt_batch(jobs[i]->key, msgs, cnt) :
+            sm4_gcm_decrypt_batch(jobs[i]->key, msgs, cnt);
+        for (int k = 0; k < cnt; k++) {
+            engine_complete(e, group[k], (ret < 0) ? -1 : msgs[k].result);
+        }
+    }
+    e->batches.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ߳: ԼĻȡ,  batch_jobs ; ʱӵһ
+//  max_delay_us. ޴ʱ
+static void engine_worker(sm4_engine* e, engine_ring* r) {
+    sm4_job* pending[SM4_ENGINE_MAX_BATCH];
+    int n = 0;
+    int target = e->cfg.batch_jobs;
+    sm4_clock::time_point first;
+    const auto delay = std::chrono::microseconds(e->cfg.max_delay_us);
+
+    for (;;) {
+        sm4_job* job;
+        while (n < target && (job = ring_pop(r)) != NULL) {
+            if (n == 0) first = sm4_clock::now();
+            pending[n++] = job;
+        }
+        if (n == target) {
+            engine_run_batch(e, pending, n);
+            e->full_batches.fetch_add(1, std::memory_order_relaxed);
+            n = 0;
+            continue;
+        }
+        if (n > 0) {
+            if (e->stop.load(std::memory_order_acquire) || sm4_clock::now() - first >= delay) {
+                engine_run_batch(e, pending, n);
+                e->deadline_batches.fetch_add(1, std::memory_order_relaxed);
+                n = 0;
+            }
+            else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        // Ҫټ黷, ύ"뻷ٿ sleeping", ©
+        std::unique_lock<std::mutex> lk(r->mtx);
+        r->sleeping.store(true);
+        if (ring_depth(r) == 0) {
+            if (e->stop.load(std::memory_order_acquire)) {
+                r->sleeping.store(false);
+                return;
+            }
+            r->cv.wait_for(lk, std::chrono::milliseconds(10));
+        }
+        r->sleeping.store(false);
+    }
+}
+
+sm4_engine* sm4_engine_create(const sm4_engine_config* cfg) {
+    sm4_engine* e = new sm4_engine;
+    if (cfg != NULL) {
+        e->cfg = *cfg;
+    }
+    else {
+        sm4_engine_default_config(&e->cfg);
+    }
+    if (e->cfg.nworkers <= 0) {
+        e->cfg.nworkers = (int)std::thread::hardware_concurrency();
+        if (e->cfg.nworkers <= 0) e->cfg.nworkers = 1;
+    }
+    if (e->cfg.batch_jobs < 1) e->cfg.batch_jobs = 1;
+    if (e->cfg.batch_jobs > SM4_ENGINE_MAX_BATCH) e->cfg.batch_jobs = SM4_ENGINE_MAX_BATCH;
+    e->stop.store(false);
+    e->next_ring.store(0);
+    e->submitted.store(0);
+    e->completed.store(0);
+    e->rejected.store(0);
+    e->batches.store(0);
+    e->full_batches.store(0);
+    e->deadline_batches.store(0);
+    e->max_depth.store(0);
+    for (int i = 0; i < e->cfg.nworkers; i++) {
+        engine_ring* r = new engine_ring;
+        ring_init(r, e->cfg.ring_size);
+        e->rings.push_back(r);
+    }
+    for (int i = 0; i < e->cfg.nworkers; i++) {
+        e->workers.push_back(std::thread(engine_worker, e, e->rings[i]));
+    }
+    return e;
+}
+
+void sm4_engine_destroy(sm4_engine* e) {
+    e->stop.store(true, std::memory_order_release);
+    for (size_t i = 0; i < e->rings.size(); i++) {
+        std::lock_guard<std::mutex> lk(e->rings[i]->mtx);
+        e->rings[i]->cv.notify_one();
+    }
+    for (size_t i = 0; i < e->workers.size(); i++) {
+        e->workers[i].join();
+    }
+    for (size_t i = 0; i < e->rings.size(); i++) {
+        delete e->rings[i];
+    }
+    delete e;
+}
+
+int sm4_engine_submit(sm4_engine* e, sm4_job* job) {
+    // ÿύ̶̹߳һʼ, ͬһ̵߳ͬһ߳
+    static thread_local unsigned int home = ~0u;
+    size_t nrings = e->rings.size();
+    if (home == ~0u) {
+        home = e->next_ring.fetch_add(1, std::memory_order_relaxed);
+    }
+    job->done.store(JOB_PENDING, std::memory_order_relaxed);
+    for (size_t k = 0; k < nrings; k++) {
+        engine_ring* r = e->rings[(home + k) % nrings];
+        if (!ring_push(r, job)) {
+            continue;
+        }
+        e->submitted.fetch_add(1, std::memory_order_relaxed);
+        size_t depth = ring_depth(r);
+        size_t max = e->max_depth.load(std::memory_order_relaxed);
+        while (depth > max &&
+            !e->max_depth.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+        }
+        if (r->sleeping.load()) {
+            std::lock_guard<std::mutex> lk(r->mtx);
+            r->cv.notify_one();
+        }
+        return 0;
+    }
+    e->rejected.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+}
+
+// ȶ (Сͨڼ΢), ֮, 빤߳CPU
+#define JOB_WAIT_SPINS 256
+
+int sm4_job_wait(sm4_job* job) {
+    for (int spin = 0; spin < JOB_WAIT_SPINS; spin++) {
+        if (job->done.load(std::memory_order_acquire) == JOB_DONE) {
+            return job->result;
+        }
+    }
+    engine_park_bucket* b = park_bucket(job);
+    std::unique_lock<std::mutex> lk(b->mtx);
+    int expect = JOB_PENDING;
+    if (job->done.compare_exchange_strong(expect, JOB_PARKED, std::memory_order_acq_rel)) {
+        b->cv.wait(lk, [job]() {
+            return job->done.load(std::memory_order_acquire) == JOB_DONE;
+        });
+    }
+    return job->result;
+}
+
+void sm4_engine_get_stats(sm4_engine* e, sm4_engine_stats* st) {
+    st->submitted = e->submitted.load();
+    st->completed = e->completed.load();
+    st->rejected = e->rejected.load();
+    st->batches = e->batches.load();
+    st->full_batches = e->full_batches.load();
+    st->deadline_batches = e->deadline_batches.load();
+    st->queue_depth = 0;
+    for (size_t i = 0; i < e->rings.size(); i++) {
+        st->queue_depth += ring_depth(e->rings[i]);
+    }
+    st->max_queue_depth = e->max_depth.load();
+}
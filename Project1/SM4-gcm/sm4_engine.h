@@ -0,0 +1,79 @@
+#ifndef SM4_ENGINE_H
+#define SM4_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "sm4_gcm.h"
+
+// 첽ӽ: ߳ύСڹ߳дճ, 
+// sm4_gcm_encrypt_batch/decrypt_batch ϢCTR, 4/8/16·ں˾.
+// ÿ߳һMPSCύ, ύ̷߳ɢ, ʱһ
+
+#define SM4_JOB_GCM_ENCRYPT 0   // tag 
+#define SM4_JOB_GCM_DECRYPT 1   // tag ΪУǩ, ʧʱ
+#define SM4_JOB_CTR         2   // ͬ sm4_ctr_xor: iv Ϊ16ֽڳʼ,  aad/tag
+
+// һദ
+#define SM4_ENGINE_MAX_BATCH 64
+
+typedef struct sm4_job sm4_job;
+typedef void (*sm4_job_callback)(sm4_job* job, void* arg);
+
+// , ɵ÷, ǰ뱣ЧҲ޸
+struct sm4_job {
+    int type;                   // SM4_JOB_*
+    const sm4_gcm_key* key;     // CTR ʹе sm4_key
+    const uint8_t* iv;
+    size_t iv_len;
+    const uint8_t* aad;
+    size_t aad_len;
+    const uint8_t* in;
+    uint8_t* out;               //  in ͬ
+    size_t len;
+    uint8_t* tag;
+    // ֪ͨѡһ:  callback ʱڹ߳е, ֮治ٷʸ
+    // (صпͷ);  sm4_job_wait ȴ
+    sm4_job_callback callback;
+    void* arg;
+    int result;                 // ɺЧ: 0 ɹ, -1 ֤ʧܻ
+    std::atomic<int> done;      //  sm4_engine_submit 
+};
+
+typedef struct {
+    int nworkers;               // ߳, <=0 ʱȡCPU
+    size_t ring_size;           // ÿύ, ȡ2
+    int batch_jobs;             // չô, ԽԽ (<= SM4_ENGINE_MAX_BATCH)
+    unsigned int max_delay_us;  // еһȴʱ, ӳ; 0 ʾȴ
+} sm4_engine_config;
+
+typedef struct {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t rejected;          // л, ύʧܵĴ
+    uint64_t batches;
+    uint64_t full_batches;      //  batch_jobs 
+    uint64_t deadline_batches;  // ȴʱֹͣʱδʹ
+    size_t queue_depth;         // ǰύδ߳ȡߵ
+    size_t max_queue_depth;     // ۲쵽ֵ
+} sm4_engine_stats;
+
+typedef struct sm4_engine sm4_engine;
+
+// Ĭ: CPU߳, 1024, ÿ16, 50΢
+void sm4_engine_default_config(sm4_engine_config* cfg);
+
+sm4_engine* sm4_engine_create(const sm4_engine_config* cfg);
+// ύֹͣ߳
+void sm4_engine_destroy(sm4_engine* engine);
+
+// ύ, лʱ-1 (÷Ժ)
+int sm4_engine_submit(sm4_engine* engine, sm4_job* job);
+
+// ȴδص,  job->result. ȶ, δʱ,
+// ɹ߳ʱ
+int sm4_job_wait(sm4_job* job);
+
+void sm4_engine_get_stats(sm4_engine* engine, sm4_engine_stats* stats);
+
+#endif // SM4_ENGINE_H
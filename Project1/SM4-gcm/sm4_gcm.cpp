@@ -1,122 +1,26 @@
 #include "sm4_gcm.h"
 #include <string.h>
-
-// SM4 S
-static const uint8_t SM4_SBOX[256] = {
-    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2, 0x28, 0xfb, 0x2c, 0x05,
-    0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3, 0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99,
-    0x9c, 0x42, 0x50, 0xf4, 0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
-    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa, 0x75, 0x8f, 0x3f, 0xa6,
-    0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba, 0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8,
-    0x68, 0x6b, 0x81, 0xb2, 0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
-    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b, 0x01, 0x21, 0x78, 0x87,
-    0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52, 0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e,
-    0xea, 0xbf, 0x8a, 0xd2, 0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
-    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30, 0xf5, 0x8c, 0xb1, 0xe3,
-    0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60, 0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f,
-    0xd5, 0xdb, 0x37, 0x45, 0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
-    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41, 0x1f, 0x10, 0x5a, 0xd8,
-    0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd, 0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0,
-    0x89, 0x69, 0x97, 0x4a, 0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
-    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e, 0xd7, 0xcb, 0x39, 0x48
-};
-
-// SM4ϵͳFK
-static const uint32_t FK[4] = {
-    0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc
-};
-
-// SM4̶CK
-static const uint32_t CK[32] = {
-    0x00070e15, 0x1c232a31, 0x383f464d, 0x545b6269,
-    0x70777e85, 0x8c939aa1, 0xa8afb6bd, 0xc4cbd2d9,
-    0xe0e7eef5, 0xfc030a11, 0x181f262d, 0x343b4249,
-    0x50575e65, 0x6c737a81, 0x888f969d, 0xa4abb2b9,
-    0xc0c7ced5, 0xdce3eaf1, 0xf8ff060d, 0x141b2229,
-    0x30373e45, 0x4c535a61, 0x686f767d, 0x848b9299,
-    0xa0a7aeb5, 0xbcc3cad1, 0xd8dfe6ed, 0xf4fb0209,
-    0x10171e25, 0x2c333a41, 0x484f565d, 0x646b7279
-};
-
-// SM4Ա任L
-static uint32_t sm4_L(uint32_t b) {
-    return b ^ ROTL32(b, 2) ^ ROTL32(b, 10) ^ ROTL32(b, 18) ^ ROTL32(b, 24);
-}
-
-// SM4Ա任L'
-static uint32_t sm4_L_prime(uint32_t b) {
-    return b ^ ROTL32(b, 13) ^ ROTL32(b, 23);
-}
-
-// SM4ֺF
-static uint32_t sm4_F(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3, uint32_t rk) {
-    uint32_t t = x1 ^ x2 ^ x3 ^ rk;
-    t = (SM4_SBOX[t >> 24] << 24) |
-        (SM4_SBOX[(t >> 16) & 0xff] << 16) |
-        (SM4_SBOX[(t >> 8) & 0xff] << 8) |
-        SM4_SBOX[t & 0xff];
-    return x0 ^ sm4_L(t);
-}
-
-// SM4Կչ
-static void sm4_key_schedule(const uint8_t* key, uint32_t* rk) {
-    uint32_t MK[4];
-    uint32_t K[36];
-
-    // Կ
-    for (int i = 0; i < 4; i++) {
-        MK[i] = (key[i * 4] << 24) | (key[i * 4 + 1] << 16) | (key[i * 4 + 2] << 8) | key[i * 4 + 3];
-    }
-
-    // мԿ
-    for (int i = 0; i < 32; i++) {
-        if (i < 4) {
-            K[i] = MK[i] ^ FK[i];
-        }
-        else {
-            uint32_t t = K[i - 1] ^ K[i - 2] ^ K[i - 3] ^ CK[i - 4];
-            t = (SM4_SBOX[t >> 24] << 24) |
-                (SM4_SBOX[(t >> 16) & 0xff] << 16) |
-                (SM4_SBOX[(t >> 8) & 0xff] << 8) |
-                SM4_SBOX[t & 0xff];
-            K[i] = K[i - 4] ^ sm4_L_prime(t);
-        }
-        rk[i] = K[i + 4];
-    }
-}
-
-// SM4
-static void sm4_encrypt_block(const uint32_t* rk, const uint8_t* in, uint8_t* out) {
-    uint32_t X[36];
-
-    // 
-    for (int i = 0; i < 4; i++) {
-        X[i] = (in[i * 4] << 24) | (in[i * 4 + 1] << 16) | (in[i * 4 + 2] << 8) | in[i * 4 + 3];
-    }
-
-    // 32ֵ
-    for (int i = 0; i < 32; i++) {
-        X[i + 4] = sm4_F(X[i], X[i + 1], X[i + 2], X[i + 3], rk[i]);
-    }
-
-    // 任
-    for (int i = 0; i < 16; i++) {
-        out[i] = X[35 - (i / 4)] >> (8 * (3 - (i % 4))) & 0xff;
-    }
-}
+#include <immintrin.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 // 򵥵GF(2^128)˷ʵ
 static void gf128_mult(const uint8_t* x, const uint8_t* y, uint8_t* z) {
     uint8_t v[16];
+    uint8_t acc[16];
     uint8_t r = 0xE1; // x^128 + x^7 + x^2 + x + 1
 
-    memset(z, 0, 16);
+    // z  x ͬ, ۼӵʱ
+    memset(acc, 0, 16);
     memcpy(v, y, 16);
 
     for (int i = 0; i < 128; i++) {
         if (x[i / 8] & (1 << (7 - (i % 8)))) {
             for (int j = 0; j < 16; j++) {
-                z[j] ^= v[j];
+                acc[j] ^= v[j];
             }
         }
 
@@ -130,41 +34,268 @@ static void gf128_mult(const uint8_t* x, const uint8_t* y, uint8_t* z) {
             v[0] ^= r;
         }
     }
+    memcpy(z, acc, 16);
 }
 
-// GHASH
-static void ghash(const uint8_t* H, const uint8_t* aad, size_t aad_len,
-    const uint8_t* ciphertext, size_t cipher_len, uint8_t* tag) {
-    uint8_t X[16] = { 0 };
-    uint8_t temp[16];
+// Shoup: ÿδ SM4_GCM_TABLE_BITS λ,  HL/HH[i] = i * H,
+// i λӦ x^0. Ƴĵλ rem ۻظ16λ
+#if SM4_GCM_TABLE_BITS == 8
+static const uint16_t gf128_rem8[256] = {
+    0x0000, 0x01c2, 0x0384, 0x0246, 0x0708, 0x06ca, 0x048c, 0x054e,
+    0x0e10, 0x0fd2, 0x0d94, 0x0c56, 0x0918, 0x08da, 0x0a9c, 0x0b5e,
+    0x1c20, 0x1de2, 0x1fa4, 0x1e66, 0x1b28, 0x1aea, 0x18ac, 0x196e,
+    0x1230, 0x13f2, 0x11b4, 0x1076, 0x1538, 0x14fa, 0x16bc, 0x177e,
+    0x3840, 0x3982, 0x3bc4, 0x3a06, 0x3f48, 0x3e8a, 0x3ccc, 0x3d0e,
+    0x3650, 0x3792, 0x35d4, 0x3416, 0x3158, 0x309a, 0x32dc, 0x331e,
+    0x2460, 0x25a2, 0x27e4, 0x2626, 0x2368, 0x22aa, 0x20ec, 0x212e,
+    0x2a70, 0x2bb2, 0x29f4, 0x2836, 0x2d78, 0x2cba, 0x2efc, 0x2f3e,
+    0x7080, 0x7142, 0x7304, 0x72c6, 0x7788, 0x764a, 0x740c, 0x75ce,
+    0x7e90, 0x7f52, 0x7d14, 0x7cd6, 0x7998, 0x785a, 0x7a1c, 0x7bde,
+    0x6ca0, 0x6d62, 0x6f24, 0x6ee6, 0x6ba8, 0x6a6a, 0x682c, 0x69ee,
+    0x62b0, 0x6372, 0x6134, 0x60f6, 0x65b8, 0x647a, 0x663c, 0x67fe,
+    0x48c0, 0x4902, 0x4b44, 0x4a86, 0x4fc8, 0x4e0a, 0x4c4c, 0x4d8e,
+    0x46d0, 0x4712, 0x4554, 0x4496, 0x41d8, 0x401a, 0x425c, 0x439e,
+    0x54e0, 0x5522, 0x5764, 0x56a6, 0x53e8, 0x522a, 0x506c, 0x51ae,
+    0x5af0, 0x5b32, 0x5974, 0x58b6, 0x5df8, 0x5c3a, 0x5e7c, 0x5fbe,
+    0xe100, 0xe0c2, 0xe284, 0xe346, 0xe608, 0xe7ca, 0xe58c, 0xe44e,
+    0xef10, 0xeed2, 0xec94, 0xed56, 0xe818, 0xe9da, 0xeb9c, 0xea5e,
+    0xfd20, 0xfce2, 0xfea4, 0xff66, 0xfa28, 0xfbea, 0xf9ac, 0xf86e,
+    0xf330, 0xf2f2, 0xf0b4, 0xf176, 0xf438, 0xf5fa, 0xf7bc, 0xf67e,
+    0xd940, 0xd882, 0xdac4, 0xdb06, 0xde48, 0xdf8a, 0xddcc, 0xdc0e,
+    0xd750, 0xd692, 0xd4d4, 0xd516, 0xd058, 0xd19a, 0xd3dc, 0xd21e,
+    0xc560, 0xc4a2, 0xc6e4, 0xc726, 0xc268, 0xc3aa, 0xc1ec, 0xc02e,
+    0xcb70, 0xcab2, 0xc8f4, 0xc936, 0xcc78, 0xcdba, 0xcffc, 0xce3e,
+    0x9180, 0x9042, 0x9204, 0x93c6, 0x9688, 0x974a, 0x950c, 0x94ce,
+    0x9f90, 0x9e52, 0x9c14, 0x9dd6, 0x9898, 0x995a, 0x9b1c, 0x9ade,
+    0x8da0, 0x8c62, 0x8e24, 0x8fe6, 0x8aa8, 0x8b6a, 0x892c, 0x88ee,
+    0x83b0, 0x8272, 0x8034, 0x81f6, 0x84b8, 0x857a, 0x873c, 0x86fe,
+    0xa9c0, 0xa802, 0xaa44, 0xab86, 0xaec8, 0xaf0a, 0xad4c, 0xac8e,
+    0xa7d0, 0xa612, 0xa454, 0xa596, 0xa0d8, 0xa11a, 0xa35c, 0xa29e,
+    0xb5e0, 0xb422, 0xb664, 0xb7a6, 0xb2e8, 0xb32a, 0xb16c, 0xb0ae,
+    0xbbf0, 0xba32, 0xb874, 0xb9b6, 0xbcf8, 0xbd3a, 0xbf7c, 0xbebe
+};
+#else
+static const uint16_t gf128_rem4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+#endif
 
-    // AAD
-    size_t aad_blocks = (aad_len + 15) / 16;
-    for (size_t i = 0; i < aad_blocks; i++) {
-        memset(temp, 0, 16);
-        size_t copy_len = (i == aad_blocks - 1) ? aad_len - i * 16 : 16;
-        memcpy(temp, aad + i * 16, copy_len);
+static uint64_t load_be64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
 
-        for (int j = 0; j < 16; j++) {
-            X[j] ^= temp[j];
+static void store_be64(uint64_t v, uint8_t* p) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+// ʱȽ16ֽڱǩ: ֽ, ʱһֽͬڵλ޹
+static int gcm_tag_equal(const uint8_t* a, const uint8_t* b) {
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static void gf128_table_init(const uint8_t* H, uint64_t* HL, uint64_t* HH) {
+    uint64_t vh = load_be64(H);
+    uint64_t vl = load_be64(H + 8);
+
+    HL[0] = 0;
+    HH[0] = 0;
+    HL[SM4_GCM_TABLE_SIZE / 2] = vl;
+    HH[SM4_GCM_TABLE_SIZE / 2] = vh;
+    // λ: γ x
+    for (int i = SM4_GCM_TABLE_SIZE / 4; i > 0; i >>= 1) {
+        uint64_t T = (vl & 1) ? 0xe100000000000000ULL : 0;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ T;
+        HL[i] = vl;
+        HH[i] = vh;
+    }
+    // Ϊλ
+    for (int i = 2; i < SM4_GCM_TABLE_SIZE; i <<= 1) {
+        for (int j = 1; j < i; j++) {
+            HL[i + j] = HL[i] ^ HL[j];
+            HH[i + j] = HH[i] ^ HH[j];
         }
-        gf128_mult(X, H, X);
     }
+}
 
-    // 
-    size_t cipher_blocks = (cipher_len + 15) / 16;
-    for (size_t i = 0; i < cipher_blocks; i++) {
-        memset(temp, 0, 16);
-        size_t copy_len = (i == cipher_blocks - 1) ? cipher_len - i * 16 : 16;
-        memcpy(temp, ciphertext + i * 16, copy_len);
+// X = X * H
+static void gf128_mult_table(const uint64_t* HL, const uint64_t* HH, uint8_t* X) {
+    uint64_t zh = 0, zl = 0;
+#if SM4_GCM_TABLE_BITS == 8
+    for (int i = 15; i >= 0; i--) {
+        if (i != 15) {
+            uint8_t rem = (uint8_t)zl;
+            zl = (zh << 56) | (zl >> 8);
+            zh = (zh >> 8) ^ ((uint64_t)gf128_rem8[rem] << 48);
+        }
+        zh ^= HH[X[i]];
+        zl ^= HL[X[i]];
+    }
+#else
+    for (int i = 15; i >= 0; i--) {
+        uint8_t lo = X[i] & 0xf;
+        uint8_t hi = X[i] >> 4;
+        uint8_t rem;
+        if (i != 15) {
+            rem = (uint8_t)zl & 0xf;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ ((uint64_t)gf128_rem4[rem] << 48);
+        }
+        zh ^= HH[lo];
+        zl ^= HL[lo];
+        rem = (uint8_t)zl & 0xf;
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ ((uint64_t)gf128_rem4[rem] << 48);
+        zh ^= HH[hi];
+        zl ^= HL[hi];
+    }
+#endif
+    store_be64(zh, X);
+    store_be64(zl, X + 8);
+}
+
+static void ghash_blocks_table(const sm4_gcm_key* key, uint8_t* X,
+    const uint8_t* data, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++) {
+        for (int j = 0; j < 16; j++) {
+            X[j] ^= data[i * 16 + j];
+        }
+        gf128_mult_table(key->HL, key->HH, X);
+    }
+}
 
+// GHASH(οʵ): X = (X ^ C_i) * H, Ϊ
+static void ghash_blocks_ref(const uint8_t* H, uint8_t* X, const uint8_t* data,
+    size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++) {
         for (int j = 0; j < 16; j++) {
-            X[j] ^= temp[j];
+            X[j] ^= data[i * 16 + j];
         }
         gf128_mult(X, H, X);
     }
+}
 
-    // ȿ
+// PCLMULQDQʵ: ֽڷ, 128x128λ˻ lo/mid/hi ۼ,
+// ˻ֻһԼ
+#define GHASH_BSWAP_MASK \
+    _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+SM4_TARGET("pclmul")
+static inline void gf128_clmul_acc(__m128i a, __m128i b, __m128i* lo,
+    __m128i* mid, __m128i* hi) {
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x10));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x01));
+}
+
+// 256λ˻1λ(ʾ)ģ x^128 + x^7 + x^2 + x + 1 Լ
+static inline __m128i gf128_clmul_reduce(__m128i lo, __m128i mid, __m128i hi) {
+    __m128i t1, t2, t3;
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+    // 1λ
+    t1 = _mm_srli_epi32(lo, 31);
+    t2 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    t3 = _mm_srli_si128(t1, 12);
+    t2 = _mm_slli_si128(t2, 4);
+    t1 = _mm_slli_si128(t1, 4);
+    lo = _mm_or_si128(lo, t1);
+    hi = _mm_or_si128(hi, t2);
+    hi = _mm_or_si128(hi, t3);
+    // һ׶Լ
+    t1 = _mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30));
+    t1 = _mm_xor_si128(t1, _mm_slli_epi32(lo, 25));
+    t2 = _mm_srli_si128(t1, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t1, 12));
+    // ڶ׶Լ
+    t1 = _mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2));
+    t1 = _mm_xor_si128(t1, _mm_srli_epi32(lo, 7));
+    t1 = _mm_xor_si128(t1, t2);
+    lo = _mm_xor_si128(lo, t1);
+    return _mm_xor_si128(hi, lo);
+}
+
+SM4_TARGET("pclmul,ssse3")
+static void gf128_clmul_powers(const uint8_t* H, uint8_t Hpow[8][16]) {
+    __m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)H),
+        GHASH_BSWAP_MASK);
+    __m128i p = h;
+    _mm_storeu_si128((__m128i*)Hpow[0], h);
+    for (int i = 1; i < 8; i++) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        gf128_clmul_acc(p, h, &lo, &mid, &hi);
+        p = gf128_clmul_reduce(lo, mid, hi);
+        _mm_storeu_si128((__m128i*)Hpow[i], p);
+    }
+}
+
+// ÿξۺ8: X' = (X ^ C_1) * H^n ^ C_2 * H^(n-1) ^ ... ^ C_n * H
+SM4_TARGET("pclmul,ssse3")
+static void ghash_blocks_clmul(const uint8_t Hpow[8][16], uint8_t* X,
+    const uint8_t* data, size_t nblocks) {
+    const __m128i bswap = GHASH_BSWAP_MASK;
+    __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)X), bswap);
+    while (nblocks > 0) {
+        int n = (nblocks < 8) ? (int)nblocks : 8;
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        for (int i = 0; i < n; i++) {
+            __m128i c = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*)(data + 16 * i)), bswap);
+            if (i == 0) c = _mm_xor_si128(c, x);
+            gf128_clmul_acc(c, _mm_loadu_si128((const __m128i*)Hpow[n - 1 - i]),
+                &lo, &mid, &hi);
+        }
+        x = gf128_clmul_reduce(lo, mid, hi);
+        data += 16 * n;
+        nblocks -= n;
+    }
+    _mm_storeu_si128((__m128i*)X, _mm_shuffle_epi8(x, bswap));
+}
+
+static void ghash_blocks(const sm4_gcm_key* key, uint8_t* X, const uint8_t* data,
+    size_t nblocks) {
+    switch (key->ghash_impl) {
+    case SM4_GHASH_CLMUL:
+        ghash_blocks_clmul(key->Hpow, X, data, nblocks);
+        break;
+    case SM4_GHASH_TABLE:
+        ghash_blocks_table(key, X, data, nblocks);
+        break;
+    default:
+        ghash_blocks_ref(key->H, X, data, nblocks);
+        break;
+    }
+}
+
+// ⳤ, ĩβһʱ
+static void ghash_update(const sm4_gcm_key* key, uint8_t* X, const uint8_t* data,
+    size_t len) {
+    size_t nblocks = len / 16;
+    uint8_t temp[16];
+    ghash_blocks(key, X, data, nblocks);
+    if (len % 16) {
+        memset(temp, 0, 16);
+        memcpy(temp, data + nblocks * 16, len % 16);
+        ghash_blocks(key, X, temp, 1);
+    }
+}
+
+// ȿ: X = (X ^ [len(A)]64 || [len(C)]64) * H
+static void ghash_final(const sm4_gcm_key* key, uint8_t* X, uint64_t aad_len,
+    uint64_t cipher_len) {
     uint64_t len_bits_aad = aad_len * 8;
     uint64_t len_bits_cipher = cipher_len * 8;
     uint8_t len_block[16];
@@ -172,111 +303,1318 @@ static void ghash(const uint8_t* H, const uint8_t* aad, size_t aad_len,
         len_block[i] = (len_bits_aad >> (56 - i * 8)) & 0xff;
         len_block[i + 8] = (len_bits_cipher >> (56 - i * 8)) & 0xff;
     }
+    ghash_blocks(key, X, len_block, 1);
+}
 
-    for (int j = 0; j < 16; j++) {
-        X[j] ^= len_block[j];
-    }
-    gf128_mult(X, H, X);
+// GHASH
+static void ghash(const sm4_gcm_key* key, const uint8_t* aad, size_t aad_len,
+    const uint8_t* ciphertext, size_t cipher_len, uint8_t* tag) {
+    uint8_t X[16] = { 0 };
+
+    // AAD
+    ghash_update(key, X, aad, aad_len);
+
+    // 
+    ghash_update(key, X, ciphertext, cipher_len);
+
+    // ȿ
+    ghash_final(key, X, aad_len, cipher_len);
 
     memcpy(tag, X, 16);
 }
 
-// GCTR
-static void gctr(const uint32_t* rk, const uint8_t* ICB, const uint8_t* in, uint8_t* out, size_t len) {
-    uint8_t CB[16];
-    uint8_t encrypted[16];
-    size_t blocks = len / 16;
-    size_t rem = len % 16;
+// ÿ16, SM4ںһ, һL1
+#define GCM_BATCH_BYTES 256
 
-    memcpy(CB, ICB, 16);
+// CTR+GHASH: ʱiCTRͬʱѸдĵi-1GHASH;
+// ʱȶԱGHASHٽ, ֧ in == out
+static void gcm_crypt_stitched(const sm4_gcm_key* key, uint8_t* ctr, uint8_t* X,
+    const uint8_t* in, uint8_t* out, size_t len, int enc) {
+    const uint8_t* prev = NULL;
+    size_t prev_len = 0;
 
-    for (size_t i = 0; i < blocks; i++) {
-        sm4_encrypt_block(rk, CB, encrypted);
-        for (int j = 0; j < 16; j++) {
-            out[i * 16 + j] = in[i * 16 + j] ^ encrypted[j];
+    while (len > 0) {
+        size_t n = (len < GCM_BATCH_BYTES) ? len : GCM_BATCH_BYTES;
+        if (enc) {
+            sm4_ctr32_xor(&key->sm4_key, ctr, in, out, n);
+            ghash_update(key, X, prev, prev_len);
+            prev = out;
+            prev_len = n;
         }
-
-        // Ӽ
-        for (int j = 15; j >= 12; j--) {
-            if (++CB[j] != 0) break;
+        else {
+            ghash_update(key, X, in, n);
+            sm4_ctr32_xor(&key->sm4_key, ctr, in, out, n);
         }
+        in += n;
+        out += n;
+        len -= n;
     }
+    ghash_update(key, X, prev, prev_len);
+}
 
-    if (rem > 0) {
-        sm4_encrypt_block(rk, CB, encrypted);
-        for (size_t j = 0; j < rem; j++) {
-            out[blocks * 16 + j] = in[blocks * 16 + j] ^ encrypted[j];
+// J0׸ݼ inc32(J0)
+static void gcm_first_counter(const uint8_t* J0, uint8_t* ctr) {
+    memcpy(ctr, J0, 16);
+    for (int j = 15; j >= 12; j--) {
+        if (++ctr[j] != 0) break;
+    }
+}
+
+int sm4_gcm_set_ghash(sm4_gcm_key* key, int impl) {
+    if (impl == SM4_GHASH_CLMUL) {
+        if (!(SM4_CpuFeatures() & SM4_CPU_PCLMUL)) {
+            return -1;
         }
+        gf128_clmul_powers(key->H, key->Hpow);
+    }
+    else if (impl == SM4_GHASH_TABLE) {
+        gf128_table_init(key->H, key->HL, key->HH);
     }
+    key->ghash_impl = impl;
+    return 0;
 }
 
-// ʼSM4-GCM
-void sm4_gcm_init(sm4_gcm_ctx* ctx, const uint8_t* key, const uint8_t* iv, size_t iv_len) {
+// GCMϢ: (2^32 - 2) 
+#define GCM_MAX_DATA_BYTES ((1ULL << 36) - 32)
+
+// ʽ״̬, J0ֲ
+static void gcm_stream_reset(sm4_gcm_ctx* ctx) {
+    memset(ctx->X, 0, 16);
+    gcm_first_counter(ctx->J0, ctx->ctr);
+    ctx->aad_len = 0;
+    ctx->cipher_len = 0;
+    ctx->stage = SM4_GCM_STAGE_AAD;
+}
+
+// bufδһݲGHASH
+static void gcm_flush_partial(sm4_gcm_ctx* ctx, size_t pos) {
+    if (pos) {
+        memset(ctx->buf + pos, 0, 16 - pos);
+        ghash_blocks(ctx->key, ctx->X, ctx->buf, 1);
+    }
+}
+
+// ԿԤ: ԿHGHASHH/Shoup
+void sm4_gcm_key_init(sm4_gcm_key* key, const uint8_t* user_key) {
     uint8_t zero_block[16] = { 0 };
 
     // Կ
-    sm4_key_schedule(key, ctx->rk);
+    SM4_KeyInit((uint8_t*)user_key, &key->sm4_key);
 
     // H = SM4(0^128)
-    sm4_encrypt_block(ctx->rk, zero_block, ctx->H);
+    sm4_ecb_encrypt_blocks(&key->sm4_key, zero_block, key->H, 1);
+    if (sm4_gcm_set_ghash(key, SM4_GHASH_CLMUL) != 0) {
+        sm4_gcm_set_ghash(key, SM4_GHASH_TABLE);
+    }
+}
 
-    // J0
+// IVJ0: 12ֽIVֱƴӼ1, GHASH
+static void gcm_compute_j0(const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len,
+    uint8_t* J0) {
     if (iv_len == 12) {
-        memcpy(ctx->J0, iv, 12);
-        memset(ctx->J0 + 12, 0, 4);
-        ctx->J0[15] = 1;
+        memcpy(J0, iv, 12);
+        memset(J0 + 12, 0, 4);
+        J0[15] = 1;
     }
     else {
-        // IV
-        ghash(ctx->H, NULL, 0, iv, iv_len, ctx->J0);
+        ghash(key, NULL, 0, iv, iv_len, J0);
     }
+}
 
-    ctx->aad_len = 0;
-    ctx->cipher_len = 0;
+// Ϣʼ: ֻJ0ʽ״̬
+void sm4_gcm_init(sm4_gcm_ctx* ctx, const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len) {
+    ctx->key = key;
+    gcm_compute_j0(key, iv, iv_len, ctx->J0);
+    gcm_stream_reset(ctx);
 }
 
-// SM4-GCM
-int sm4_gcm_encrypt(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len,
-    const uint8_t* aad, size_t aad_len, uint8_t* tag) {
-    uint8_t ICB[16];
+int sm4_gcm_update_aad(sm4_gcm_ctx* ctx, const uint8_t* aad, size_t len) {
+    size_t pos = ctx->aad_len % 16;
+    size_t n;
+
+    if (ctx->stage != SM4_GCM_STAGE_AAD) {
+        return -1;
+    }
+    ctx->aad_len += len;
 
-    // ü
-    memcpy(ICB, ctx->J0, 16);
-    ICB[15] = 1;
+    // Ȳϴʣµİ
+    if (pos) {
+        n = (len < 16 - pos) ? len : 16 - pos;
+        memcpy(ctx->buf + pos, aad, n);
+        if (pos + n < 16) {
+            return 0;
+        }
+        ghash_blocks(ctx->key, ctx->X, ctx->buf, 1);
+        aad += n;
+        len -= n;
+    }
+    ghash_blocks(ctx->key, ctx->X, aad, len / 16);
+    memcpy(ctx->buf, aad + (len & ~(size_t)15), len % 16);
+    return 0;
+}
+
+// ʽCTR+GHASH: 鲿ߵƴ·, βİ龭 ks/buf 
+static int gcm_stream_update(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in,
+    size_t len, int enc) {
+    int stage = enc ? SM4_GCM_STAGE_ENCRYPT : SM4_GCM_STAGE_DECRYPT;
+    size_t pos, n, i;
 
-    // 
-    gctr(ctx->rk, ICB, in, out, len);
+    if (ctx->stage == SM4_GCM_STAGE_AAD) {
+        // AAD, β
+        gcm_flush_partial(ctx, ctx->aad_len % 16);
+        ctx->stage = stage;
+    }
+    else if (ctx->stage != stage) {
+        return -1;
+    }
+    if (len > GCM_MAX_DATA_BYTES - ctx->cipher_len) {
+        return -1;
+    }
+    pos = ctx->cipher_len % 16;
+    ctx->cipher_len += len;
 
-    // ֤ǩ
-    uint8_t S[16] = { 0 };
-    ghash(ctx->H, aad, aad_len, out, len, S);
+    // ϴʣµԿǰ,  in == out
+    if (pos) {
+        n = (len < 16 - pos) ? len : 16 - pos;
+        for (i = 0; i < n; i++) {
+            uint8_t b = in[i];
+            out[i] = b ^ ctx->ks[pos + i];
+            ctx->buf[pos + i] = enc ? out[i] : b;
+        }
+        in += n;
+        out += n;
+        len -= n;
+        if (pos + n < 16) {
+            return 0;
+        }
+        ghash_blocks(ctx->key, ctx->X, ctx->buf, 1);
+    }
 
-    // Sõǩ
-    gctr(ctx->rk, ctx->J0, S, tag, 16);
+    n = len & ~(size_t)15;
+    gcm_crypt_stitched(ctx->key, ctx->ctr, ctx->X, in, out, n, enc);
+    in += n;
+    out += n;
+    len -= n;
 
+    // ĩβһ: һԿ´ε
+    if (len) {
+        memset(ctx->ks, 0, 16);
+        sm4_ctr32_xor(&ctx->key->sm4_key, ctx->ctr, ctx->ks, ctx->ks, 16);
+        for (i = 0; i < len; i++) {
+            uint8_t b = in[i];
+            out[i] = b ^ ctx->ks[i];
+            ctx->buf[i] = enc ? out[i] : b;
+        }
+    }
     return 0;
 }
 
-// SM4-GCM
+int sm4_gcm_encrypt_update(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len) {
+    return gcm_stream_update(ctx, out, in, len, 1);
+}
+
+int sm4_gcm_decrypt_update(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len) {
+    return gcm_stream_update(ctx, out, in, len, 0);
+}
+
+// βGHASHǩ T = SM4(J0) ^ S
+static void gcm_stream_tag(sm4_gcm_ctx* ctx, uint8_t* tag) {
+    uint8_t ctr[16];
+
+    if (ctx->stage == SM4_GCM_STAGE_AAD) {
+        gcm_flush_partial(ctx, ctx->aad_len % 16);
+    }
+    else {
+        gcm_flush_partial(ctx, ctx->cipher_len % 16);
+    }
+    ghash_final(ctx->key, ctx->X, ctx->aad_len, ctx->cipher_len);
+
+    memcpy(ctr, ctx->J0, 16);
+    sm4_ctr32_xor(&ctx->key->sm4_key, ctr, ctx->X, tag, 16);
+    ctx->stage = SM4_GCM_STAGE_DONE;
+}
+
+int sm4_gcm_encrypt_final(sm4_gcm_ctx* ctx, uint8_t* tag) {
+    if (ctx->stage != SM4_GCM_STAGE_AAD && ctx->stage != SM4_GCM_STAGE_ENCRYPT) {
+        return -1;
+    }
+    gcm_stream_tag(ctx, tag);
+    return 0;
+}
+
+int sm4_gcm_decrypt_final(sm4_gcm_ctx* ctx, const uint8_t* tag) {
+    uint8_t computed_tag[16];
+
+    if (ctx->stage != SM4_GCM_STAGE_AAD && ctx->stage != SM4_GCM_STAGE_DECRYPT) {
+        return -1;
+    }
+    gcm_stream_tag(ctx, computed_tag);
+    return gcm_tag_equal(computed_tag, tag) ? 0 : -1;
+}
+
+// SM4-GCM, ͬһĿظ
+int sm4_gcm_encrypt(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, uint8_t* tag) {
+    gcm_stream_reset(ctx);
+    sm4_gcm_update_aad(ctx, aad, aad_len);
+    if (gcm_stream_update(ctx, out, in, len, 1) != 0) {
+        return -1;
+    }
+    return sm4_gcm_encrypt_final(ctx, tag);
+}
+
+// SM4-GCM, ֤ʧʱ
 int sm4_gcm_decrypt(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len,
     const uint8_t* aad, size_t aad_len, const uint8_t* tag) {
-    uint8_t ICB[16];
+    gcm_stream_reset(ctx);
+    sm4_gcm_update_aad(ctx, aad, aad_len);
+    if (gcm_stream_update(ctx, out, in, len, 0) != 0 ||
+        sm4_gcm_decrypt_final(ctx, tag) != 0) {
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
+
+int sm4_gmac(const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len,
+    const uint8_t* data, size_t len, uint8_t* tag) {
+    uint8_t X[16] = { 0 };
+    uint8_t ctr[16];
+
+    gcm_compute_j0(key, iv, iv_len, ctr);
+    ghash_update(key, X, data, len);
+    ghash_final(key, X, len, 0);
+    sm4_ctr32_xor(&key->sm4_key, ctr, X, tag, 16);
+    return 0;
+}
+
+int sm4_gmac_verify(const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len,
+    const uint8_t* data, size_t len, const uint8_t* tag) {
     uint8_t computed_tag[16];
+    sm4_gmac(key, iv, iv_len, data, len, computed_tag);
+    return gcm_tag_equal(computed_tag, tag) ? 0 : -1;
+}
+
+static size_t gcm_iov_total(const sm4_gcm_iovec* iov, size_t cnt) {
+    size_t total = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        total += iov[i].len;
+    }
+    return total;
+}
+
+// Ŀǰ len ֽ
+static void gcm_iov_zero(const sm4_gcm_iovec* iov, size_t cnt, size_t len) {
+    for (size_t i = 0; i < cnt && len > 0; i++) {
+        size_t n = (iov[i].len < len) ? iov[i].len : len;
+        memset(iov[i].base, 0, n);
+        len -= n;
+    }
+}
+
+// һԿдĿĶ, ͬʱռ ct GHASHʹ;  in == out
+static void gcm_iov_xor(const uint8_t* in, uint8_t* out, const uint8_t* ks, uint8_t* ct,
+    size_t n, int enc) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i c = _mm_xor_si128(b, _mm_loadu_si128((const __m128i*)(ks + i)));
+        _mm_storeu_si128((__m128i*)(out + i), c);
+        _mm_storeu_si128((__m128i*)(ct + i), enc ? c : b);
+    }
+    for (; i < n; i++) {
+        uint8_t b = in[i];
+        out[i] = b ^ ks[i];
+        ct[i] = enc ? out[i] : b;
+    }
+}
+
+//  GCM_BATCH_BYTES Ĵڴ: ÿڵԿһSM4ں˵, ͬʱ
+// Դ/Ŀ, ÿȡߵǰʣಿֵĽ϶. εʽӿʱÿζҪ
+// һں˵, Сʱںӳռͷ. һ buf  final 
+static int gcm_iov_crypt(sm4_gcm_ctx* ctx, const sm4_gcm_iovec* dst, size_t dst_cnt,
+    const sm4_gcm_iovec* src, size_t src_cnt, const sm4_gcm_iovec* aad, size_t aad_cnt,
+    int enc) {
+    uint8_t ks[GCM_BATCH_BYTES], ct[GCM_BATCH_BYTES];
+    size_t si = 0, di = 0, soff = 0, doff = 0;
+    size_t len = gcm_iov_total(src, src_cnt);
+
+    if (gcm_iov_total(dst, dst_cnt) < len || len > GCM_MAX_DATA_BYTES) {
+        return -1;
+    }
+    gcm_stream_reset(ctx);
+    for (size_t i = 0; i < aad_cnt; i++) {
+        sm4_gcm_update_aad(ctx, (const uint8_t*)aad[i].base, aad[i].len);
+    }
+    gcm_flush_partial(ctx, ctx->aad_len % 16);
+    ctx->stage = enc ? SM4_GCM_STAGE_ENCRYPT : SM4_GCM_STAGE_DECRYPT;
+    ctx->cipher_len = len;
+
+    while (len > 0) {
+        size_t w = (len < GCM_BATCH_BYTES) ? len : GCM_BATCH_BYTES;
+        size_t pos = 0;
+        memset(ks, 0, w);
+        sm4_ctr32_xor(&ctx->key->sm4_key, ctx->ctr, ks, ks, w);
+        while (pos < w) {
+            if (soff == src[si].len) {
+                si++;
+                soff = 0;
+                continue;
+            }
+            if (doff == dst[di].len) {
+                di++;
+                doff = 0;
+                continue;
+            }
+            size_t n = src[si].len - soff;
+            if (dst[di].len - doff < n) n = dst[di].len - doff;
+            if (w - pos < n) n = w - pos;
+            gcm_iov_xor((const uint8_t*)src[si].base + soff, (uint8_t*)dst[di].base + doff,
+                ks + pos, ct + pos, n, enc);
+            soff += n;
+            doff += n;
+            pos += n;
+        }
+        ghash_blocks(ctx->key, ctx->X, ct, w / 16);
+        memcpy(ctx->buf, ct + (w & ~(size_t)15), w % 16);
+        len -= w;
+    }
+    return 0;
+}
+
+int sm4_gcm_encrypt_iov(sm4_gcm_ctx* ctx, const sm4_gcm_iovec* dst, size_t dst_cnt,
+    const sm4_gcm_iovec* src, size_t src_cnt, const sm4_gcm_iovec* aad, size_t aad_cnt,
+    uint8_t* tag) {
+    if (gcm_iov_crypt(ctx, dst, dst_cnt, src, src_cnt, aad, aad_cnt, 1) != 0) {
+        return -1;
+    }
+    return sm4_gcm_encrypt_final(ctx, tag);
+}
+
+int sm4_gcm_decrypt_iov(sm4_gcm_ctx* ctx, const sm4_gcm_iovec* dst, size_t dst_cnt,
+    const sm4_gcm_iovec* src, size_t src_cnt, const sm4_gcm_iovec* aad, size_t aad_cnt,
+    const uint8_t* tag) {
+    if (gcm_iov_crypt(ctx, dst, dst_cnt, src, src_cnt, aad, aad_cnt, 0) != 0 ||
+        sm4_gcm_decrypt_final(ctx, tag) != 0) {
+        gcm_iov_zero(dst, dst_cnt, gcm_iov_total(src, src_cnt));
+        return -1;
+    }
+    return 0;
+}
+
+// ӿÿϢ, ҲǶ·GHASH·
+#define GCM_BATCH_MSGS 4
+
+// ·GHASHеһ·: AAD(Բ㵽)ͳȿ
+typedef struct {
+    const uint8_t* seg[3];
+    size_t seg_len[3];
+    int cur;
+    size_t off;
+    size_t left;            // ʣ
+    uint8_t pad[16];
+    uint8_t X[16];
+} gcm_ghash_lane;
+
+static void gcm_lane_init(gcm_ghash_lane* lane, const uint8_t* aad, size_t aad_len,
+    const uint8_t* ct, size_t ct_len, const uint8_t* len_block) {
+    lane->seg[0] = aad;
+    lane->seg_len[0] = aad_len;
+    lane->seg[1] = ct;
+    lane->seg_len[1] = ct_len;
+    lane->seg[2] = len_block;
+    lane->seg_len[2] = 16;
+    lane->cur = 0;
+    lane->off = 0;
+    lane->left = (aad_len + 15) / 16 + (ct_len + 15) / 16 + 1;
+    memset(lane->X, 0, 16);
+}
+
+// ȡһ16ֽڷ, βһʱ. صָ´εǰЧ
+static const uint8_t* gcm_lane_next(gcm_ghash_lane* lane) {
+    const uint8_t* p;
+    size_t rest;
+    while (lane->off >= lane->seg_len[lane->cur]) {
+        lane->cur++;
+        lane->off = 0;
+    }
+    p = lane->seg[lane->cur] + lane->off;
+    rest = lane->seg_len[lane->cur] - lane->off;
+    lane->left--;
+    if (rest >= 16) {
+        lane->off += 16;
+        return p;
+    }
+    memset(lane->pad, 0, 16);
+    memcpy(lane->pad, p, rest);
+    lane->off += rest;
+    return lane->pad;
+}
+
+//  GCM_BATCH_MSGS ·ͬʱ8ۺϳ˷, ·ĳ˷,
+// PCLMULQDQӳٿԱ·
+SM4_TARGET("pclmul,ssse3")
+static void ghash_lanes_clmul(const uint8_t Hpow[8][16], gcm_ghash_lane* lanes,
+    int nlanes) {
+    const __m128i bswap = GHASH_BSWAP_MASK;
+    __m128i x[GCM_BATCH_MSGS], lo[GCM_BATCH_MSGS], mid[GCM_BATCH_MSGS],
+        hi[GCM_BATCH_MSGS];
+    int k[GCM_BATCH_MSGS];
+    int l, i, active = 1;
 
-    // ֤ǩ
-    uint8_t S[16] = { 0 };
-    ghash(ctx->H, aad, aad_len, in, len, S);
-    gctr(ctx->rk, ctx->J0, S, computed_tag, 16);
+    for (l = 0; l < nlanes; l++) {
+        x[l] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)lanes[l].X), bswap);
+    }
+    while (active) {
+        active = 0;
+        for (l = 0; l < nlanes; l++) {
+            k[l] = (lanes[l].left < 8) ? (int)lanes[l].left : 8;
+            lo[l] = mid[l] = hi[l] = _mm_setzero_si128();
+            active |= k[l];
+        }
+        for (i = 0; i < 8; i++) {
+            for (l = 0; l < nlanes; l++) {
+                if (i < k[l]) {
+                    __m128i c = _mm_shuffle_epi8(
+                        _mm_loadu_si128((const __m128i*)gcm_lane_next(&lanes[l])), bswap);
+                    if (i == 0) c = _mm_xor_si128(c, x[l]);
+                    gf128_clmul_acc(c,
+                        _mm_loadu_si128((const __m128i*)Hpow[k[l] - 1 - i]),
+                        &lo[l], &mid[l], &hi[l]);
+                }
+            }
+        }
+        for (l = 0; l < nlanes; l++) {
+            if (k[l]) x[l] = gf128_clmul_reduce(lo[l], mid[l], hi[l]);
+        }
+    }
+    for (l = 0; l < nlanes; l++) {
+        _mm_storeu_si128((__m128i*)lanes[l].X, _mm_shuffle_epi8(x[l], bswap));
+    }
+}
+
+static void ghash_lanes(const sm4_gcm_key* key, gcm_ghash_lane* lanes, int nlanes) {
+    if (key->ghash_impl == SM4_GHASH_CLMUL) {
+        ghash_lanes_clmul(key->Hpow, lanes, nlanes);
+        return;
+    }
+    for (int l = 0; l < nlanes; l++) {
+        while (lanes[l].left > 0) {
+            ghash_blocks(key, lanes[l].X, gcm_lane_next(&lanes[l]), 1);
+        }
+    }
+}
+
+// ӿһϢCTR
+typedef struct {
+    uint8_t J0[16];
+    uint8_t ctr[16];
+    uint8_t EJ0[16];        // SM4(J0), ɱǩ
+    uint8_t len_block[16];
+    size_t pos;
+    int j0_done;
+} gcm_batch_state;
+
+// һϢCTR: ܴһĲֱߵϢCTR, Ϣʣµ
+// ͷ J0 ͬһ, ں˿ٵһSM4
+static void gcm_batch_ctr(const sm4_gcm_key* key, sm4_gcm_msg* msgs,
+    gcm_batch_state* st, int cnt) {
+    uint8_t blocks[GCM_BATCH_BYTES];
+    uint8_t* dst[GCM_BATCH_BYTES / 16];
+    const uint8_t* src[GCM_BATCH_BYTES / 16];
+    size_t bytes[GCM_BATCH_BYTES / 16];
+    int m;
+
+    for (m = 0; m < cnt; m++) {
+        size_t bulk = msgs[m].len - msgs[m].len % GCM_BATCH_BYTES;
+        sm4_ctr32_xor(&key->sm4_key, st[m].ctr, msgs[m].in, msgs[m].out, bulk);
+        st[m].pos = bulk;
+    }
+
+    m = 0;
+    while (m < cnt) {
+        int nb = 0;
+        while (nb < GCM_BATCH_BYTES / 16 && m < cnt) {
+            gcm_batch_state* s = &st[m];
+            if (!s->j0_done) {
+                memcpy(blocks + 16 * nb, s->J0, 16);
+                dst[nb] = s->EJ0;
+                src[nb] = NULL;
+                bytes[nb] = 16;
+                s->j0_done = 1;
+                nb++;
+            }
+            else if (s->pos < msgs[m].len) {
+                size_t n = msgs[m].len - s->pos;
+                memcpy(blocks + 16 * nb, s->ctr, 16);
+                for (int j = 15; j >= 12; j--) {
+                    if (++s->ctr[j] != 0) break;
+                }
+                dst[nb] = msgs[m].out + s->pos;
+                src[nb] = msgs[m].in + s->pos;
+                bytes[nb] = (n < 16) ? n : 16;
+                s->pos += bytes[nb];
+                nb++;
+            }
+            else {
+                m++;
+            }
+        }
+        sm4_ecb_encrypt_blocks(&key->sm4_key, blocks, blocks, nb);
+        for (int i = 0; i < nb; i++) {
+            if (src[i] == NULL) {
+                memcpy(dst[i], blocks + 16 * i, 16);
+                continue;
+            }
+            if (bytes[i] == 16) {
+                __m128i d = _mm_loadu_si128((const __m128i*)src[i]);
+                __m128i k = _mm_loadu_si128((const __m128i*)(blocks + 16 * i));
+                _mm_storeu_si128((__m128i*)dst[i], _mm_xor_si128(d, k));
+                continue;
+            }
+            for (size_t j = 0; j < bytes[i]; j++) {
+                dst[i][j] = src[i][j] ^ blocks[16 * i + j];
+            }
+        }
+    }
+}
+
+static int gcm_batch_do(const sm4_gcm_key* key, sm4_gcm_msg* msgs, size_t n, int enc) {
+    gcm_batch_state st[GCM_BATCH_MSGS];
+    gcm_ghash_lane lanes[GCM_BATCH_MSGS];
+    int failed = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (msgs[i].len > GCM_MAX_DATA_BYTES) {
+            return -1;
+        }
+    }
+
+    for (size_t base = 0; base < n; base += GCM_BATCH_MSGS) {
+        sm4_gcm_msg* group = msgs + base;
+        int cnt = (n - base < GCM_BATCH_MSGS) ? (int)(n - base) : GCM_BATCH_MSGS;
+        int m;
+
+        for (m = 0; m < cnt; m++) {
+            gcm_batch_state* s = &st[m];
+            gcm_compute_j0(key, group[m].iv, group[m].iv_len, s->J0);
+            gcm_first_counter(s->J0, s->ctr);
+            store_be64((uint64_t)group[m].aad_len * 8, s->len_block);
+            store_be64((uint64_t)group[m].len * 8, s->len_block + 8);
+            s->j0_done = 0;
+        }
+
+        if (enc) {
+            // CTR, ĻL1ʱGHASH
+            gcm_batch_ctr(key, group, st, cnt);
+            for (m = 0; m < cnt; m++) {
+                gcm_lane_init(&lanes[m], group[m].aad, group[m].aad_len,
+                    group[m].out, group[m].len, st[m].len_block);
+            }
+            ghash_lanes(key, lanes, cnt);
+        }
+        else {
+            // ȶGHASH, ԭؽʱű
+            for (m = 0; m < cnt; m++) {
+                gcm_lane_init(&lanes[m], group[m].aad, group[m].aad_len,
+                    group[m].in, group[m].len, st[m].len_block);
+            }
+            ghash_lanes(key, lanes, cnt);
+            gcm_batch_ctr(key, group, st, cnt);
+        }
+
+        for (m = 0; m < cnt; m++) {
+            uint8_t diff = 0;
+            if (enc) {
+                for (int j = 0; j < 16; j++) {
+                    group[m].tag[j] = st[m].EJ0[j] ^ lanes[m].X[j];
+                }
+                continue;
+            }
+            for (int j = 0; j < 16; j++) {
+                diff |= group[m].tag[j] ^ st[m].EJ0[j] ^ lanes[m].X[j];
+            }
+            group[m].result = diff ? -1 : 0;
+            if (diff) {
+                memset(group[m].out, 0, group[m].len);
+                failed++;
+            }
+        }
+    }
+    return failed;
+}
+
+int sm4_gcm_encrypt_batch(const sm4_gcm_key* key, sm4_gcm_msg* msgs, size_t n) {
+    return gcm_batch_do(key, msgs, n, 1);
+}
+
+int sm4_gcm_decrypt_batch(const sm4_gcm_key* key, sm4_gcm_msg* msgs, size_t n) {
+    return gcm_batch_do(key, msgs, n, 0);
+}
+
+// GF(2^128)˷ out = a * b, PCLMULQDQʱ֮
+SM4_TARGET("pclmul,ssse3")
+static void gf128_mul_clmul(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    const __m128i bswap = GHASH_BSWAP_MASK;
+    __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+    gf128_clmul_acc(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)a), bswap),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)b), bswap), &lo, &mid, &hi);
+    _mm_storeu_si128((__m128i*)out,
+        _mm_shuffle_epi8(gf128_clmul_reduce(lo, mid, hi), bswap));
+}
+
+static void gf128_mul(const sm4_gcm_key* key, const uint8_t* a, const uint8_t* b,
+    uint8_t* out) {
+    if (key->ghash_impl == SM4_GHASH_CLMUL) {
+        gf128_mul_clmul(a, b, out);
+    }
+    else {
+        gf128_mult(a, b, out);
+    }
+}
+
+// out = H^n, ƽ-˷
+static void gf128_pow_h(const sm4_gcm_key* key, uint64_t n, uint8_t* out) {
+    uint8_t base[16];
+    memset(out, 0, 16);
+    out[0] = 0x80;          // GCMλµ 1
+    memcpy(base, key->H, 16);
+    while (n) {
+        if (n & 1) gf128_mul(key, out, base, out);
+        gf128_mul(key, base, base, base);
+        n >>= 1;
+    }
+}
+
+// һ̸߳һ, Ϊ16ı
+typedef struct {
+    const sm4_gcm_key* key;
+    uint8_t ctr[16];
+    const uint8_t* in;
+    uint8_t* out;
+    size_t len;
+    int enc;
+    uint8_t Y[16];          // εľֲGHASH, 0ʼۼ
+} gcm_mt_task;
+
+static void gcm_mt_run(gcm_mt_task* t) {
+    memset(t->Y, 0, 16);
+    gcm_crypt_stitched(t->key, t->ctr, t->Y, t->in, t->out, t->len, t->enc);
+}
+
+struct sm4_gcm_pool {
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::mutex run_mtx;     // лʹͬһ̳߳صĵ
+    std::condition_variable cv_task;
+    std::condition_variable cv_done;
+    gcm_mt_task* tasks;
+    int ntasks;
+    int next;
+    int pending;
+    bool stop;
+    size_t min_chunk;
+};
 
-    // ֤ǩ
-    if (memcmp(computed_tag, tag, 16) != 0) {
+static void gcm_pool_worker(sm4_gcm_pool* pool) {
+    std::unique_lock<std::mutex> lk(pool->mtx);
+    for (;;) {
+        pool->cv_task.wait(lk, [pool] { return pool->stop || pool->next < pool->ntasks; });
+        if (pool->stop) {
+            return;
+        }
+        gcm_mt_task* t = &pool->tasks[pool->next++];
+        lk.unlock();
+        gcm_mt_run(t);
+        lk.lock();
+        if (--pool->pending == 0) {
+            pool->cv_done.notify_all();
+        }
+    }
+}
+
+// ַ񲢵ȴȫ, ߳Ҳ
+static void gcm_pool_run(sm4_gcm_pool* pool, gcm_mt_task* tasks, int n) {
+    std::unique_lock<std::mutex> lk(pool->mtx);
+    pool->tasks = tasks;
+    pool->ntasks = n;
+    pool->next = 0;
+    pool->pending = n;
+    pool->cv_task.notify_all();
+    while (pool->next < pool->ntasks) {
+        gcm_mt_task* t = &pool->tasks[pool->next++];
+        lk.unlock();
+        gcm_mt_run(t);
+        lk.lock();
+        pool->pending--;
+    }
+    pool->cv_done.wait(lk, [pool] { return pool->pending == 0; });
+    pool->ntasks = 0;
+}
+
+sm4_gcm_pool* sm4_gcm_pool_create(int nthreads) {
+    sm4_gcm_pool* pool = new sm4_gcm_pool;
+    if (nthreads <= 0) {
+        nthreads = (int)std::thread::hardware_concurrency();
+        if (nthreads <= 0) nthreads = 1;
+    }
+    pool->tasks = NULL;
+    pool->ntasks = 0;
+    pool->next = 0;
+    pool->pending = 0;
+    pool->stop = false;
+    pool->min_chunk = SM4_GCM_MT_MIN_CHUNK;
+    for (int i = 1; i < nthreads; i++) {
+        pool->workers.push_back(std::thread(gcm_pool_worker, pool));
+    }
+    return pool;
+}
+
+void sm4_gcm_pool_destroy(sm4_gcm_pool* pool) {
+    {
+        std::lock_guard<std::mutex> lk(pool->mtx);
+        pool->stop = true;
+    }
+    pool->cv_task.notify_all();
+    for (size_t i = 0; i < pool->workers.size(); i++) {
+        pool->workers[i].join();
+    }
+    delete pool;
+}
+
+void sm4_gcm_pool_set_min_chunk(sm4_gcm_pool* pool, size_t bytes) {
+    // ֶα߽뵽һ, GHASHܸζ
+    if (bytes < GCM_BATCH_BYTES) bytes = GCM_BATCH_BYTES;
+    pool->min_chunk = bytes;
+}
+
+// 32λ n (ģ 2^32)
+static void gcm_ctr_add(uint8_t* ctr, uint32_t n) {
+    uint32_t c = ((uint32_t)ctr[12] << 24) | ((uint32_t)ctr[13] << 16) |
+        ((uint32_t)ctr[14] << 8) | ctr[15];
+    c += n;
+    ctr[12] = (uint8_t)(c >> 24);
+    ctr[13] = (uint8_t)(c >> 16);
+    ctr[14] = (uint8_t)(c >> 8);
+    ctr[15] = (uint8_t)c;
+}
+
+// 鲿ַָ̳߳, ϲ X = (...((X_aad * H^n1) ^ Y1) * H^n2 ^ Y2 ...),
+// ĩβһֽڽʽӿ
+static int gcm_crypt_mt(sm4_gcm_pool* pool, sm4_gcm_ctx* ctx, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, int enc) {
+    const sm4_gcm_key* key = ctx->key;
+    size_t nthreads = pool->workers.size() + 1;
+    size_t bulk = len & ~(size_t)15;
+    size_t nchunks = bulk / pool->min_chunk;
+    size_t chunk;
+    uint8_t Hn[16], Hlast[16];
+
+    gcm_stream_reset(ctx);
+    sm4_gcm_update_aad(ctx, aad, aad_len);
+    if (nchunks > nthreads) nchunks = nthreads;
+    if (nchunks < 2 || len > GCM_MAX_DATA_BYTES) {
+        return gcm_stream_update(ctx, out, in, len, enc);
+    }
+
+    // ÿγȡС, һβ
+    chunk = (bulk / nchunks + GCM_BATCH_BYTES - 1) & ~(size_t)(GCM_BATCH_BYTES - 1);
+    nchunks = (bulk + chunk - 1) / chunk;
+    std::vector<gcm_mt_task> tasks(nchunks);
+    for (size_t j = 0; j < nchunks; j++) {
+        gcm_mt_task* t = &tasks[j];
+        size_t off = j * chunk;
+        t->key = key;
+        memcpy(t->ctr, ctx->ctr, 16);
+        gcm_ctr_add(t->ctr, (uint32_t)(off / 16));
+        t->in = in + off;
+        t->out = out + off;
+        t->len = (bulk - off < chunk) ? bulk - off : chunk;
+        t->enc = enc;
+    }
+
+    {
+        std::lock_guard<std::mutex> run_lk(pool->run_mtx);
+        gcm_pool_run(pool, &tasks[0], (int)nchunks);
+    }
+
+    // AADβ󰴶˳ϲֲGHASH
+    gcm_flush_partial(ctx, ctx->aad_len % 16);
+    ctx->stage = enc ? SM4_GCM_STAGE_ENCRYPT : SM4_GCM_STAGE_DECRYPT;
+    gf128_pow_h(key, chunk / 16, Hn);
+    gf128_pow_h(key, tasks[nchunks - 1].len / 16, Hlast);
+    for (size_t j = 0; j < nchunks; j++) {
+        gf128_mul(key, ctx->X, (j + 1 < nchunks) ? Hn : Hlast, ctx->X);
+        for (int i = 0; i < 16; i++) {
+            ctx->X[i] ^= tasks[j].Y[i];
+        }
+    }
+    gcm_ctr_add(ctx->ctr, (uint32_t)(bulk / 16));
+    ctx->cipher_len = bulk;
+
+    return gcm_stream_update(ctx, out + bulk, in + bulk, len - bulk, enc);
+}
+
+int sm4_gcm_encrypt_mt(sm4_gcm_pool* pool, sm4_gcm_ctx* ctx, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, uint8_t* tag) {
+    if (gcm_crypt_mt(pool, ctx, out, in, len, aad, aad_len, 1) != 0) {
         return -1;
     }
+    return sm4_gcm_encrypt_final(ctx, tag);
+}
 
-    // 
-    memcpy(ICB, ctx->J0, 16);
-    ICB[15] = 1;
-    gctr(ctx->rk, ICB, in, out, len);
+int sm4_gcm_decrypt_mt(sm4_gcm_pool* pool, sm4_gcm_ctx* ctx, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, const uint8_t* tag) {
+    if (gcm_crypt_mt(pool, ctx, out, in, len, aad, aad_len, 0) != 0 ||
+        sm4_gcm_decrypt_final(ctx, tag) != 0) {
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
+
+// Կصһ: [SM4(J0) | SM4(J0+1) | ... ]  stride ֽ. ,
+// һֻһ sm4_ecb_encrypt_blocks
+struct sm4_gcm_ks_pool {
+    const sm4_gcm_key* key;
+    uint8_t iv_base[12];
+    size_t depth;
+    size_t max_len;                     // ÿԿֽ, 16ı
+    size_t stride;                      // 16 + max_len
+    std::vector<uint8_t> ks;            // depth * stride
+    std::vector<uint64_t> seqs;         // ÿӦ
+    uint64_t fill_seq;                  // ߳: һҪɵ
+    std::atomic<uint64_t> next_seq;     // ʹ߳: һϢ
+    std::atomic<size_t> head;           // ѵ
+    std::atomic<size_t> tail;           // ɵ
+    std::atomic<uint64_t> hits, misses, partial, dropped, generated;
+};
 
+// nonce = iv_base ^ (0^32 || [seq]64)
+static void gcm_ks_nonce(const uint8_t* iv_base, uint64_t seq, uint8_t* iv) {
+    memcpy(iv, iv_base, 12);
+    for (int i = 0; i < 8; i++) {
+        iv[4 + i] ^= (uint8_t)(seq >> (56 - 8 * i));
+    }
+}
+
+sm4_gcm_ks_pool* sm4_gcm_ks_create(const sm4_gcm_key* key, const uint8_t* iv_base,
+    uint64_t first_seq, size_t depth, size_t max_len) {
+    sm4_gcm_ks_pool* pool = new sm4_gcm_ks_pool;
+    if (depth == 0) depth = 1;
+    pool->key = key;
+    memcpy(pool->iv_base, iv_base, 12);
+    pool->depth = depth;
+    pool->max_len = (max_len + 15) & ~(size_t)15;
+    pool->stride = 16 + pool->max_len;
+    pool->ks.resize(depth * pool->stride);
+    pool->seqs.resize(depth);
+    pool->fill_seq = first_seq;
+    pool->next_seq.store(first_seq);
+    pool->head.store(0);
+    pool->tail.store(0);
+    pool->hits.store(0);
+    pool->misses.store(0);
+    pool->partial.store(0);
+    pool->dropped.store(0);
+    pool->generated.store(0);
+    return pool;
+}
+
+void sm4_gcm_ks_destroy(sm4_gcm_ks_pool* pool) {
+    delete pool;
+}
+
+size_t sm4_gcm_ks_fill(sm4_gcm_ks_pool* pool, size_t max_entries) {
+    size_t head = pool->head.load(std::memory_order_acquire);
+    size_t tail = pool->tail.load(std::memory_order_relaxed);
+    size_t room = pool->depth - (tail - head);
+    size_t done = 0;
+    if (max_entries == 0 || max_entries > room) {
+        max_entries = room;
+    }
+    // ʹ÷δԽŲ
+    uint64_t next = pool->next_seq.load(std::memory_order_acquire);
+    if (pool->fill_seq < next) {
+        pool->fill_seq = next;
+    }
+    while (done < max_entries) {
+        size_t slot = (tail + done) % pool->depth;
+        size_t run = max_entries - done;
+        if (run > pool->depth - slot) {
+            run = pool->depth - slot;   // 绷β, ֤
+        }
+        uint8_t* p = &pool->ks[slot * pool->stride];
+        for (size_t k = 0; k < run; k++) {
+            uint8_t ctr[16];
+            gcm_ks_nonce(pool->iv_base, pool->fill_seq, ctr);
+            ctr[12] = 0;
+            ctr[13] = 0;
+            ctr[14] = 0;
+            ctr[15] = 1;
+            for (size_t b = 0; b < pool->stride; b += 16) {
+                memcpy(p + k * pool->stride + b, ctr, 16);
+                gcm_ctr_add(ctr, 1);
+            }
+            pool->seqs[slot + k] = pool->fill_seq++;
+        }
+        sm4_ecb_encrypt_blocks(&pool->key->sm4_key, p, p, run * pool->stride / 16);
+        done += run;
+    }
+    pool->tail.store(tail + done, std::memory_order_release);
+    pool->generated.fetch_add(done, std::memory_order_relaxed);
+    return done;
+}
+
+//  seq Ŀ, ;жŸСĹĿ; ûʱ-1.
+// ҵĿʹ֮ǰ, ̲߳Ḳ
+static long gcm_ks_find(sm4_gcm_ks_pool* pool, uint64_t seq) {
+    size_t head = pool->head.load(std::memory_order_relaxed);
+    size_t tail = pool->tail.load(std::memory_order_acquire);
+    while (head != tail) {
+        size_t slot = head % pool->depth;
+        if (pool->seqs[slot] == seq) {
+            return (long)slot;
+        }
+        if (pool->seqs[slot] > seq) {
+            break;
+        }
+        head++;
+        pool->head.store(head, std::memory_order_release);
+        pool->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return -1;
+}
+
+// ʱ: ԤɵԿGHASH,  max_len ĲִӦ;
+// δʱͨӿ. GHASH, ֧ in == out
+static int gcm_ks_crypt(sm4_gcm_ks_pool* pool, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, uint8_t* tag_out, const uint8_t* tag_in,
+    uint64_t* seq_out, int enc) {
+    const sm4_gcm_key* key = pool->key;
+    uint8_t iv[12];
+    int ret = 0;
+
+    if (len > GCM_MAX_DATA_BYTES) {
+        return -1;
+    }
+    uint64_t seq = pool->next_seq.load(std::memory_order_relaxed);
+    long slot = gcm_ks_find(pool, seq);
+    gcm_ks_nonce(pool->iv_base, seq, iv);
+    if (slot < 0) {
+        sm4_gcm_ctx ctx;
+        pool->misses.fetch_add(1, std::memory_order_relaxed);
+        sm4_gcm_init(&ctx, key, iv, 12);
+        ret = enc ? sm4_gcm_encrypt(&ctx, out, in, len, aad, aad_len, tag_out) :
+            sm4_gcm_decrypt(&ctx, out, in, len, aad, aad_len, tag_in);
+    }
+    else {
+        const uint8_t* ks = &pool->ks[slot * pool->stride];
+        size_t pre = (len < pool->max_len) ? len : pool->max_len;
+        uint8_t X[16] = { 0 };
+        uint8_t ct[GCM_BATCH_BYTES];
+        uint8_t S[16];
+
+        pool->hits.fetch_add(1, std::memory_order_relaxed);
+        ghash_update(key, X, aad, aad_len);
+        for (size_t off = 0; off < pre; off += GCM_BATCH_BYTES) {
+            size_t n = (pre - off < GCM_BATCH_BYTES) ? pre - off : GCM_BATCH_BYTES;
+            gcm_iov_xor(in + off, out + off, ks + 16 + off, ct, n, enc);
+            ghash_update(key, X, ct, n);
+        }
+        if (len > pre) {
+            uint8_t ctr[16];
+            pool->partial.fetch_add(1, std::memory_order_relaxed);
+            memcpy(ctr, iv, 12);
+            ctr[12] = 0;
+            ctr[13] = 0;
+            ctr[14] = 0;
+            ctr[15] = 1;
+            gcm_ctr_add(ctr, (uint32_t)(1 + pool->max_len / 16));
+            gcm_crypt_stitched(key, ctr, X, in + pre, out + pre, len - pre, enc);
+        }
+        ghash_final(key, X, aad_len, len);
+        for (int i = 0; i < 16; i++) {
+            S[i] = X[i] ^ ks[i];
+        }
+        pool->head.store(pool->head.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release);
+        if (enc) {
+            memcpy(tag_out, S, 16);
+        }
+        else if (!gcm_tag_equal(S, tag_in)) {
+            memset(out, 0, len);
+            ret = -1;
+        }
+    }
+    pool->next_seq.store(seq + 1, std::memory_order_release);
+    if (seq_out != NULL) {
+        *seq_out = seq;
+    }
+    return ret;
+}
+
+int sm4_gcm_ks_encrypt(sm4_gcm_ks_pool* pool, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, uint8_t* tag, uint64_t* seq) {
+    return gcm_ks_crypt(pool, out, in, len, aad, aad_len, tag, NULL, seq, 1);
+}
+
+int sm4_gcm_ks_decrypt(sm4_gcm_ks_pool* pool, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* tag, uint64_t* seq) {
+    return gcm_ks_crypt(pool, out, in, len, aad, aad_len, NULL, tag, seq, 0);
+}
+
+void sm4_gcm_ks_get_stats(const sm4_gcm_ks_pool* pool, sm4_gcm_ks_stats* stats) {
+    size_t head = pool->head.load(std::memory_order_acquire);
+    size_t tail = pool->tail.load(std::memory_order_acquire);
+    stats->hits = pool->hits.load();
+    stats->misses = pool->misses.load();
+    stats->partial = pool->partial.load();
+    stats->dropped = pool->dropped.load();
+    stats->generated = pool->generated.load();
+    stats->ready = (tail > head) ? tail - head : 0;
+}
+
+// SM4-GCM-SIV: RFC 8452 Ľṹ, 뻻ΪSM4. POLYVAL  GHASH ͬһ,
+// С˱ʾ, ˷Ϊ dot(a, b) = a * b * x^-128 mod x^128 + x^127 + x^126 + x^121 + 1
+#define GCM_SIV_MAX_BYTES (1ULL << 36)
+
+typedef struct {
+    int clmul;
+    uint8_t S[16];                      // CLMUL: ۼֵ; : ֽڷۼֵ
+    uint8_t Hpow[8][16];                // CLMUL: H, dot(H, H), ... 8ۺ
+    uint64_t HL[SM4_GCM_TABLE_SIZE];    // : mulX_GHASH(ByteReverse(H)) Shoup
+    uint64_t HH[SM4_GCM_TABLE_SIZE];
+} gcm_polyval;
+
+//  Montgomery Լ, ÿȥ64λ, ൱ڳ x^-128
+SM4_TARGET("pclmul")
+static inline __m128i polyval_clmul_reduce(__m128i lo, __m128i mid, __m128i hi) {
+    const __m128i poly = _mm_setr_epi32(1, 0, 0, (int)0xc2000000);
+    __m128i t;
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+    t = _mm_clmulepi64_si128(lo, poly, 0x10);
+    lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), t);
+    t = _mm_clmulepi64_si128(lo, poly, 0x10);
+    lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), t);
+    return _mm_xor_si128(hi, lo);
+}
+
+SM4_TARGET("pclmul")
+static void polyval_clmul_powers(const uint8_t* H, uint8_t Hpow[8][16]) {
+    __m128i h = _mm_loadu_si128((const __m128i*)H);
+    __m128i p = h;
+    _mm_storeu_si128((__m128i*)Hpow[0], h);
+    for (int i = 1; i < 8; i++) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        gf128_clmul_acc(p, h, &lo, &mid, &hi);
+        p = polyval_clmul_reduce(lo, mid, hi);
+        _mm_storeu_si128((__m128i*)Hpow[i], p);
+    }
+}
+
+//  ghash_blocks_clmul ͬ8ۺ, Ҫֽڷ
+SM4_TARGET("pclmul")
+static void polyval_blocks_clmul(const uint8_t Hpow[8][16], uint8_t* S,
+    const uint8_t* data, size_t nblocks) {
+    __m128i x = _mm_loadu_si128((const __m128i*)S);
+    while (nblocks > 0) {
+        int n = (nblocks < 8) ? (int)nblocks : 8;
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        for (int i = 0; i < n; i++) {
+            __m128i c = _mm_loadu_si128((const __m128i*)(data + 16 * i));
+            if (i == 0) c = _mm_xor_si128(c, x);
+            gf128_clmul_acc(c, _mm_loadu_si128((const __m128i*)Hpow[n - 1 - i]),
+                &lo, &mid, &hi);
+        }
+        x = polyval_clmul_reduce(lo, mid, hi);
+        data += 16 * n;
+        nblocks -= n;
+    }
+    _mm_storeu_si128((__m128i*)S, x);
+}
+
+// PCLMULQDQʱ RFC 8452 ¼A תGHASH:
+// POLYVAL(H, X_1..X_n) = ByteReverse(GHASH(mulX_GHASH(ByteReverse(H)), ByteReverse(X_1)..))
+static void polyval_init(gcm_polyval* pv, const uint8_t* H, int clmul) {
+    pv->clmul = clmul;
+    memset(pv->S, 0, 16);
+    if (clmul) {
+        polyval_clmul_powers(H, pv->Hpow);
+        return;
+    }
+    uint8_t Hg[16];
+    for (int i = 0; i < 16; i++) {
+        Hg[i] = H[15 - i];
+    }
+    // mulX_GHASH: 1λ, ƳλΪ1ʱԼʽ
+    int carry = Hg[15] & 1;
+    for (int i = 15; i > 0; i--) {
+        Hg[i] = (uint8_t)((Hg[i] >> 1) | (Hg[i - 1] << 7));
+    }
+    Hg[0] >>= 1;
+    if (carry) {
+        Hg[0] ^= 0xe1;
+    }
+    gf128_table_init(Hg, pv->HL, pv->HH);
+}
+
+static void polyval_blocks(gcm_polyval* pv, const uint8_t* data, size_t nblocks) {
+    if (pv->clmul) {
+        polyval_blocks_clmul(pv->Hpow, pv->S, data, nblocks);
+        return;
+    }
+    for (size_t b = 0; b < nblocks; b++) {
+        for (int i = 0; i < 16; i++) {
+            pv->S[i] ^= data[16 * b + 15 - i];
+        }
+        gf128_mult_table(pv->HL, pv->HH, pv->S);
+    }
+}
+
+// ⳤ, ĩβһʱ
+static void polyval_update(gcm_polyval* pv, const uint8_t* data, size_t len) {
+    size_t nblocks = len / 16;
+    uint8_t temp[16];
+    polyval_blocks(pv, data, nblocks);
+    if (len % 16) {
+        memset(temp, 0, 16);
+        memcpy(temp, data + nblocks * 16, len % 16);
+        polyval_blocks(pv, temp, 1);
+    }
+}
+
+// ȿΪС [len(A)]64 || [len(P)]64 (λ), С˱ʾĽ
+static void polyval_final(gcm_polyval* pv, uint64_t aad_len, uint64_t len, uint8_t* out) {
+    uint8_t len_block[16];
+    for (int i = 0; i < 8; i++) {
+        len_block[i] = (uint8_t)((aad_len * 8) >> (8 * i));
+        len_block[i + 8] = (uint8_t)((len * 8) >> (8 * i));
+    }
+    polyval_blocks(pv, len_block, 1);
+    for (int i = 0; i < 16; i++) {
+        out[i] = pv->clmul ? pv->S[i] : pv->S[15 - i];
+    }
+}
+
+int sm4_polyval(const uint8_t* H, const uint8_t* data, size_t len, int impl, uint8_t* out) {
+    gcm_polyval pv;
+
+    if (impl == SM4_GHASH_CLMUL ? !(SM4_CpuFeatures() & SM4_CPU_PCLMUL) :
+        impl != SM4_GHASH_TABLE) {
+        return -1;
+    }
+    polyval_init(&pv, H, impl == SM4_GHASH_CLMUL);
+    polyval_update(&pv, data, len);
+    for (int i = 0; i < 16; i++) {
+        out[i] = pv.clmul ? pv.S[i] : pv.S[15 - i];
+    }
+    return 0;
+}
+
+// nonce: 4 [i]32(С) || nonce һSM4ں˵, ȡǰ8ֽ,
+// ǰƴPOLYVALԿ, ƴɱϢSM4Կ
+static void gcm_siv_derive(const sm4_gcm_key* key, const uint8_t* nonce,
+    uint8_t* auth_key, SM4_Key* enc_key) {
+    uint8_t blocks[64];
+    uint8_t ek[16];
+    for (int i = 0; i < 4; i++) {
+        blocks[16 * i] = (uint8_t)i;
+        blocks[16 * i + 1] = 0;
+        blocks[16 * i + 2] = 0;
+        blocks[16 * i + 3] = 0;
+        memcpy(blocks + 16 * i + 4, nonce, 12);
+    }
+    sm4_ecb_encrypt_blocks(&key->sm4_key, blocks, blocks, 4);
+    memcpy(auth_key, blocks, 8);
+    memcpy(auth_key + 8, blocks + 16, 8);
+    memcpy(ek, blocks + 32, 8);
+    memcpy(ek + 8, blocks + 48, 8);
+    SM4_KeyInit(ek, enc_key);
+}
+
+// ǩ = SM4(enc_key, (S ^ nonce) λ), S Ϊ POLYVAL 
+static void gcm_siv_tag(gcm_polyval* pv, const SM4_Key* enc_key, const uint8_t* nonce,
+    uint64_t aad_len, uint64_t len, uint8_t* tag) {
+    uint8_t S[16];
+    polyval_final(pv, aad_len, len, S);
+    for (int i = 0; i < 12; i++) {
+        S[i] ^= nonce[i];
+    }
+    S[15] &= 0x7f;
+    sm4_ecb_encrypt_blocks(enc_key, S, tag, 1);
+}
+
+// ȡǩλ, ǰ4ֽڰС32λ. ÿ GCM_BATCH_BYTES һSM4;
+// pv ǿʱͬʱ(ʱ)POLYVAL, ֧ in == out
+static void gcm_siv_ctr(const SM4_Key* enc_key, const uint8_t* tag, const uint8_t* in,
+    uint8_t* out, size_t len, gcm_polyval* pv) {
+    uint8_t ks[GCM_BATCH_BYTES];
+    uint8_t pt[GCM_BATCH_BYTES];
+    uint8_t ctr[16];
+    memcpy(ctr, tag, 16);
+    ctr[15] |= 0x80;
+    uint32_t c = (uint32_t)ctr[0] | ((uint32_t)ctr[1] << 8) | ((uint32_t)ctr[2] << 16) |
+        ((uint32_t)ctr[3] << 24);
+
+    while (len > 0) {
+        size_t n = (len < GCM_BATCH_BYTES) ? len : GCM_BATCH_BYTES;
+        size_t nb = (n + 15) / 16;
+        for (size_t b = 0; b < nb; b++, c++) {
+            ctr[0] = (uint8_t)c;
+            ctr[1] = (uint8_t)(c >> 8);
+            ctr[2] = (uint8_t)(c >> 16);
+            ctr[3] = (uint8_t)(c >> 24);
+            memcpy(ks + 16 * b, ctr, 16);
+        }
+        sm4_ecb_encrypt_blocks(enc_key, ks, ks, (int)nb);
+        gcm_iov_xor(in, out, ks, pt, n, 1);
+        if (pv != NULL) {
+            polyval_update(pv, pt, n);
+        }
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+int sm4_gcm_siv_encrypt(const sm4_gcm_key* key, const uint8_t* nonce, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, uint8_t* tag) {
+    uint8_t auth_key[16];
+    SM4_Key enc_key;
+    gcm_polyval pv;
+
+    if (len > GCM_SIV_MAX_BYTES || aad_len > GCM_SIV_MAX_BYTES) {
+        return -1;
+    }
+    gcm_siv_derive(key, nonce, auth_key, &enc_key);
+    polyval_init(&pv, auth_key, key->ghash_impl == SM4_GHASH_CLMUL);
+    polyval_update(&pv, aad, aad_len);
+    polyval_update(&pv, in, len);
+    gcm_siv_tag(&pv, &enc_key, nonce, aad_len, len, tag);
+    gcm_siv_ctr(&enc_key, tag, in, out, len, NULL);
     return 0;
-}
\ No newline at end of file
+}
+
+int sm4_gcm_siv_decrypt(const sm4_gcm_key* key, const uint8_t* nonce, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, const uint8_t* tag) {
+    uint8_t auth_key[16];
+    uint8_t computed_tag[16];
+    SM4_Key enc_key;
+    gcm_polyval pv;
+
+    if (len > GCM_SIV_MAX_BYTES || aad_len > GCM_SIV_MAX_BYTES) {
+        return -1;
+    }
+    gcm_siv_derive(key, nonce, auth_key, &enc_key);
+    polyval_init(&pv, auth_key, key->ghash_impl == SM4_GHASH_CLMUL);
+    polyval_update(&pv, aad, aad_len);
+    gcm_siv_ctr(&enc_key, tag, in, out, len, &pv);
+    gcm_siv_tag(&pv, &enc_key, nonce, aad_len, len, computed_tag);
+    if (!gcm_tag_equal(computed_tag, tag)) {
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
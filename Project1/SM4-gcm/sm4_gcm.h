@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include "../SM4-aesni/sm4_aesni.h"
 
 #define SM4_BLOCK_SIZE 16
 #define SM4_KEY_SIZE 16
@@ -12,18 +13,180 @@
 // ѭƺ
 #define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
 
+// PCLMULQDQʱGHASHʹõShoup: 4 (256ֽ)  8 (4KB)
+#ifndef SM4_GCM_TABLE_BITS
+#define SM4_GCM_TABLE_BITS 4
+#endif
+#define SM4_GCM_TABLE_SIZE (1 << SM4_GCM_TABLE_BITS)
+
+// GHASHʵ
+#define SM4_GHASH_BITWISE 0     // λ˷, οʵ
+#define SM4_GHASH_TABLE   1     // Shoup
+#define SM4_GHASH_CLMUL   2     // PCLMULQDQ
+
+// ԿԤ, úֻ, ɱ߳/Ϣ
 typedef struct {
-    uint32_t rk[32];        // SM4Կ
+    SM4_Key sm4_key;        // SM4Կ
     uint8_t H[16];          // GHASHʹõHֵ
+    uint8_t Hpow[8][16];    // H^1..H^8, ֽڷPCLMULQDQʹ
+    uint64_t HL[SM4_GCM_TABLE_SIZE];    // Shoup i*H ĵ64λ
+    uint64_t HH[SM4_GCM_TABLE_SIZE];    // Shoup i*H ĸ64λ
+    int ghash_impl;         // SM4_GHASH_*
+} sm4_gcm_key;
+
+// Ϣ״̬, ÿIVһ
+typedef struct {
+    const sm4_gcm_key* key; // Կ, Ϣ֮ǰЧ
     uint8_t J0[16];         // ʼֵ
     uint64_t aad_len;       // AAD(ֽ)
     uint64_t cipher_len;    // ĳ(ֽ)
+    uint8_t X[16];          // ʽӿ: GHASHۼֵ
+    uint8_t ctr[16];        // ʽӿ: һδʹõļ
+    uint8_t buf[16];        // ʽӿ: δһAAD
+    uint8_t ks[16];         // ʽӿ: δӦԿ
+    int stage;              // ʽӿ: SM4_GCM_STAGE_*
 } sm4_gcm_ctx;
 
-void sm4_gcm_init(sm4_gcm_ctx* ctx, const uint8_t* key, const uint8_t* iv, size_t iv_len);
+// ʽӿ׶
+#define SM4_GCM_STAGE_AAD     0 // ɼAAD
+#define SM4_GCM_STAGE_ENCRYPT 1 // ѿʼ
+#define SM4_GCM_STAGE_DECRYPT 2 // ѿʼ
+#define SM4_GCM_STAGE_DONE    3 // /Уǩ, init
+
+// ÿԿһ: ԿHGHASHԤ
+void sm4_gcm_key_init(sm4_gcm_key* key, const uint8_t* user_key);
+// ÿϢһ: ֻJ0, Կչ
+void sm4_gcm_init(sm4_gcm_ctx* ctx, const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len);
 int sm4_gcm_encrypt(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len,
     const uint8_t* aad, size_t aad_len, uint8_t* tag);
 int sm4_gcm_decrypt(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len,
     const uint8_t* aad, size_t aad_len, const uint8_t* tag);
 
+// ʽӿ: sm4_gcm_init ֶ֮AAD, ֶ,
+// Уǩ. ֻ治һ, ⸴.
+// ׶˳ݳGCM(2^36-32ֽ)ʱ-1
+int sm4_gcm_update_aad(sm4_gcm_ctx* ctx, const uint8_t* aad, size_t len);
+int sm4_gcm_encrypt_update(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len);
+int sm4_gcm_decrypt_update(sm4_gcm_ctx* ctx, uint8_t* out, const uint8_t* in, size_t len);
+int sm4_gcm_encrypt_final(sm4_gcm_ctx* ctx, uint8_t* tag);
+// ǩ-1. ʽܵУǰ, ÷ڳɹʹ
+int sm4_gcm_decrypt_final(sm4_gcm_ctx* ctx, const uint8_t* tag);
+
+// GMAC: ֻ֤, ΪյGCM, ǩ = SM4(J0) ^ GHASH(H, data || ȿ).
+// ֱӶGHASH, ĺʽ״̬; ͬһԿIVظ. Ϣ
+// len Ϊ0 sm4_gcm_encrypt_batch,  SM4(J0) ϲͬһں˵
+int sm4_gmac(const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len,
+    const uint8_t* data, size_t len, uint8_t* tag);
+// ǩ-1
+int sm4_gmac_verify(const sm4_gcm_key* key, const uint8_t* iv, size_t iv_len,
+    const uint8_t* data, size_t len, const uint8_t* tag);
+
+// ɢ/ۼһ,  POSIX struct iovec ͬ
+typedef struct {
+    void* base;
+    size_t len;
+} sm4_gcm_iovec;
+
+// ɢ/ۼӿ: ֱӰαԴĿ, εķ龭ʽ״̬ν,
+// ҪȰѱԻ. ԴĿĵķֶηʽԲͬ, Ҳͬһ(ԭ);
+// Ŀܳ벻СԴܳ, 򷵻-1. AADͬԷֶθ(Ϊ0)
+int sm4_gcm_encrypt_iov(sm4_gcm_ctx* ctx, const sm4_gcm_iovec* dst, size_t dst_cnt,
+    const sm4_gcm_iovec* src, size_t src_cnt, const sm4_gcm_iovec* aad, size_t aad_cnt,
+    uint8_t* tag);
+// ֤ʧʱĿдݲ-1
+int sm4_gcm_decrypt_iov(sm4_gcm_ctx* ctx, const sm4_gcm_iovec* dst, size_t dst_cnt,
+    const sm4_gcm_iovec* src, size_t src_cnt, const sm4_gcm_iovec* aad, size_t aad_cnt,
+    const uint8_t* tag);
+
+// еһϢ, ϢIV/AAD/Ȼ
+typedef struct {
+    const uint8_t* iv;
+    size_t iv_len;
+    const uint8_t* aad;
+    size_t aad_len;
+    const uint8_t* in;
+    uint8_t* out;           //  in ͬ
+    size_t len;
+    uint8_t* tag;           // ʱ, ʱΪУ SM4_GCM_TAG_SIZE ֽڱǩ
+    int result;             // : 0 ɹ, -1 ֤ʧ ()
+} sm4_gcm_msg;
+
+// ܶϢ: ϢļƴͬһSM4ں˵,
+// GHASH·.  sm4_gcm_encrypt ͬ.
+// ϢGCMʱκδ, -1
+int sm4_gcm_encrypt_batch(const sm4_gcm_key* key, sm4_gcm_msg* msgs, size_t n);
+// : ȶԸϢ·GHASHٽ, ֧ in == out. ϢĽ
+// д result, ֤ʧܵϢ; ϢGCMʱκδ, -1
+int sm4_gcm_decrypt_batch(const sm4_gcm_key* key, sm4_gcm_msg* msgs, size_t n);
+
+// ߳GCM: ݰи̳߳, ̶߳CTR;ֲGHASH,
+// ֲͳӦHݺϲ, 뵥߳ȫͬ
+typedef struct sm4_gcm_pool sm4_gcm_pool;
+
+// ÿ߳ٷֵֽ, ʱö߳
+#define SM4_GCM_MT_MIN_CHUNK (1 << 20)
+
+// nthreads Ϊ߳(߳), <=0 ʱȡCPU
+sm4_gcm_pool* sm4_gcm_pool_create(int nthreads);
+void sm4_gcm_pool_destroy(sm4_gcm_pool* pool);
+void sm4_gcm_pool_set_min_chunk(sm4_gcm_pool* pool, size_t bytes);
+//  sm4_gcm_encrypt/decrypt ͬ; ͬһ̳߳صĲûִ
+int sm4_gcm_encrypt_mt(sm4_gcm_pool* pool, sm4_gcm_ctx* ctx, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, uint8_t* tag);
+int sm4_gcm_decrypt_mt(sm4_gcm_pool* pool, sm4_gcm_ctx* ctx, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, const uint8_t* tag);
+
+// ԿԤɳ: ÿ(ÿ)һ. CTRԿֻȡԿnonce, 
+// ޹, ˿ڿʱɺ̨߳ԤΪ SM4(J0) Կ,
+// /ʱֻʣGHASH.  seq Ϣ nonce = iv_base ^ (0^32 || [seq]64),
+//  TLS 1.3 ͬ, ÿܻһϢżһ.
+//  (sm4_gcm_ks_fill) ʹ (encrypt/decrypt) ֻһ߳, ߿Բ
+typedef struct sm4_gcm_ks_pool sm4_gcm_ks_pool;
+
+typedef struct {
+    uint64_t hits;          // ԿѾ, ֻGHASH
+    uint64_t misses;        // δ, ڵ·
+    uint64_t partial;       // еĳ max_len, 
+    uint64_t dropped;       // Ԥɵѱ (֮ǰδ) Ŀ
+    uint64_t generated;     // ۼԤɵĿ
+    size_t ready;           // ǰĿ
+} sm4_gcm_ks_stats;
+
+// depth ΪԤɵϢ, max_len ΪÿϢԤɵԿֽ
+// (ȡ16ı). ֻԿָ, key ڳǰЧ
+sm4_gcm_ks_pool* sm4_gcm_ks_create(const sm4_gcm_key* key, const uint8_t* iv_base,
+    uint64_t first_seq, size_t depth, size_t max_len);
+void sm4_gcm_ks_destroy(sm4_gcm_ks_pool* pool);
+//  max_entries (0 ʾ), رɵ; һ𽻸SM4ں
+size_t sm4_gcm_ks_fill(sm4_gcm_ks_pool* pool, size_t max_entries);
+// һŴһϢ, seq ǿʱ. ֤ʧʱ-1,
+// Ȼ
+int sm4_gcm_ks_encrypt(sm4_gcm_ks_pool* pool, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, uint8_t* tag, uint64_t* seq);
+int sm4_gcm_ks_decrypt(sm4_gcm_ks_pool* pool, uint8_t* out, const uint8_t* in, size_t len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* tag, uint64_t* seq);
+void sm4_gcm_ks_get_stats(const sm4_gcm_ks_pool* pool, sm4_gcm_ks_stats* stats);
+
+// SM4-GCM-SIV:  RFC 8452 Ľṹ, 뻻ΪSM4, nonce. nonceظʱֻ
+// ¶ϢǷȫͬ, GCMй¶֤Կ.
+// ÿϢ key еSM4ԿnoncePOLYVALԿԿ, ȶAAD
+// POLYVAL(CLMUL, PCLMULQDQʱGHASH)õǩ, ԱǩΪʼCTR.
+// Ҫ, ÿϢһԿչ; AADĸ 2^36 ֽ
+#define SM4_GCM_SIV_NONCE_SIZE 12
+
+int sm4_gcm_siv_encrypt(const sm4_gcm_key* key, const uint8_t* nonce, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, uint8_t* tag);
+// ֤ʧʱ-1, ֧ in == out
+int sm4_gcm_siv_decrypt(const sm4_gcm_key* key, const uint8_t* nonce, uint8_t* out,
+    const uint8_t* in, size_t len, const uint8_t* aad, size_t aad_len, const uint8_t* tag);
+
+//  POLYVAL(H, X_1..X_n) (RFC 8452 3), ޹, ڶձ׼.
+// data ĩβһʱ, ӳȿ. impl Ϊ SM4_GHASH_CLMUL  SM4_GHASH_TABLE,
+// ֧ʱ-1
+int sm4_polyval(const uint8_t* H, const uint8_t* data, size_t len, int impl, uint8_t* out);
+
+// лGHASHʵ(ĬPCLMULQDQʱCLMUL, )ɶӦԤ,
+// 0ɹ, CPU֧ʱ-1
+int sm4_gcm_set_ghash(sm4_gcm_key* key, int impl);
+
 #endif // SM4_GCM_H
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "sm4_gcm_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const uint8_t gcmf_magic[8] = { 'S', 'M', '4', 'G', 'C', 'M', 'F', '1' };
+
+static void gcmf_store_be32(uint32_t v, uint8_t* p) {
+    for (int i = 3; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static void gcmf_store_be64(uint64_t v, uint8_t* p) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static uint64_t gcmf_load_be(const uint8_t* p, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+uint64_t sm4_gcmf_chunk_count(uint64_t plain_len, uint32_t chunk_size) {
+    if (chunk_size == 0 || chunk_size > SM4_GCMF_MAX_CHUNK) {
+        return 0;
+    }
+    uint64_t n = (plain_len == 0) ? 1 : (plain_len - 1) / chunk_size + 1;
+    return (n > SM4_GCMF_MAX_CHUNKS) ? 0 : n;
+}
+
+uint64_t sm4_gcmf_encrypted_size(uint64_t plain_len, uint32_t chunk_size) {
+    uint64_t n = sm4_gcmf_chunk_count(plain_len, chunk_size);
+    if (n == 0) {
+        return 0;
+    }
+    return SM4_GCMF_HEADER_SIZE + plain_len + n * SM4_GCM_TAG_SIZE;
+}
+
+int sm4_gcmf_parse_header(const uint8_t* in, uint64_t in_len, uint64_t* plain_len,
+    uint32_t* chunk_size) {
+    if (in_len < SM4_GCMF_HEADER_SIZE || memcmp(in, gcmf_magic, 8) != 0 ||
+        gcmf_load_be(in + 12, 4) != 0) {
+        return -1;
+    }
+    *chunk_size = (uint32_t)gcmf_load_be(in + 8, 4);
+    *plain_len = gcmf_load_be(in + 16, 8);
+    uint64_t expect = sm4_gcmf_encrypted_size(*plain_len, *chunk_size);
+    return (expect != 0 && expect == in_len) ? 0 : -1;
+}
+
+// һλIV/AAD. AADΪļͷĩ־, IV
+typedef struct {
+    const uint8_t* header;
+    uint64_t plain_len;
+    uint32_t chunk_size;
+    uint64_t nchunks;
+} gcmf_layout;
+
+static void gcmf_chunk_params(const gcmf_layout* lay, uint64_t i, uint8_t iv[12],
+    uint8_t aad[SM4_GCMF_HEADER_SIZE + 1], size_t* len, uint64_t* ct_off) {
+    memcpy(iv, lay->header + 24, SM4_GCMF_NONCE_SIZE);
+    gcmf_store_be32((uint32_t)i, iv + SM4_GCMF_NONCE_SIZE);
+    memcpy(aad, lay->header, SM4_GCMF_HEADER_SIZE);
+    aad[SM4_GCMF_HEADER_SIZE] = (i + 1 == lay->nchunks) ? 1 : 0;
+    *len = (i + 1 == lay->nchunks) ? (size_t)(lay->plain_len - i * lay->chunk_size)
+        : lay->chunk_size;
+    *ct_off = SM4_GCMF_HEADER_SIZE + i * ((uint64_t)lay->chunk_size + SM4_GCM_TAG_SIZE);
+}
+
+// ܻһ, ʱǩ-1 (ÿ)
+static int gcmf_chunk(const sm4_gcm_key* key, const gcmf_layout* lay, uint64_t i,
+    const uint8_t* in, uint8_t* out, int enc) {
+    uint8_t iv[12], aad[SM4_GCMF_HEADER_SIZE + 1];
+    size_t len;
+    uint64_t ct_off;
+    sm4_gcm_ctx ctx;
+    gcmf_chunk_params(lay, i, iv, aad, &len, &ct_off);
+    sm4_gcm_init(&ctx, key, iv, sizeof(iv));
+    if (enc) {
+        const uint8_t* pt = in + i * lay->chunk_size;
+        return sm4_gcm_encrypt(&ctx, out + ct_off, pt, len, aad, sizeof(aad),
+            out + ct_off + len);
+    }
+    return sm4_gcm_decrypt(&ctx, out, in + ct_off, len, aad, sizeof(aad),
+        in + ct_off + len);
+}
+
+// ̴߳ӹȡ, ߳Ҳ; ʧܵĿ
+template <typename F>
+static uint64_t gcmf_parallel(uint64_t nchunks, int nthreads, F fn) {
+    std::atomic<uint64_t> next(0), failed(0);
+    auto worker = [&]() {
+        for (uint64_t i = next++; i < nchunks; i = next++) {
+            if (fn(i) != 0) failed++;
+        }
+    };
+    if (nthreads <= 0) {
+        nthreads = (int)std::thread::hardware_concurrency();
+        if (nthreads <= 0) nthreads = 1;
+    }
+    if ((uint64_t)nthreads > nchunks) {
+        nthreads = (int)nchunks;
+    }
+    std::vector<std::thread> workers;
+    for (int t = 1; t < nthreads; t++) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    return failed;
+}
+
+int sm4_gcmf_encrypt_buffer(const sm4_gcm_key* key, const uint8_t file_nonce[8],
+    uint32_t chunk_size, const uint8_t* in, uint64_t len, uint8_t* out, int nthreads) {
+    gcmf_layout lay;
+    lay.nchunks = sm4_gcmf_chunk_count(len, chunk_size);
+    if (lay.nchunks == 0) {
+        return -1;
+    }
+    memcpy(out, gcmf_magic, 8);
+    gcmf_store_be32(chunk_size, out + 8);
+    gcmf_store_be32(0, out + 12);
+    gcmf_store_be64(len, out + 16);
+    memcpy(out + 24, file_nonce, SM4_GCMF_NONCE_SIZE);
+    lay.header = out;
+    lay.plain_len = len;
+    lay.chunk_size = chunk_size;
+    gcmf_parallel(lay.nchunks, nthreads, [&](uint64_t i) {
+        return gcmf_chunk(key, &lay, i, in, out, 1);
+    });
+    return 0;
+}
+
+int sm4_gcmf_decrypt_buffer(const sm4_gcm_key* key, const uint8_t* in, uint64_t in_len,
+    uint8_t* out, int nthreads) {
+    gcmf_layout lay;
+    if (sm4_gcmf_parse_header(in, in_len, &lay.plain_len, &lay.chunk_size) != 0) {
+        return -1;
+    }
+    lay.header = in;
+    lay.nchunks = sm4_gcmf_chunk_count(lay.plain_len, lay.chunk_size);
+    uint64_t failed = gcmf_parallel(lay.nchunks, nthreads, [&](uint64_t i) {
+        return gcmf_chunk(key, &lay, i, in, out + i * lay.chunk_size, 0);
+    });
+    if (failed) {
+        memset(out, 0, (size_t)lay.plain_len);
+        return -1;
+    }
+    return 0;
+}
+
+// Ĺ: ڷΧڵֱӽܵ out, βĿܵ scratch.
+// cached ¼ scratch ѽܵĿ, Сȡظͬһ
+static int gcmf_read(const sm4_gcm_key* key, const uint8_t* in, uint64_t in_len,
+    uint64_t offset, uint8_t* out, size_t len, uint8_t* scratch, uint64_t* cached) {
+    gcmf_layout lay;
+    if (sm4_gcmf_parse_header(in, in_len, &lay.plain_len, &lay.chunk_size) != 0 ||
+        offset > lay.plain_len || len > lay.plain_len - offset) {
+        return -1;
+    }
+    lay.header = in;
+    lay.nchunks = sm4_gcmf_chunk_count(lay.plain_len, lay.chunk_size);
+    while (len > 0) {
+        uint64_t i = offset / lay.chunk_size;
+        size_t skip = (size_t)(offset % lay.chunk_size);
+        size_t chunk_len = (i + 1 == lay.nchunks) ?
+            (size_t)(lay.plain_len - i * lay.chunk_size) : lay.chunk_size;
+        size_t n = (chunk_len - skip < len) ? chunk_len - skip : len;
+        if (skip == 0 && n == chunk_len) {
+            if (gcmf_chunk(key, &lay, i, in, out, 0) != 0) {
+                return -1;
+            }
+        }
+        else {
+            if (*cached != i) {
+                *cached = UINT64_MAX;
+                if (gcmf_chunk(key, &lay, i, in, scratch, 0) != 0) {
+                    return -1;
+                }
+                *cached = i;
+            }
+            memcpy(out, scratch + skip, n);
+        }
+        offset += n;
+        out += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int sm4_gcmf_read_range(const sm4_gcm_key* key, const uint8_t* in, uint64_t in_len,
+    uint64_t offset, uint8_t* out, size_t len) {
+    uint64_t plain_len, cached = UINT64_MAX;
+    uint32_t chunk_size;
+    if (sm4_gcmf_parse_header(in, in_len, &plain_len, &chunk_size) != 0) {
+        return -1;
+    }
+    // ļͷڱǩУǰ, ܳ
+    std::vector<uint8_t> scratch((plain_len < chunk_size) ? (size_t)plain_len : chunk_size);
+    return gcmf_read(key, in, in_len, offset, out, len, scratch.data(), &cached);
+}
+
+// ڴӳ. Ϊ0ļӳ, data Ϊ NULL
+typedef struct {
+    uint8_t* data;
+    uint64_t len;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} gcmf_map;
+
+// create_len Ϊ0ʱֻļ, 򴴽/ضΪ create_len ֽڲдӳ
+static int gcmf_map_open(gcmf_map* m, const char* path, uint64_t create_len) {
+    m->data = NULL;
+#if defined(_WIN32)
+    LARGE_INTEGER size;
+    m->mapping = NULL;
+    m->file = create_len ?
+        CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, NULL) :
+        CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    if (create_len) {
+        size.QuadPart = (LONGLONG)create_len;
+    }
+    else if (!GetFileSizeEx(m->file, &size)) {
+        CloseHandle(m->file);
+        return -1;
+    }
+    m->len = (uint64_t)size.QuadPart;
+    if (m->len == 0) {
+        return 0;
+    }
+    m->mapping = CreateFileMappingA(m->file, NULL, create_len ? PAGE_READWRITE : PAGE_READONLY,
+        (DWORD)(m->len >> 32), (DWORD)m->len, NULL);
+    if (m->mapping != NULL) {
+        m->data = (uint8_t*)MapViewOfFile(m->mapping,
+            create_len ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    }
+    if (m->data == NULL) {
+        if (m->mapping != NULL) CloseHandle(m->mapping);
+        CloseHandle(m->file);
+        return -1;
+    }
+    return 0;
+#else
+    struct stat st;
+    m->fd = create_len ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    if (m->fd < 0) {
+        return -1;
+    }
+    if (create_len) {
+        if (ftruncate(m->fd, (off_t)create_len) != 0) {
+            close(m->fd);
+            return -1;
+        }
+        m->len = create_len;
+    }
+    else {
+        if (fstat(m->fd, &st) != 0) {
+            close(m->fd);
+            return -1;
+        }
+        m->len = (uint64_t)st.st_size;
+    }
+    if (m->len == 0) {
+        return 0;
+    }
+    void* p = mmap(NULL, (size_t)m->len, create_len ? PROT_READ | PROT_WRITE : PROT_READ,
+        MAP_SHARED, m->fd, 0);
+    if (p == MAP_FAILED) {
+        close(m->fd);
+        return -1;
+    }
+    m->data = (uint8_t*)p;
+    return 0;
+#endif
+}
+
+static void gcmf_map_close(gcmf_map* m) {
+#if defined(_WIN32)
+    if (m->data != NULL) {
+        UnmapViewOfFile(m->data);
+        CloseHandle(m->mapping);
+    }
+    CloseHandle(m->file);
+#else
+    if (m->data != NULL) {
+        munmap(m->data, (size_t)m->len);
+    }
+    close(m->fd);
+#endif
+}
+
+int sm4_gcmf_encrypt_file(const sm4_gcm_key* key, const char* in_path, const char* out_path,
+    uint32_t chunk_size, int nthreads) {
+    gcmf_map in, out;
+    uint8_t nonce[SM4_GCMF_NONCE_SIZE];
+    std::random_device rd;
+    int ret;
+
+    if (gcmf_map_open(&in, in_path, 0) != 0) {
+        return -1;
+    }
+    uint64_t out_len = sm4_gcmf_encrypted_size(in.len, chunk_size);
+    if (out_len == 0 || gcmf_map_open(&out, out_path, out_len) != 0) {
+        gcmf_map_close(&in);
+        return -1;
+    }
+    for (int i = 0; i < SM4_GCMF_NONCE_SIZE; i += 4) {
+        gcmf_store_be32((uint32_t)rd(), nonce + i);
+    }
+    ret = sm4_gcmf_encrypt_buffer(key, nonce, chunk_size, in.data, in.len, out.data, nthreads);
+    gcmf_map_close(&out);
+    gcmf_map_close(&in);
+    return ret;
+}
+
+int sm4_gcmf_decrypt_file(const sm4_gcm_key* key, const char* in_path, const char* out_path,
+    int nthreads) {
+    gcmf_map in, out;
+    uint64_t plain_len;
+    uint32_t chunk_size;
+    int ret;
+
+    if (gcmf_map_open(&in, in_path, 0) != 0) {
+        return -1;
+    }
+    if (sm4_gcmf_parse_header(in.data, in.len, &plain_len, &chunk_size) != 0) {
+        gcmf_map_close(&in);
+        return -1;
+    }
+    if (plain_len == 0) {
+        // ļ޷ӳ, ֻУĩ󴴽յ
+        uint8_t dummy;
+        ret = sm4_gcmf_decrypt_buffer(key, in.data, in.len, &dummy, nthreads);
+        gcmf_map_close(&in);
+        if (ret == 0) {
+            FILE* fp = fopen(out_path, "wb");
+            if (fp == NULL) return -1;
+            fclose(fp);
+        }
+        return ret;
+    }
+    if (gcmf_map_open(&out, out_path, plain_len) != 0) {
+        gcmf_map_close(&in);
+        return -1;
+    }
+    ret = sm4_gcmf_decrypt_buffer(key, in.data, in.len, out.data, nthreads);
+    gcmf_map_close(&out);
+    gcmf_map_close(&in);
+    if (ret != 0) {
+        remove(out_path);
+    }
+    return ret;
+}
+
+struct sm4_gcmf_file {
+    const sm4_gcm_key* key;
+    gcmf_map map;
+    uint64_t plain_len;
+    std::vector<uint8_t> scratch;   // β
+    uint64_t cached;                // scratch еĿ, Ϊ UINT64_MAX
+};
+
+sm4_gcmf_file* sm4_gcmf_open(const sm4_gcm_key* key, const char* path) {
+    sm4_gcmf_file* f = new sm4_gcmf_file;
+    uint32_t chunk_size;
+    if (gcmf_map_open(&f->map, path, 0) != 0) {
+        delete f;
+        return NULL;
+    }
+    if (sm4_gcmf_parse_header(f->map.data, f->map.len, &f->plain_len, &chunk_size) != 0) {
+        gcmf_map_close(&f->map);
+        delete f;
+        return NULL;
+    }
+    f->key = key;
+    f->scratch.resize((f->plain_len < chunk_size) ? (size_t)f->plain_len : chunk_size);
+    f->cached = UINT64_MAX;
+    return f;
+}
+
+uint64_t sm4_gcmf_size(const sm4_gcmf_file* f) {
+    return f->plain_len;
+}
+
+int sm4_gcmf_read(sm4_gcmf_file* f, uint64_t offset, uint8_t* out, size_t len) {
+    return gcmf_read(f->key, f->map.data, f->map.len, offset, out, len,
+        f->scratch.data(), &f->cached);
+}
+
+void sm4_gcmf_close(sm4_gcmf_file* f) {
+    gcmf_map_close(&f->map);
+    delete f;
+}
@@ -0,0 +1,65 @@
+#ifndef SM4_GCM_FILE_H
+#define SM4_GCM_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sm4_gcm.h"
+
+// ֿʵ SM4-GCM ļʽ:
+//   ļͷ (32ֽ, Ϊ)
+//     0  ħ "SM4GCMF1"
+//     8  chunk_size   ÿֽ
+//     12 , Ϊ0
+//     16 plain_len    ܳ
+//     24 file_nonce   ÿļɵ8ֽ
+//   ֮Ϊ:  (һɲ chunk_size) || 16ֽڱǩ
+// iIV = file_nonce || [i]32, AAD = ļͷ || ĩ־(1ֽ).
+// IV, ˳ʹǩʧЧ; ÿ鶼֤ļͷеĳȺĩ
+// ־, ضϻĳȶܷ. ΪʱҲһյĩ, ֤ļͷ֤
+#define SM4_GCMF_HEADER_SIZE    32
+#define SM4_GCMF_NONCE_SIZE     8
+#define SM4_GCMF_DEFAULT_CHUNK  (64 * 1024)
+
+//  2^32 (ռIV32λ)
+#define SM4_GCMF_MAX_CHUNKS     (1ULL << 32)
+// 鳤 64MB. ȡʱ鳤ȷ仺, ļͷУǩ֮ǰҪʹ,
+// Ŀ鳤Ϊʽ, ֹαļͷ
+#define SM4_GCMF_MAX_CHUNK      (64u << 20)
+
+// ĳȼļ, chunk_size Ϊ0򳬹 SM4_GCMF_MAX_CHUNK
+// ʱ0
+uint64_t sm4_gcmf_chunk_count(uint64_t plain_len, uint32_t chunk_size);
+uint64_t sm4_gcmf_encrypted_size(uint64_t plain_len, uint32_t chunk_size);
+
+// ļͷȡĳȺͿ鳤; ļļͷ(ض/׷)ʱ-1.
+// ļͷɸıǩ֤, ˴ֻʽ
+int sm4_gcmf_parse_header(const uint8_t* in, uint64_t in_len, uint64_t* plain_len,
+    uint32_t* chunk_size);
+
+// ڴ浽ڴ: out  sm4_gcmf_encrypted_size ֽ. 黥,
+// ָ nthreads ߳(߳, <=0 ʱȡCPU)
+int sm4_gcmf_encrypt_buffer(const sm4_gcm_key* key, const uint8_t file_nonce[8],
+    uint32_t chunk_size, const uint8_t* in, uint64_t len, uint8_t* out, int nthreads);
+// out ļͷ plain_len ֽ; һ֤ʧʱ out -1
+int sm4_gcmf_decrypt_buffer(const sm4_gcm_key* key, const uint8_t* in, uint64_t in_len,
+    uint8_t* out, int nthreads);
+// ֻܸ [offset, offset + len) Ŀ, Խ֤ʧʱ-1
+int sm4_gcmf_read_range(const sm4_gcm_key* key, const uint8_t* in, uint64_t in_len,
+    uint64_t offset, uint8_t* out, size_t len);
+
+// ļӿ: ڴӳ, д. ʱ file_nonce .
+// ʧʱɾļ
+int sm4_gcmf_encrypt_file(const sm4_gcm_key* key, const char* in_path, const char* out_path,
+    uint32_t chunk_size, int nthreads);
+int sm4_gcmf_decrypt_file(const sm4_gcm_key* key, const char* in_path, const char* out_path,
+    int nthreads);
+
+// : ʱӳļļͷ, ֮ÿ read ֻܸǵĿ
+typedef struct sm4_gcmf_file sm4_gcmf_file;
+
+sm4_gcmf_file* sm4_gcmf_open(const sm4_gcm_key* key, const char* path);
+uint64_t sm4_gcmf_size(const sm4_gcmf_file* f);
+int sm4_gcmf_read(sm4_gcmf_file* f, uint64_t offset, uint8_t* out, size_t len);
+void sm4_gcmf_close(sm4_gcmf_file* f);
+
+#endif // SM4_GCM_FILE_H
@@ -0,0 +1,258 @@
+#include "sm4_tls.h"
+#include <string.h>
+
+// һν sm4_gcm_encrypt_batch ļ¼, nonce/AAD ջ
+#define TLS_BATCH_RECORDS 32
+// زСڴ˳ȵļ¼·
+#define TLS_BATCH_MAX_LEN 4096
+
+// TLS 1.3 ¼: 2^14 + 256; TLCP (TLS 1.2 AEAD): 2^14 + 2048
+#define TLS13_MAX_PAYLOAD (SM4_TLS_MAX_PLAINTEXT + 256)
+#define TLCP_MAX_PAYLOAD  (SM4_TLS_MAX_PLAINTEXT + 2048)
+
+static void tls_store_be16(uint32_t v, uint8_t* p) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void tls_store_be64(uint64_t v, uint8_t* p) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+// һ¼ nonce  AAD. TLS 1.3 AADǼ¼ͷ, ռĿռ
+typedef struct {
+    uint8_t nonce[SM4_GCM_IV_SIZE];
+    uint8_t aad[13];
+} tls_params;
+
+static void tls_nonce(const sm4_tls_ctx* ctx, uint64_t seq, uint8_t nonce[12]) {
+    if (ctx->version == SM4_TLS_VERSION_13) {
+        memcpy(nonce, ctx->iv, 4);
+        for (int i = 11; i >= 4; i--) {
+            nonce[i] = ctx->iv[i] ^ (uint8_t)seq;
+            seq >>= 8;
+        }
+        return;
+    }
+    memcpy(nonce, ctx->iv, 4);
+    tls_store_be64(seq, nonce + 4);
+}
+
+static void tls_header(uint8_t* rec, uint8_t type, uint32_t version, size_t payload) {
+    rec[0] = type;
+    tls_store_be16(version, rec + 1);
+    tls_store_be16((uint32_t)payload, rec + 3);
+}
+
+int sm4_tls_init(sm4_tls_ctx* ctx, int version, const uint8_t* key, const uint8_t* iv,
+    size_t iv_len) {
+    if (version == SM4_TLS_VERSION_13 ? iv_len != SM4_GCM_IV_SIZE :
+        version != SM4_TLS_VERSION_TLCP || (iv_len != 4 && iv_len != SM4_GCM_IV_SIZE)) {
+        return -1;
+    }
+    sm4_gcm_key_init(&ctx->key, key);
+    memset(ctx->iv, 0, sizeof(ctx->iv));
+    memcpy(ctx->iv, iv, iv_len);
+    ctx->seq = 0;
+    ctx->version = version;
+    return 0;
+}
+
+void sm4_tls_cleanup(sm4_tls_ctx* ctx) {
+    volatile uint8_t* p = (volatile uint8_t*)ctx;
+    for (size_t i = 0; i < sizeof(*ctx); i++) p[i] = 0;
+}
+
+size_t sm4_tls_headroom(const sm4_tls_ctx* ctx) {
+    return (ctx->version == SM4_TLS_VERSION_13) ? SM4_TLS_HEADER_SIZE :
+        SM4_TLS_HEADER_SIZE + SM4_TLCP_EXPLICIT_NONCE;
+}
+
+size_t sm4_tls_tailroom(const sm4_tls_ctx* ctx, size_t pad) {
+    return (ctx->version == SM4_TLS_VERSION_13) ? 1 + pad + SM4_GCM_TAG_SIZE :
+        SM4_GCM_TAG_SIZE;
+}
+
+int sm4_tls_record_size(const sm4_tls_ctx* ctx, const uint8_t* buf, size_t avail) {
+    if (avail < SM4_TLS_HEADER_SIZE) {
+        return 0;
+    }
+    uint32_t version = ((uint32_t)buf[1] << 8) | buf[2];
+    uint32_t payload = ((uint32_t)buf[3] << 8) | buf[4];
+    if (ctx->version == SM4_TLS_VERSION_13) {
+        if (buf[0] != SM4_TLS_CT_APPLICATION_DATA || version != 0x0303 ||
+            payload > TLS13_MAX_PAYLOAD) {
+            return -1;
+        }
+    }
+    else if (version != SM4_TLS_VERSION_TLCP || payload > TLCP_MAX_PAYLOAD) {
+        return -1;
+    }
+    return (int)(SM4_TLS_HEADER_SIZE + payload);
+}
+
+// д¼ͷڲ/ʽnonce, һ¼GCMϢ. Ϸʱ-1
+static int tls_prepare(const sm4_tls_ctx* ctx, uint64_t seq, uint8_t* rec, size_t len,
+    uint8_t type, size_t pad, tls_params* p, sm4_gcm_msg* msg) {
+    if (ctx->version == SM4_TLS_VERSION_13) {
+        // TLSInnerPlaintext =  ||  || ,  2^14 + 1 ֽ
+        if (len > SM4_TLS_MAX_PLAINTEXT || pad > SM4_TLS_MAX_PLAINTEXT - len) {
+            return -1;
+        }
+        uint8_t* inner = rec + SM4_TLS_HEADER_SIZE;
+        size_t inner_len = len + 1 + pad;
+        inner[len] = type;
+        memset(inner + len + 1, 0, pad);
+        tls_header(rec, SM4_TLS_CT_APPLICATION_DATA, 0x0303, inner_len + SM4_GCM_TAG_SIZE);
+        msg->aad = rec;
+        msg->aad_len = SM4_TLS_HEADER_SIZE;
+        msg->in = inner;
+        msg->out = inner;
+        msg->len = inner_len;
+    }
+    else {
+        if (len > SM4_TLS_MAX_PLAINTEXT) {
+            return -1;
+        }
+        uint8_t* body = rec + SM4_TLS_HEADER_SIZE + SM4_TLCP_EXPLICIT_NONCE;
+        tls_header(rec, type, SM4_TLS_VERSION_TLCP,
+            SM4_TLCP_EXPLICIT_NONCE + len + SM4_GCM_TAG_SIZE);
+        tls_store_be64(seq, rec + SM4_TLS_HEADER_SIZE);
+        tls_store_be64(seq, p->aad);
+        tls_header(p->aad + 8, type, SM4_TLS_VERSION_TLCP, len);
+        msg->aad = p->aad;
+        msg->aad_len = 13;
+        msg->in = body;
+        msg->out = body;
+        msg->len = len;
+    }
+    tls_nonce(ctx, seq, p->nonce);
+    msg->iv = p->nonce;
+    msg->iv_len = SM4_GCM_IV_SIZE;
+    msg->tag = (uint8_t*)msg->out + msg->len;
+    return 0;
+}
+
+static int tls_record_len(const sm4_gcm_msg* msg, const uint8_t* rec) {
+    return (int)(msg->out - rec + msg->len + SM4_GCM_TAG_SIZE);
+}
+
+int sm4_tls_seal(sm4_tls_ctx* ctx, uint8_t* rec, size_t len, uint8_t type, size_t pad) {
+    tls_params p;
+    sm4_gcm_msg msg;
+    sm4_gcm_ctx gctx;
+
+    if (ctx->seq == UINT64_MAX ||
+        tls_prepare(ctx, ctx->seq, rec, len, type, pad, &p, &msg) != 0) {
+        return -1;
+    }
+    sm4_gcm_init(&gctx, &ctx->key, msg.iv, msg.iv_len);
+    sm4_gcm_encrypt(&gctx, msg.out, msg.in, msg.len, msg.aad, msg.aad_len, msg.tag);
+    ctx->seq++;
+    return tls_record_len(&msg, rec);
+}
+
+int sm4_tls_seal_batch(sm4_tls_ctx* ctx, sm4_tls_record* recs, size_t n) {
+    tls_params p[TLS_BATCH_RECORDS];
+    sm4_gcm_msg msgs[TLS_BATCH_RECORDS];
+    sm4_tls_record* batch[TLS_BATCH_RECORDS];
+
+    // , ֤ʧʱдκλҲ
+    if (n > UINT64_MAX - ctx->seq) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (recs[i].len > SM4_TLS_MAX_PLAINTEXT || (ctx->version == SM4_TLS_VERSION_13 &&
+            recs[i].pad > SM4_TLS_MAX_PLAINTEXT - recs[i].len)) {
+            return -1;
+        }
+    }
+
+    // ¼ sm4_gcm_encrypt: ·ȶһϢCTRGHASH,
+    // ¼ἷL1; ̼¼һٺϲں˵
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; i++) {
+        sm4_tls_record* r = &recs[i];
+        tls_prepare(ctx, ctx->seq + i, r->rec, r->len, r->type, r->pad, &p[cnt], &msgs[cnt]);
+        if (msgs[cnt].len >= TLS_BATCH_MAX_LEN) {
+            sm4_gcm_ctx gctx;
+            sm4_gcm_msg* m = &msgs[cnt];
+            sm4_gcm_init(&gctx, &ctx->key, m->iv, m->iv_len);
+            sm4_gcm_encrypt(&gctx, m->out, m->in, m->len, m->aad, m->aad_len, m->tag);
+            r->rec_len = tls_record_len(m, r->rec);
+            continue;
+        }
+        batch[cnt++] = r;
+        if (cnt == TLS_BATCH_RECORDS) {
+            sm4_gcm_encrypt_batch(&ctx->key, msgs, cnt);
+            for (size_t j = 0; j < cnt; j++) {
+                batch[j]->rec_len = tls_record_len(&msgs[j], batch[j]->rec);
+            }
+            cnt = 0;
+        }
+    }
+    if (cnt > 0) {
+        sm4_gcm_encrypt_batch(&ctx->key, msgs, cnt);
+        for (size_t j = 0; j < cnt; j++) {
+            batch[j]->rec_len = tls_record_len(&msgs[j], batch[j]->rec);
+        }
+    }
+    ctx->seq += n;
+    return 0;
+}
+
+int sm4_tls_open(sm4_tls_ctx* ctx, uint8_t* rec, size_t rec_len, uint8_t* type) {
+    uint8_t nonce[SM4_GCM_IV_SIZE];
+    uint8_t aad[13];
+    sm4_gcm_ctx gctx;
+    int size = sm4_tls_record_size(ctx, rec, rec_len);
+
+    if (size <= 0 || (size_t)size != rec_len || ctx->seq == UINT64_MAX) {
+        return -1;
+    }
+    size_t head = sm4_tls_headroom(ctx);
+    if (rec_len < head + SM4_GCM_TAG_SIZE) {
+        return -1;
+    }
+    uint8_t* body = rec + head;
+    size_t len = rec_len - head - SM4_GCM_TAG_SIZE;
+
+    if (ctx->version == SM4_TLS_VERSION_13) {
+        tls_nonce(ctx, ctx->seq, nonce);
+        sm4_gcm_init(&gctx, &ctx->key, nonce, SM4_GCM_IV_SIZE);
+        if (len == 0 || sm4_gcm_decrypt(&gctx, body, body, len, rec, SM4_TLS_HEADER_SIZE,
+            body + len) != 0) {
+            memset(body, 0, len);
+            return -1;
+        }
+        // β, һֽʵ; ȫΪЭ
+        size_t i = len;
+        while (i > 0 && body[i - 1] == 0) i--;
+        if (i == 0 || i - 1 > SM4_TLS_MAX_PLAINTEXT) {
+            memset(body, 0, len);
+            return -1;
+        }
+        *type = body[i - 1];
+        len = i - 1;
+    }
+    else {
+        if (len > SM4_TLS_MAX_PLAINTEXT) {
+            return -1;
+        }
+        // ʽnonceȡԼ¼, AADеȡԱ˼, ߲ͬ
+        memcpy(nonce, ctx->iv, 4);
+        memcpy(nonce + 4, rec + SM4_TLS_HEADER_SIZE, SM4_TLCP_EXPLICIT_NONCE);
+        tls_store_be64(ctx->seq, aad);
+        tls_header(aad + 8, rec[0], SM4_TLS_VERSION_TLCP, len);
+        sm4_gcm_init(&gctx, &ctx->key, nonce, SM4_GCM_IV_SIZE);
+        if (sm4_gcm_decrypt(&gctx, body, body, len, aad, sizeof(aad), body + len) != 0) {
+            return -1;
+        }
+        *type = rec[0];
+    }
+    ctx->seq++;
+    return (int)len;
+}
@@ -0,0 +1,79 @@
+#ifndef SM4_TLS_H
+#define SM4_TLS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sm4_gcm.h"
+
+// TLS_SM4_GCM_SM3 ¼ (RFC 8446 + RFC 8998)  TLCP (GM/T 0024)  SM4-GCM ¼,
+// ڵ÷ԭؼӽ. :
+//   rec: [¼ͷ headroom][ len][tailroom]
+// ÷ķ rec + headroom, װ rec Ϊ¼, ޶⸴.
+//   TLS 1.3: ͷ5ֽ; ĺ(1ֽ), ٽ16ֽڱǩ.
+//            nonce = ̬IV ^ (0^32 || [seq]64), AAD = ¼ͷ
+//   TLCP:    ͷ5ֽ + ʽnonce 8ֽ (); ĺ16ֽڱǩ.
+//            nonce = 4ֽʽsalt || ʽnonce, AAD = seq ||  || 汾 || ĳ
+// nonce  AAD ջ, ڴ. ÿÿһ
+
+#define SM4_TLS_VERSION_13   0x0304     // ¼ͷе legacy_record_version Ϊ 0x0303
+#define SM4_TLS_VERSION_TLCP 0x0101
+
+// 
+#define SM4_TLS_CT_CHANGE_CIPHER_SPEC 20
+#define SM4_TLS_CT_ALERT              21
+#define SM4_TLS_CT_HANDSHAKE          22
+#define SM4_TLS_CT_APPLICATION_DATA   23
+
+#define SM4_TLS_HEADER_SIZE     5
+#define SM4_TLS_MAX_PLAINTEXT   (1 << 14)
+#define SM4_TLCP_EXPLICIT_NONCE 8
+
+// ԤʱõϽ: TLCP ͷ13ֽ, TLS 1.3 β17ֽڼ
+#define SM4_TLS_MAX_HEADROOM    (SM4_TLS_HEADER_SIZE + SM4_TLCP_EXPLICIT_NONCE)
+#define SM4_TLS_MAX_TAILROOM    (1 + SM4_GCM_TAG_SIZE)
+
+typedef struct {
+    sm4_gcm_key key;
+    uint8_t iv[SM4_GCM_IV_SIZE];    // TLS 1.3: ̬IV; TLCP: ֻǰ4ֽsalt
+    uint64_t seq;                   // һ¼
+    int version;                    // SM4_TLS_VERSION_*
+} sm4_tls_ctx;
+
+// װеһ¼
+typedef struct {
+    uint8_t* rec;           // λ rec + headroom
+    size_t len;             // ĳ
+    uint8_t type;           // 
+    size_t pad;             // TLS 1.3 ֽ,  tailroom ; TLCP 
+    int rec_len;            // : ¼ܳ
+} sm4_tls_record;
+
+// iv_len: TLS 1.3 Ϊ12, TLCP Ϊ4 (ʽsalt, Ҳɸ12ֻֽȡǰ4ֽ). Ŵ0ʼ;
+// TLS 1.3  KeyUpdate Կµü. 汾IVȲʱ-1
+int sm4_tls_init(sm4_tls_ctx* ctx, int version, const uint8_t* key, const uint8_t* iv,
+    size_t iv_len);
+// ԿIV
+void sm4_tls_cleanup(sm4_tls_ctx* ctx);
+
+size_t sm4_tls_headroom(const sm4_tls_ctx* ctx);
+// pad Ϊ TLS 1.3 ֽ, TLCP 
+size_t sm4_tls_tailroom(const sm4_tls_ctx* ctx, size_t pad);
+
+// ֡: buf  avail ֽʱ, صһ¼ܳ (ͷ+); 5ֽ
+// 0 (); ȳЭ޻汾-1. avail Сڷֵʱͬ
+int sm4_tls_record_size(const sm4_tls_ctx* ctx, const uint8_t* buf, size_t avail);
+
+// һŷװһ¼: д¼ͷ, ԭؼ, дǩ. ؼ¼ܳ;
+// () 2^14 źľʱ-1, Ų
+int sm4_tls_seal(sm4_tls_ctx* ctx, uint8_t* rec, size_t len, uint8_t type, size_t pad);
+// ŷװ n ¼, ¼ļ SM4(J0) ƴͬһSM4ں˵,
+// GHASH· (sm4_gcm_encrypt_batch).  sm4_tls_seal ͬ.
+// һϷʱκδ, -1
+int sm4_tls_seal_batch(sm4_tls_ctx* ctx, sm4_tls_record* recs, size_t n);
+
+// ԭؽ⿪ rec еһ¼ (rec_len  sm4_tls_record_size), ɹ
+// , λ rec + headroom, *type Ϊ (TLS 1.3 ȡڲ, ȥ).
+// ʽ֤ʧܷ-1 㸺, Ų; Эʱֹ
+int sm4_tls_open(sm4_tls_ctx* ctx, uint8_t* rec, size_t rec_len, uint8_t* type);
+
+#endif // SM4_TLS_H
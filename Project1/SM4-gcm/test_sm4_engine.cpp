@@ -0,0 +1,223 @@
+#include "sm4_engine.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <vector>
+
+// 첽ʾ: ύ̲߳ύС, ֱӵñȶԽ,
+// ٱȽϲͬ batch_jobs / max_delay_us µ̶
+
+#define PRODUCERS 8
+
+static void fill(uint8_t* p, size_t n, unsigned int seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        p[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+typedef struct {
+    sm4_job job;
+    uint8_t iv[16];
+    uint8_t aad[20];
+    uint8_t in[600];
+    uint8_t out[600];
+    uint8_t tag[16];
+    uint8_t ref[600];
+    uint8_t ref_tag[16];
+} test_item;
+
+static std::atomic<int> g_callbacks(0);
+
+// arg ָύ߳Լļ
+static void on_done(sm4_job* job, void* arg) {
+    (void)job;
+    ((std::atomic<int>*)arg)->fetch_add(1);
+    g_callbacks.fetch_add(1);
+}
+
+// ÿύ߳ count  (GCM//CTR,  0~600), ȫύȴ
+static int correctness_producer(sm4_engine* engine, const sm4_gcm_key* key, int id, int count) {
+    std::vector<test_item> items(count);
+    std::atomic<int> callbacks(0);
+    int expect = 0;
+    int errors = 0;
+    for (int i = 0; i < count; i++) {
+        test_item* t = &items[i];
+        unsigned int seed = (unsigned int)(id * 10007 + i);
+        size_t len = (size_t)(seed * 37 % 601);
+        fill(t->iv, sizeof(t->iv), seed);
+        fill(t->aad, sizeof(t->aad), seed + 1);
+        fill(t->in, len, seed + 2);
+        new (&t->job) sm4_job();    // ֵʼ, ԭӳԱ memset
+        t->job.type = i % 3;
+        t->job.key = key;
+        t->job.iv = t->iv;
+        t->job.iv_len = 12;
+        t->job.aad = t->aad;
+        t->job.aad_len = (i & 1) ? sizeof(t->aad) : 0;
+        t->job.in = t->in;
+        t->job.out = t->out;
+        t->job.len = len;
+        t->job.tag = t->tag;
+        if (i % 7 == 0) {
+            t->job.callback = on_done;
+            t->job.arg = &callbacks;
+            expect++;
+        }
+
+        // ο, ֱӽӿڼܳ
+        sm4_gcm_ctx ctx;
+        if (t->job.type == SM4_JOB_CTR) {
+            uint8_t ctr[16];
+            memcpy(ctr, t->iv, 16);
+            sm4_ctr_xor(&key->sm4_key, ctr, t->in, t->ref, len);
+        }
+        else if (t->job.type == SM4_JOB_GCM_ENCRYPT) {
+            sm4_gcm_init(&ctx, key, t->iv, 12);
+            sm4_gcm_encrypt(&ctx, t->ref, t->in, len, t->aad, t->job.aad_len, t->ref_tag);
+        }
+        else {
+            memcpy(t->ref, t->in, len);
+            sm4_gcm_init(&ctx, key, t->iv, 12);
+            sm4_gcm_encrypt(&ctx, t->in, t->ref, len, t->aad, t->job.aad_len, t->tag);
+            if (i % 5 == 0) {
+                t->tag[i % 16] ^= 1;    // ۸, ֤ʧ
+            }
+        }
+        while (sm4_engine_submit(engine, &t->job) != 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        test_item* t = &items[i];
+        if (t->job.callback != NULL) {
+            continue;
+        }
+        int ret = sm4_job_wait(&t->job);
+        size_t len = t->job.len;
+        if (t->job.type == SM4_JOB_GCM_DECRYPT && i % 5 == 0) {
+            uint8_t zero[600] = { 0 };
+            if (ret != -1 || memcmp(t->out, zero, len) != 0) errors++;
+            continue;
+        }
+        if (ret != 0 || memcmp(t->out, t->ref, len) != 0) errors++;
+        if (t->job.type == SM4_JOB_GCM_ENCRYPT && memcmp(t->tag, t->ref_tag, 16) != 0) errors++;
+    }
+    // صû done ־, Ȼصͷ items
+    while (callbacks.load() < expect) {
+        std::this_thread::yield();
+    }
+    return errors;
+}
+
+static int test_correctness(const sm4_gcm_key* key) {
+    sm4_engine_config cfg;
+    sm4_engine_default_config(&cfg);
+    cfg.nworkers = 2;
+    cfg.ring_size = 64;     // ȡС, ǻ
+    sm4_engine* engine = sm4_engine_create(&cfg);
+
+    const int count = 300;
+    int callbacks = 0;
+    for (int i = 0; i < count; i++) callbacks += (i % 7 == 0);
+    callbacks *= PRODUCERS;
+
+    std::atomic<int> errors(0);
+    std::vector<std::thread> threads;
+    g_callbacks.store(0);
+    for (int p = 0; p < PRODUCERS; p++) {
+        threads.push_back(std::thread([&, p]() {
+            errors.fetch_add(correctness_producer(engine, key, p, count));
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    sm4_engine_stats st;
+    sm4_engine_get_stats(engine, &st);
+    sm4_engine_destroy(engine);
+    printf("   %llu,  %llu, ص %d/%d,  %llu ( %llu, ʱ %llu),  %llu ,  %zu\n",
+        (unsigned long long)st.submitted, (unsigned long long)st.completed,
+        g_callbacks.load(), callbacks, (unsigned long long)st.batches,
+        (unsigned long long)st.full_batches, (unsigned long long)st.deadline_batches,
+        (unsigned long long)st.rejected, st.max_queue_depth);
+    return errors.load() == 0 && st.completed == st.submitted && g_callbacks.load() == callbacks;
+}
+
+// ÿύ̱߳ window ;, ÿ len ֽڵGCM
+static void bench(const sm4_gcm_key* key, const char* name, int batch_jobs, unsigned int delay_us,
+    size_t len, int window) {
+    sm4_engine_config cfg;
+    sm4_engine_default_config(&cfg);
+    cfg.batch_jobs = batch_jobs;
+    cfg.max_delay_us = delay_us;
+    sm4_engine* engine = sm4_engine_create(&cfg);
+
+    const int per_thread = 4000;
+    std::vector<std::thread> threads;
+    auto wall = std::chrono::steady_clock::now();
+    for (int p = 0; p < PRODUCERS; p++) {
+        threads.push_back(std::thread([&]() {
+            std::vector<sm4_job> jobs(window);
+            std::vector<uint8_t> buf(window * len);
+            std::vector<uint8_t> tags(window * 16);
+            uint8_t iv[12] = { 0 };
+            for (int done = 0; done < per_thread; done += window) {
+                for (int k = 0; k < window; k++) {
+                    sm4_job* j = &jobs[k];
+                    new (j) sm4_job();
+                    j->type = SM4_JOB_GCM_ENCRYPT;
+                    j->key = key;
+                    j->iv = iv;
+                    j->iv_len = 12;
+                    j->in = &buf[k * len];
+                    j->out = &buf[k * len];
+                    j->len = len;
+                    j->tag = &tags[k * 16];
+                    while (sm4_engine_submit(engine, j) != 0) std::this_thread::yield();
+                }
+                for (int k = 0; k < window; k++) sm4_job_wait(&jobs[k]);
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall).count();
+
+    sm4_engine_stats st;
+    sm4_engine_get_stats(engine, &st);
+    sm4_engine_destroy(engine);
+    double total = (double)PRODUCERS * per_thread;
+    printf("  %-22s %4zuֽx%d;: %8.0f / %7.2f MB/s, ƽÿ %5.2f  ( %llu, ʱ %llu),  %zu\n",
+        name, len, window, total / secs, total * len / secs / (1024 * 1024),
+        st.batches ? (double)st.completed / st.batches : 0.0,
+        (unsigned long long)st.full_batches, (unsigned long long)st.deadline_batches,
+        st.max_queue_depth);
+}
+
+int main() {
+    const uint8_t user_key[16] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10
+    };
+    sm4_gcm_key key;
+    sm4_gcm_key_init(&key, user_key);
+
+    printf("1. ȷ (%d ύ߳, GCM//CTR , ۸ıǩͻص)\n", PRODUCERS);
+    int ok = test_correctness(&key);
+    printf("  : %s\n", ok ? "ͨ" : "ʧ");
+
+    printf("\n2. /ӳٲ (%d ύ߳, %u ߳)\n", PRODUCERS,
+        std::thread::hardware_concurrency());
+    bench(&key, "batch=1  ()", 1, 0, 64, 8);
+    bench(&key, "batch=8  delay=20us", 8, 20, 64, 8);
+    bench(&key, "batch=16 delay=50us", 16, 50, 64, 8);
+    bench(&key, "batch=64 delay=200us", 64, 200, 64, 8);
+    bench(&key, "batch=1  ()", 1, 0, 512, 8);
+    bench(&key, "batch=16 delay=50us", 16, 50, 512, 8);
+
+    return ok ? 0 : 1;
+}
@@ -2,6 +2,9 @@
 #include <stdio.h>
 #include <string.h>
 #include<time.h>
+#include <chrono>
+#include <atomic>
+#include <thread>
 
 void print_hex(const char* label, const uint8_t* data, size_t len) {
     printf("%s: ", label);
@@ -35,19 +38,24 @@ int main() {
     double cpu_time_used;
     const int iterations = 10000; // ѭ
 
-    // 1. ʼʱ
+    // 1. ʼʱ: ÿԿһεԤÿϢIV÷ֿ
+    sm4_gcm_key gkey;
     start = clock();
     for (int i = 0; i < iterations; i++) {
-        sm4_gcm_ctx ctx;
-        sm4_gcm_init(&ctx, key, iv, sizeof(iv));
+        sm4_gcm_key_init(&gkey, key);
     }
     end = clock();
     cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("ʼƽʱ: %.8f \n", cpu_time_used / iterations);
+    printf("Կʼƽʱ: %.8f \n", cpu_time_used / iterations);
 
-    // ʼ
     sm4_gcm_ctx ctx;
-    sm4_gcm_init(&ctx, key, iv, sizeof(iv));
+    start = clock();
+    for (int i = 0; i < iterations; i++) {
+        sm4_gcm_init(&ctx, &gkey, iv, sizeof(iv));
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("Ϣʼƽʱ: %.8f \n", cpu_time_used / iterations);
 
     // 2. ʱ
     start = clock();
@@ -81,5 +89,546 @@ int main() {
         printf("Authentication failed!\n");
     }
 
+    // 4. RFC 8998 
+    {
+        const uint8_t kat_key[16] = {
+            0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+            0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+        const uint8_t kat_iv[12] = {
+            0x00, 0x00, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x00, 0xab, 0xcd };
+        const uint8_t kat_aad[20] = {
+            0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed,
+            0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2 };
+        const uint8_t kat_tag[16] = {
+            0x83, 0xde, 0x35, 0x41, 0xe4, 0xc2, 0xb5, 0x81,
+            0x77, 0xe0, 0x65, 0xa9, 0xbf, 0x7b, 0x62, 0xec };
+        const uint8_t kat_ct_head[16] = {
+            0x17, 0xf3, 0x99, 0xf0, 0x8c, 0x67, 0xd5, 0xee,
+            0x19, 0xd0, 0xdc, 0x99, 0x69, 0xc4, 0xbb, 0x7d };
+        const char* fill = "ABCDEFEA";
+        uint8_t kat_pt[64];
+        for (int i = 0; i < 64; i++) {
+            kat_pt[i] = (uint8_t)(0x11 * (fill[i / 8] - 'A' + 0xa));
+        }
+        sm4_gcm_key kat_gkey;
+        sm4_gcm_ctx kat_ctx;
+        sm4_gcm_key_init(&kat_gkey, kat_key);
+        sm4_gcm_init(&kat_ctx, &kat_gkey, kat_iv, sizeof(kat_iv));
+        sm4_gcm_encrypt(&kat_ctx, ciphertext, kat_pt, sizeof(kat_pt),
+            kat_aad, sizeof(kat_aad), tag);
+        int kat_ok = memcmp(ciphertext, kat_ct_head, 16) == 0 &&
+            memcmp(tag, kat_tag, 16) == 0;
+        printf("RFC 8998 : %s\n", kat_ok ? "ͨ" : "ʧ");
+    }
+
+    // 5. ʽӿ: AADݰֶͬγ, һԽӿһ
+    {
+        static uint8_t msg[1000], ct_ref[1000], ct_stream[1000];
+        uint8_t tag_ref[SM4_GCM_TAG_SIZE], tag_stream[SM4_GCM_TAG_SIZE];
+        const size_t steps[] = { 1, 3, 15, 16, 17, 100, 999 };
+        int stream_ok = 1;
+        for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i * 7);
+        sm4_gcm_encrypt(&ctx, ct_ref, msg, sizeof(msg), plaintext, plaintext_len, tag_ref);
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+            size_t step = steps[s], off;
+            sm4_gcm_init(&ctx, &gkey, iv, sizeof(iv));
+            for (off = 0; off < plaintext_len; off += step) {
+                size_t n = (plaintext_len - off < step) ? plaintext_len - off : step;
+                sm4_gcm_update_aad(&ctx, plaintext + off, n);
+            }
+            for (off = 0; off < sizeof(msg); off += step) {
+                size_t n = (sizeof(msg) - off < step) ? sizeof(msg) - off : step;
+                sm4_gcm_encrypt_update(&ctx, ct_stream + off, msg + off, n);
+            }
+            sm4_gcm_encrypt_final(&ctx, tag_stream);
+            if (memcmp(ct_ref, ct_stream, sizeof(msg)) != 0 ||
+                memcmp(tag_ref, tag_stream, sizeof(tag_ref)) != 0) {
+                stream_ok = 0;
+            }
+            // ԭؽ
+            sm4_gcm_init(&ctx, &gkey, iv, sizeof(iv));
+            sm4_gcm_update_aad(&ctx, plaintext, plaintext_len);
+            for (off = 0; off < sizeof(msg); off += step) {
+                size_t n = (sizeof(msg) - off < step) ? sizeof(msg) - off : step;
+                sm4_gcm_decrypt_update(&ctx, ct_stream + off, ct_stream + off, n);
+            }
+            if (sm4_gcm_decrypt_final(&ctx, tag_ref) != 0 ||
+                memcmp(ct_stream, msg, sizeof(msg)) != 0) {
+                stream_ok = 0;
+            }
+        }
+        printf("ʽӿ: %s\n", stream_ok ? "ͨ" : "ʧ");
+    }
+
+    // 6. ӿ: Ϣ/IV/AADͬ, һ; ٱȽС
+    {
+        const int nmsg = 64;
+        static uint8_t pool_in[64 * 1500], pool_out[64 * 1500], pool_ref[64 * 1500];
+        static uint8_t tags[64][SM4_GCM_TAG_SIZE], tags_ref[64][SM4_GCM_TAG_SIZE];
+        static uint8_t ivs[64][16];
+        sm4_gcm_msg msgs[64];
+        int batch_ok = 1;
+        for (size_t i = 0; i < sizeof(pool_in); i++) pool_in[i] = (uint8_t)(i * 13 + 5);
+        for (int m = 0; m < nmsg; m++) {
+            memset(ivs[m], m, 16);
+            msgs[m].iv = ivs[m];
+            msgs[m].iv_len = (m % 5 == 0) ? 16 : 12;
+            msgs[m].aad = pool_in + m;
+            msgs[m].aad_len = (size_t)(m * 7) % 41;
+            msgs[m].in = pool_in + m * 1500;
+            msgs[m].out = pool_out + m * 1500;
+            msgs[m].len = (size_t)(m * 97) % 1501;
+            msgs[m].tag = tags[m];
+            sm4_gcm_init(&ctx, &gkey, msgs[m].iv, msgs[m].iv_len);
+            sm4_gcm_encrypt(&ctx, pool_ref + m * 1500, msgs[m].in, msgs[m].len,
+                msgs[m].aad, msgs[m].aad_len, tags_ref[m]);
+        }
+        sm4_gcm_encrypt_batch(&gkey, msgs, nmsg);
+        for (int m = 0; m < nmsg; m++) {
+            if (memcmp(pool_out + m * 1500, pool_ref + m * 1500, msgs[m].len) != 0 ||
+                memcmp(tags[m], tags_ref[m], SM4_GCM_TAG_SIZE) != 0) {
+                batch_ok = 0;
+            }
+        }
+        // ԭؽ, ۸һıǩ
+        tags[9][3] ^= 1;
+        for (int m = 0; m < nmsg; m++) {
+            msgs[m].in = msgs[m].out;
+        }
+        batch_ok = batch_ok && sm4_gcm_decrypt_batch(&gkey, msgs, nmsg) == 1;
+        for (int m = 0; m < nmsg; m++) {
+            if (m == 9) {
+                batch_ok = batch_ok && msgs[m].result == -1;
+                continue;
+            }
+            batch_ok = batch_ok && msgs[m].result == 0 &&
+                memcmp(pool_out + m * 1500, pool_in + m * 1500, msgs[m].len) == 0;
+        }
+        for (int m = 0; m < nmsg; m++) {
+            msgs[m].in = pool_in + m * 1500;
+        }
+        printf("ӿ: %s\n", batch_ok ? "ͨ" : "ʧ");
+
+        const size_t sizes[] = { 64, 256, 1500 };
+        for (int k = 0; k < 3; k++) {
+            const int rounds = 2000;
+            double t_single, t_batch;
+            for (int m = 0; m < nmsg; m++) {
+                msgs[m].iv_len = 12;
+                msgs[m].aad_len = 13;
+                msgs[m].len = sizes[k];
+            }
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                for (int m = 0; m < nmsg; m++) {
+                    sm4_gcm_init(&ctx, &gkey, msgs[m].iv, 12);
+                    sm4_gcm_encrypt(&ctx, msgs[m].out, msgs[m].in, sizes[k],
+                        msgs[m].aad, 13, msgs[m].tag);
+                }
+            }
+            end = clock();
+            t_single = ((double)(end - start)) / CLOCKS_PER_SEC;
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gcm_encrypt_batch(&gkey, msgs, nmsg);
+            }
+            end = clock();
+            t_batch = ((double)(end - start)) / CLOCKS_PER_SEC;
+            printf("%4dֽС:  %.2f MB/s,  %.2f MB/s\n", (int)sizes[k],
+                sizes[k] * (double)nmsg * rounds / t_single / 1e6,
+                sizes[k] * (double)nmsg * rounds / t_batch / 1e6);
+        }
+    }
+
+    // 7. ߳: ǩ뵥߳һ
+    {
+        const size_t mt_len = 16 * 1024 * 1024 + 7;
+        uint8_t* mt_in = (uint8_t*)malloc(mt_len);
+        uint8_t* mt_ref = (uint8_t*)malloc(mt_len);
+        uint8_t* mt_out = (uint8_t*)malloc(mt_len);
+        uint8_t tag_ref[SM4_GCM_TAG_SIZE], tag_mt[SM4_GCM_TAG_SIZE];
+        sm4_gcm_pool* pool = sm4_gcm_pool_create(4);
+        const int rounds = 5;
+        double t_single, t_mt;
+        for (size_t i = 0; i < mt_len; i++) mt_in[i] = (uint8_t)(i ^ (i >> 8));
+        sm4_gcm_pool_set_min_chunk(pool, 64 * 1024);
+
+        start = clock();
+        for (int i = 0; i < rounds; i++) {
+            sm4_gcm_encrypt(&ctx, mt_ref, mt_in, mt_len, aad, sizeof(aad), tag_ref);
+        }
+        end = clock();
+        t_single = ((double)(end - start)) / CLOCKS_PER_SEC;
+        // clock() ͳƵǽCPUʱ, ߳¸ùʱ
+        auto wall_start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            sm4_gcm_encrypt_mt(pool, &ctx, mt_out, mt_in, mt_len, aad, sizeof(aad), tag_mt);
+        }
+        t_mt = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+        int mt_ok = memcmp(mt_ref, mt_out, mt_len) == 0 &&
+            memcmp(tag_ref, tag_mt, sizeof(tag_ref)) == 0;
+        mt_ok = mt_ok && sm4_gcm_decrypt_mt(pool, &ctx, mt_out, mt_out, mt_len,
+            aad, sizeof(aad), tag_mt) == 0 && memcmp(mt_out, mt_in, mt_len) == 0;
+        printf("߳: %s, ߳ %.2f MB/s, ߳ %.2f MB/s\n",
+            mt_ok ? "ͨ" : "ʧ",
+            mt_len * (double)rounds / t_single / 1e6, mt_len * (double)rounds / t_mt / 1e6);
+        sm4_gcm_pool_destroy(pool);
+        free(mt_in);
+        free(mt_ref);
+        free(mt_out);
+    }
+
+    // 8. 
+    {
+        static uint8_t big_in[1024 * 1024], big_out[1024 * 1024];
+        const int rounds = 50;
+        start = clock();
+        for (int i = 0; i < rounds; i++) {
+            sm4_gcm_encrypt(&ctx, big_out, big_in, sizeof(big_in), aad, sizeof(aad), tag);
+        }
+        end = clock();
+        cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+        printf("1MB: %.2f MB/s\n",
+            sizeof(big_in) * (double)rounds / cpu_time_used / 1e6);
+    }
+
+    // 9. GHASHʵ: ֻAADû, ʱȫGHASH
+    static uint8_t big_aad[16 * 1024];
+    const char* impl_names[] = { "λ", "", "CLMUL" };
+    uint8_t ref_tag[SM4_GCM_TAG_SIZE];
+    printf("Shoup: %dλ, %dֽ\n", SM4_GCM_TABLE_BITS,
+        (int)(sizeof(gkey.HL) + sizeof(gkey.HH)));
+    for (int impl = SM4_GHASH_BITWISE; impl <= SM4_GHASH_CLMUL; impl++) {
+        if (sm4_gcm_set_ghash(&gkey, impl) != 0) {
+            printf("GHASH(%s): ֧\n", impl_names[impl]);
+            continue;
+        }
+        int rounds = (impl == SM4_GHASH_BITWISE) ? 10 : 1000;
+        start = clock();
+        for (int i = 0; i < rounds; i++) {
+            sm4_gcm_encrypt(&ctx, ciphertext, plaintext, 0, big_aad, sizeof(big_aad), tag);
+        }
+        end = clock();
+        cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+        if (impl == SM4_GHASH_BITWISE) memcpy(ref_tag, tag, sizeof(tag));
+        printf("GHASH(%s): %.2f MB/s%s\n", impl_names[impl],
+            sizeof(big_aad) * (double)rounds / cpu_time_used / 1e6,
+            memcmp(ref_tag, tag, sizeof(tag)) == 0 ? "" : " (ǩһ!)");
+    }
+
+    // 10. ɢ/ۼӿ: Դ/Ŀİͬʽֶ(նκ1ֽڶ), 
+    //     һ; ԭؽܲ۸ıǩ. ȽСԻֱӱֶ
+    {
+        static uint8_t src_buf[2048], dst_buf[1600], lin[1500], ref_ct[1500];
+        uint8_t iov_tag[SM4_GCM_TAG_SIZE], ref_tag2[SM4_GCM_TAG_SIZE];
+        const size_t src_cuts[] = { 20, 0, 1, 37, 16, 5, 200, 700, 1 };
+        const size_t dst_cuts[] = { 3, 64, 13, 0, 500, 17, 1003 };
+        sm4_gcm_iovec src_iov[10], dst_iov[8], aad_iov[3];
+        size_t len = 0, off = 0;
+        int iov_ok = 1;
+        for (size_t i = 0; i < sizeof(src_buf); i++) src_buf[i] = (uint8_t)(i * 7 + 1);
+        for (size_t i = 0; i < 9; i++) {
+            src_iov[i].base = src_buf + len;
+            src_iov[i].len = src_cuts[i];
+            len += src_cuts[i];
+        }
+        for (size_t i = 0; i < 7; i++) {
+            dst_iov[i].base = dst_buf + off;
+            dst_iov[i].len = dst_cuts[i];
+            off += dst_cuts[i];
+        }
+        aad_iov[0].base = aad;
+        aad_iov[0].len = 3;
+        aad_iov[1].base = aad + 3;
+        aad_iov[1].len = 0;
+        aad_iov[2].base = aad + 3;
+        aad_iov[2].len = sizeof(aad) - 3;
+
+        sm4_gcm_encrypt(&ctx, ref_ct, src_buf, len, aad, sizeof(aad), ref_tag2);
+        sm4_gcm_encrypt_iov(&ctx, dst_iov, 7, src_iov, 9, aad_iov, 3, iov_tag);
+        iov_ok = memcmp(dst_buf, ref_ct, len) == 0 && memcmp(iov_tag, ref_tag2, 16) == 0;
+        // ԭ: ĿԴΪͬһ
+        memcpy(src_buf, ref_ct, len);
+        iov_ok = iov_ok && sm4_gcm_decrypt_iov(&ctx, src_iov, 9, src_iov, 9, aad_iov, 3,
+            iov_tag) == 0;
+        for (size_t i = 0; i < len; i++) iov_ok = iov_ok && src_buf[i] == (uint8_t)(i * 7 + 1);
+        // ĿıԴ
+        iov_ok = iov_ok && sm4_gcm_encrypt_iov(&ctx, dst_iov, 3, src_iov, 9, aad_iov, 3,
+            iov_tag) == -1;
+        memcpy(src_buf, ref_ct, len);
+        memcpy(iov_tag, ref_tag2, 16);
+        iov_tag[15] ^= 0x80;
+        iov_ok = iov_ok && sm4_gcm_decrypt_iov(&ctx, src_iov, 9, src_iov, 9, aad_iov, 3,
+            iov_tag) == -1 && src_buf[0] == 0 && src_buf[len - 1] == 0;
+        printf("ɢ/ۼӿ: %s\n", iov_ok ? "ͨ" : "ʧ");
+
+        // : 20ֽͷ + 3θ + 16ֽβ, ͷAAD, غβԭؼ.
+        // 1400ֽڱʱ 459 ֽ,  576 ֽڼûص
+        const size_t pkt_sizes[] = { 64, 256, 1400 };
+        for (int k = 0; k < 3; k++) {
+            size_t body = pkt_sizes[k] - 36, f1 = body / 3, f2 = body / 3 + 5;
+            uint8_t* hdr = src_buf;
+            uint8_t* frag[3] = { src_buf + 64, src_buf + 640, src_buf + 1216 };
+            size_t frag_len[3] = { f1, f2, body - f1 - f2 };
+            uint8_t* trailer = src_buf + 1792;
+            sm4_gcm_iovec pkt[4], hdr_iov;
+            hdr_iov.base = hdr;
+            hdr_iov.len = 20;
+            for (int f = 0; f < 3; f++) {
+                pkt[f].base = frag[f];
+                pkt[f].len = frag_len[f];
+            }
+            pkt[3].base = trailer;
+            pkt[3].len = 16;
+            const int rounds = 200000;
+
+            // Ի: , , ٿظ
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                size_t pos = 0;
+                for (int f = 0; f < 4; f++) {
+                    memcpy(lin + pos, pkt[f].base, pkt[f].len);
+                    pos += pkt[f].len;
+                }
+                sm4_gcm_encrypt(&ctx, lin, lin, pos, hdr, 20, iov_tag);
+                pos = 0;
+                for (int f = 0; f < 4; f++) {
+                    memcpy(pkt[f].base, lin + pos, pkt[f].len);
+                    pos += pkt[f].len;
+                }
+            }
+            end = clock();
+            double t_lin = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gcm_encrypt_iov(&ctx, pkt, 4, pkt, 4, &hdr_iov, 1, iov_tag);
+            }
+            end = clock();
+            double t_iov = ((double)(end - start)) / CLOCKS_PER_SEC;
+            double mb = (double)(pkt_sizes[k] - 20) * rounds / 1e6;
+            printf("%4dֽڱ: Ի %.2f MB/s, ɢ/ۼ %.2f MB/s\n",
+                (int)pkt_sizes[k], mb / t_lin, mb / t_iov);
+        }
+    }
+
+    // 11. ԿԤɳ: 밴 iv_base ^ seq  sm4_gcm_encrypt һ
+    //     (δС max_len ŵ); ٱȽֵ߲ĺʱ
+    {
+        static uint8_t msg[2000], ct[2000], ref_ct[2000];
+        const uint8_t iv_base[12] = { 0x10, 0x20, 0x30, 0x40, 0x50, 0x60,
+            0x70, 0x80, 0x90, 0xa0, 0xb0, 0xc0 };
+        const size_t lens[] = { 0, 100, 512, 700, 1500, 16, 33, 2000, 64, 511 };
+        uint8_t ks_tag[SM4_GCM_TAG_SIZE], ref_tag2[SM4_GCM_TAG_SIZE];
+        sm4_gcm_ks_pool* tx = sm4_gcm_ks_create(&gkey, iv_base, 5, 2, 512);
+        sm4_gcm_ks_pool* rx = sm4_gcm_ks_create(&gkey, iv_base, 5, 4, 512);
+        sm4_gcm_ks_stats st;
+        int ks_ok = 1;
+        for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i * 13 + 7);
+
+        for (int i = 0; i < 10; i++) {
+            uint8_t iv2[12];
+            uint64_t seq, seq2;
+            // 34ǰ, ֻ2, 4δ
+            if (i != 3 && i != 4) {
+                sm4_gcm_ks_fill(tx, 0);
+            }
+            if (i % 2 == 0) {
+                sm4_gcm_ks_fill(rx, 2);
+            }
+            ks_ok = ks_ok && sm4_gcm_ks_encrypt(tx, ct, msg, lens[i], aad, sizeof(aad),
+                ks_tag, &seq) == 0;
+            memcpy(iv2, iv_base, 12);
+            for (int b = 0; b < 8; b++) iv2[4 + b] ^= (uint8_t)(seq >> (56 - 8 * b));
+            sm4_gcm_init(&ctx, &gkey, iv2, 12);
+            sm4_gcm_encrypt(&ctx, ref_ct, msg, lens[i], aad, sizeof(aad), ref_tag2);
+            ks_ok = ks_ok && seq == (uint64_t)(5 + i) &&
+                memcmp(ct, ref_ct, lens[i]) == 0 && memcmp(ks_tag, ref_tag2, 16) == 0;
+            if (i == 7) {
+                ks_tag[0] ^= 1;
+            }
+            int ret = sm4_gcm_ks_decrypt(rx, ct, ct, lens[i], aad, sizeof(aad), ks_tag, &seq2);
+            if (i == 7) {
+                ks_ok = ks_ok && ret == -1 && ct[0] == 0 && ct[lens[i] - 1] == 0;
+            }
+            else {
+                ks_ok = ks_ok && ret == 0 && memcmp(ct, msg, lens[i]) == 0;
+            }
+            ks_ok = ks_ok && seq2 == seq;
+        }
+        sm4_gcm_ks_get_stats(tx, &st);
+        ks_ok = ks_ok && st.hits == 9 && st.misses == 1 && st.partial == 2;
+        printf("Կ: %s (Ͷ  %llu, δ %llu,  %llu,  %llu,  %llu)\n",
+            ks_ok ? "ͨ" : "ʧ", (unsigned long long)st.hits,
+            (unsigned long long)st.misses, (unsigned long long)st.partial,
+            (unsigned long long)st.dropped, (unsigned long long)st.generated);
+        sm4_gcm_ks_destroy(tx);
+        sm4_gcm_ks_destroy(rx);
+
+        // ߺʱ: Ԥɷڼʱ֮, ൱ڿʱ
+        const size_t sizes[] = { 64, 256, 1024, 1500 };
+        for (int k = 0; k < 4; k++) {
+            const int depth = 64, rounds = 2000;
+            sm4_gcm_ks_pool* pool = sm4_gcm_ks_create(&gkey, iv_base, 0, depth, sizes[k]);
+            clock_t t_online = 0, t_fill = 0;
+            start = clock();
+            for (int r = 0; r < rounds * depth; r++) {
+                sm4_gcm_init(&ctx, &gkey, iv_base, 12);
+                sm4_gcm_encrypt(&ctx, ct, msg, sizes[k], aad, sizeof(aad), ks_tag);
+            }
+            end = clock();
+            double t_plain = ((double)(end - start)) / CLOCKS_PER_SEC;
+            for (int r = 0; r < rounds; r++) {
+                start = clock();
+                sm4_gcm_ks_fill(pool, 0);
+                end = clock();
+                t_fill += end - start;
+                start = end;
+                for (int m = 0; m < depth; m++) {
+                    sm4_gcm_ks_encrypt(pool, ct, msg, sizes[k], aad, sizeof(aad), ks_tag, NULL);
+                }
+                t_online += clock() - start;
+            }
+            double n = (double)rounds * depth;
+            printf("%4dֽϢ: ͨ %.3f us/, ߲ %.3f us/ (Ԥ %.3f us/)\n",
+                (int)sizes[k], t_plain / n * 1e6, (double)t_online / CLOCKS_PER_SEC / n * 1e6,
+                (double)t_fill / CLOCKS_PER_SEC / n * 1e6);
+            sm4_gcm_ks_destroy(pool);
+        }
+
+        // ̨߳: ʹ÷̶෢, ͳ
+        {
+            sm4_gcm_ks_pool* pool = sm4_gcm_ks_create(&gkey, iv_base, 0, 32, 1024);
+            std::atomic<bool> stop(false);
+            std::thread filler([&]() {
+                while (!stop.load()) {
+                    if (sm4_gcm_ks_fill(pool, 0) == 0) std::this_thread::yield();
+                }
+            });
+            for (int m = 0; m < 20000; m++) {
+                sm4_gcm_ks_encrypt(pool, ct, msg, 1024, aad, sizeof(aad), ks_tag, NULL);
+                if (m % 16 == 0) std::this_thread::yield();
+            }
+            stop.store(true);
+            filler.join();
+            sm4_gcm_ks_get_stats(pool, &st);
+            printf("̨:  %llu, δ %llu,  %llu\n",
+                (unsigned long long)st.hits, (unsigned long long)st.misses,
+                (unsigned long long)st.dropped);
+            sm4_gcm_ks_destroy(pool);
+        }
+    }
+
+    // 12. SM4-GCM-SIV: POLYVALRFC 8452, CLMULһ, ȷ, ۸ʧ;
+    //     GCMȽϲͬµ
+    {
+        static uint8_t msg[1200], siv_ct[1200], siv_ct2[1200], siv_pt[1200];
+        const uint8_t nonce[SM4_GCM_SIV_NONCE_SIZE] = { 0x03, 0x01, 0x04, 0x01, 0x05, 0x09,
+            0x02, 0x06, 0x05, 0x03, 0x05, 0x08 };
+        uint8_t siv_tag[16], siv_tag2[16];
+        sm4_gcm_key tkey = gkey;
+        int siv_ok = 1;
+        sm4_gcm_set_ghash(&tkey, SM4_GHASH_TABLE);
+        // RFC 8452 ¼A  POLYVAL , ʵָһ
+        const uint8_t pv_h[16] = { 0x25, 0x62, 0x93, 0x47, 0x58, 0x92, 0x42, 0x76,
+            0x1d, 0x31, 0xf8, 0x26, 0xba, 0x4b, 0x75, 0x7b };
+        const uint8_t pv_x[32] = { 0x4f, 0x4f, 0x95, 0x66, 0x8c, 0x83, 0xdf, 0xb6,
+            0x40, 0x17, 0x62, 0xbb, 0x2d, 0x01, 0xa2, 0x62, 0xd1, 0xa2, 0x4d, 0xdd,
+            0x27, 0x21, 0xd0, 0x06, 0xbb, 0xe4, 0x5f, 0x20, 0xd3, 0xc9, 0xf3, 0x62 };
+        const uint8_t pv_expect[16] = { 0xf7, 0xa3, 0xb4, 0x7b, 0x84, 0x61, 0x19, 0xfa,
+            0xe5, 0xb7, 0x86, 0x6c, 0xf5, 0xe5, 0xb7, 0x7e };
+        uint8_t pv_out[16];
+        siv_ok = sm4_polyval(pv_h, pv_x, sizeof(pv_x), SM4_GHASH_TABLE, pv_out) == 0 &&
+            memcmp(pv_out, pv_expect, 16) == 0;
+        if (sm4_polyval(pv_h, pv_x, sizeof(pv_x), SM4_GHASH_CLMUL, pv_out) == 0) {
+            siv_ok = siv_ok && memcmp(pv_out, pv_expect, 16) == 0;
+        }
+        for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i * 29 + 3);
+        for (size_t len = 0; len <= sizeof(msg); len += (len < 48) ? 1 : 97) {
+            size_t alen = len % sizeof(aad);
+            sm4_gcm_siv_encrypt(&gkey, nonce, siv_ct, msg, len, aad, alen, siv_tag);
+            sm4_gcm_siv_encrypt(&tkey, nonce, siv_ct2, msg, len, aad, alen, siv_tag2);
+            siv_ok = siv_ok && memcmp(siv_ct, siv_ct2, len) == 0 &&
+                memcmp(siv_tag, siv_tag2, 16) == 0;
+            siv_ok = siv_ok && sm4_gcm_siv_decrypt(&gkey, nonce, siv_pt, siv_ct, len, aad, alen,
+                siv_tag) == 0 && memcmp(siv_pt, msg, len) == 0;
+            siv_tag[len % 16] ^= 0x01;
+            siv_ok = siv_ok && sm4_gcm_siv_decrypt(&gkey, nonce, siv_ct, siv_ct, len, aad, alen,
+                siv_tag) == -1;
+        }
+        // nonceظ: ֻһֽ, ǰҲͬ(GCM»ͬ)
+        sm4_gcm_siv_encrypt(&gkey, nonce, siv_ct, msg, 64, aad, sizeof(aad), siv_tag);
+        msg[63] ^= 1;
+        sm4_gcm_siv_encrypt(&gkey, nonce, siv_ct2, msg, 64, aad, sizeof(aad), siv_tag2);
+        msg[63] ^= 1;
+        siv_ok = siv_ok && memcmp(siv_ct, siv_ct2, 16) != 0;
+        printf("GCM-SIV: %s\n", siv_ok ? "ͨ" : "ʧ");
+
+        const size_t sizes[] = { 64, 1024, 16384, 1 << 20 };
+        static uint8_t big[1 << 20];
+        for (int k = 0; k < 4; k++) {
+            size_t len = sizes[k];
+            int rounds = (int)((256 << 20) / len);
+            if (rounds > 500000) rounds = 500000;
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gcm_init(&ctx, &gkey, nonce, 12);
+                sm4_gcm_encrypt(&ctx, big, big, len, aad, sizeof(aad), siv_tag);
+            }
+            end = clock();
+            double t_gcm = ((double)(end - start)) / CLOCKS_PER_SEC;
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gcm_siv_encrypt(&gkey, nonce, big, big, len, aad, sizeof(aad), siv_tag);
+            }
+            end = clock();
+            double t_siv = ((double)(end - start)) / CLOCKS_PER_SEC;
+            double mb = (double)len * rounds / (1024 * 1024);
+            printf("%7dֽ: GCM %.2f MB/s, GCM-SIV %.2f MB/s (%.2f ʱ)\n",
+                (int)len, mb / t_gcm, mb / t_siv, t_siv / t_gcm);
+        }
+    }
+
+    // 13. GMAC: ΪյGCMǩһ; "GCM"÷ȽϺʱ
+    {
+        static uint8_t data[4096];
+        uint8_t gmac_tag[16], gcm_tag[16];
+        int gmac_ok = 1;
+        for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 17 + 5);
+        for (size_t len = 0; len <= 300; len += 13) {
+            size_t ivl = (len % 3 == 0) ? 16 : 12;
+            sm4_gmac(&gkey, data + 1000, ivl, data, len, gmac_tag);
+            sm4_gcm_init(&ctx, &gkey, data + 1000, ivl);
+            sm4_gcm_encrypt(&ctx, NULL, NULL, 0, data, len, gcm_tag);
+            gmac_ok = gmac_ok && memcmp(gmac_tag, gcm_tag, 16) == 0 &&
+                sm4_gmac_verify(&gkey, data + 1000, ivl, data, len, gmac_tag) == 0;
+            gmac_tag[len % 16] ^= 0x40;
+            gmac_ok = gmac_ok && sm4_gmac_verify(&gkey, data + 1000, ivl, data, len,
+                gmac_tag) == -1;
+        }
+        printf("GMAC: %s\n", gmac_ok ? "ͨ" : "ʧ");
+
+        const size_t sizes[] = { 64, 1024, 4096 };
+        for (int k = 0; k < 3; k++) {
+            const int rounds = 500000;
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gcm_init(&ctx, &gkey, iv, sizeof(iv));
+                sm4_gcm_encrypt(&ctx, NULL, NULL, 0, data, sizes[k], gcm_tag);
+            }
+            end = clock();
+            double t_gcm = ((double)(end - start)) / CLOCKS_PER_SEC;
+            start = clock();
+            for (int r = 0; r < rounds; r++) {
+                sm4_gmac(&gkey, iv, sizeof(iv), data, sizes[k], gmac_tag);
+            }
+            end = clock();
+            double t_gmac = ((double)(end - start)) / CLOCKS_PER_SEC;
+            printf("%4dֽGMAC: GCM %.3f us/, sm4_gmac %.3f us/\n", (int)sizes[k],
+                t_gcm / rounds * 1e6, t_gmac / rounds * 1e6);
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "sm4_gcm_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+// :
+//   test_sm4_gcm_file enc  <32λʮԿ> <ļ> <ļ> [鳤]
+//   test_sm4_gcm_file dec  <32λʮԿ> <ļ> <ļ>
+//   test_sm4_gcm_file read <32λʮԿ> <ļ> <ƫ> <>   (stdout)
+// ʱԲ
+
+static int parse_key(const char* hex, uint8_t key[SM4_KEY_SIZE]) {
+    if (strlen(hex) != 2 * SM4_KEY_SIZE) return -1;
+    for (int i = 0; i < SM4_KEY_SIZE; i++) {
+        unsigned int b;
+        if (sscanf(hex + 2 * i, "%2x", &b) != 1) return -1;
+        key[i] = (uint8_t)b;
+    }
+    return 0;
+}
+
+static int run_cli(int argc, char** argv) {
+    uint8_t key[SM4_KEY_SIZE];
+    sm4_gcm_key gkey;
+    if (argc < 5 || parse_key(argv[2], key) != 0) {
+        fprintf(stderr, "\n");
+        return 2;
+    }
+    sm4_gcm_key_init(&gkey, key);
+    if (strcmp(argv[1], "enc") == 0) {
+        uint32_t chunk = (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 0) : SM4_GCMF_DEFAULT_CHUNK;
+        if (sm4_gcmf_encrypt_file(&gkey, argv[3], argv[4], chunk, 0) != 0) {
+            fprintf(stderr, "ʧ\n");
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "dec") == 0) {
+        if (sm4_gcmf_decrypt_file(&gkey, argv[3], argv[4], 0) != 0) {
+            fprintf(stderr, "ʧ: ʽ֤ʧ\n");
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "read") == 0 && argc > 5) {
+        sm4_gcmf_file* f = sm4_gcmf_open(&gkey, argv[3]);
+        size_t len = (size_t)strtoull(argv[5], NULL, 0);
+        std::vector<uint8_t> buf(len);
+        if (f == NULL || sm4_gcmf_read(f, strtoull(argv[4], NULL, 0), buf.data(), len) != 0) {
+            fprintf(stderr, "ȡʧ: Խ硢ʽ֤ʧ\n");
+            if (f != NULL) sm4_gcmf_close(f);
+            return 1;
+        }
+        fwrite(buf.data(), 1, len, stdout);
+        sm4_gcmf_close(f);
+        return 0;
+    }
+    fprintf(stderr, "δ֪ %s\n", argv[1]);
+    return 2;
+}
+
+static int write_file(const char* path, const uint8_t* data, size_t len) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return -1;
+    // ļ fwrite, data Ϊ NULL
+    size_t n = (len > 0) ? fwrite(data, 1, len, fp) : 0;
+    fclose(fp);
+    return n == len ? 0 : -1;
+}
+
+static std::vector<uint8_t> read_file(const char* path) {
+    std::vector<uint8_t> data;
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(fp);
+    return data;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return run_cli(argc, argv);
+    }
+
+    uint8_t key[SM4_KEY_SIZE] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    const uint8_t nonce[SM4_GCMF_NONCE_SIZE] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const uint32_t chunk = 4096;
+    sm4_gcm_key gkey;
+    sm4_gcm_key_init(&gkey, key);
+
+    // 1. ڴӿ: ӽ, ⷶΧȡһ
+    const size_t plain_len = 10 * 4096 + 123;
+    std::vector<uint8_t> plain(plain_len), dec(plain_len), part(3 * 4096 + 1000);
+    for (size_t i = 0; i < plain_len; i++) plain[i] = (uint8_t)(i * 13 + (i >> 8));
+    uint64_t enc_len = sm4_gcmf_encrypted_size(plain_len, chunk);
+    std::vector<uint8_t> enc(enc_len);
+    sm4_gcmf_encrypt_buffer(&gkey, nonce, chunk, plain.data(), plain_len, enc.data(), 2);
+    int ok = sm4_gcmf_decrypt_buffer(&gkey, enc.data(), enc_len, dec.data(), 2) == 0 &&
+        dec == plain;
+    const size_t ranges[][2] = { { 0, 1 }, { 4095, 2 }, { 100, 4096 }, { 8192, 8192 },
+        { 5000, 3 * 4096 + 1000 }, { plain_len - 123, 123 }, { plain_len, 0 } };
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        ok = ok && sm4_gcmf_read_range(&gkey, enc.data(), enc_len, ranges[r][0], part.data(),
+            ranges[r][1]) == 0 && memcmp(part.data(), plain.data() + ranges[r][0],
+                ranges[r][1]) == 0;
+    }
+    ok = ok && sm4_gcmf_read_range(&gkey, enc.data(), enc_len, plain_len - 10, part.data(),
+        11) == -1;
+    printf("ڴӿȡ: %s\n", ok ? "ͨ" : "ʧ");
+
+    // 2. ۸: 顢ضϡļͷеĳȡ, 뱻
+    {
+        std::vector<uint8_t> bad = enc;
+        size_t stride = chunk + SM4_GCM_TAG_SIZE;
+        int tamper_ok = 1;
+        std::vector<uint8_t> tmp(bad.begin() + SM4_GCMF_HEADER_SIZE,
+            bad.begin() + SM4_GCMF_HEADER_SIZE + stride);
+        memcpy(&bad[SM4_GCMF_HEADER_SIZE], &bad[SM4_GCMF_HEADER_SIZE + stride], stride);
+        memcpy(&bad[SM4_GCMF_HEADER_SIZE + stride], tmp.data(), stride);
+        tamper_ok = tamper_ok &&
+            sm4_gcmf_decrypt_buffer(&gkey, bad.data(), bad.size(), dec.data(), 1) == -1 &&
+            sm4_gcmf_read_range(&gkey, bad.data(), bad.size(), 0, part.data(), 10) == -1;
+        // صһ, ļͷȸĳ֮
+        bad = enc;
+        bad.resize(SM4_GCMF_HEADER_SIZE + 10 * stride);
+        for (int i = 0; i < 8; i++) bad[16 + i] = (uint8_t)((uint64_t)(10 * chunk) >> (56 - 8 * i));
+        tamper_ok = tamper_ok &&
+            sm4_gcmf_decrypt_buffer(&gkey, bad.data(), bad.size(), dec.data(), 1) == -1;
+        // ֻضϲļͷ
+        tamper_ok = tamper_ok &&
+            sm4_gcmf_decrypt_buffer(&gkey, enc.data(), enc_len - 1, dec.data(), 1) == -1;
+        // αļͷ: 鳤 0xFFFFFFFF, Ϊ, ֻһĩ. ڷ仺ǰܾ
+        bad.assign(SM4_GCMF_HEADER_SIZE + SM4_GCM_TAG_SIZE, 0);
+        memcpy(&bad[0], enc.data(), 8);
+        memset(&bad[8], 0xff, 4);
+        uint64_t forged_plain;
+        uint32_t forged_chunk;
+        tamper_ok = tamper_ok &&
+            sm4_gcmf_parse_header(bad.data(), bad.size(), &forged_plain, &forged_chunk) == -1 &&
+            sm4_gcmf_read_range(&gkey, bad.data(), bad.size(), 0, part.data(), 0) == -1;
+        bad = enc;
+        bad[SM4_GCMF_HEADER_SIZE + 3 * stride + 7] ^= 1;
+        tamper_ok = tamper_ok &&
+            sm4_gcmf_read_range(&gkey, bad.data(), bad.size(), 3 * chunk, part.data(), 1) == -1 &&
+            sm4_gcmf_read_range(&gkey, bad.data(), bad.size(), 2 * chunk, part.data(), chunk) == 0;
+        printf("۸ļ: %s\n", tamper_ok ? "ͨ" : "ʧ");
+    }
+
+    // 3. ļӿ(ڴӳ): ܡܡ, ļ
+    {
+        const char* pt_path = "sm4_gcmf_plain.tmp";
+        const char* ct_path = "sm4_gcmf_cipher.tmp";
+        const char* out_path = "sm4_gcmf_out.tmp";
+        int file_ok = write_file(pt_path, plain.data(), plain_len) == 0 &&
+            sm4_gcmf_encrypt_file(&gkey, pt_path, ct_path, chunk, 0) == 0 &&
+            sm4_gcmf_decrypt_file(&gkey, ct_path, out_path, 0) == 0 &&
+            read_file(out_path) == plain;
+        sm4_gcmf_file* f = sm4_gcmf_open(&gkey, ct_path);
+        file_ok = file_ok && f != NULL && sm4_gcmf_size(f) == plain_len;
+        for (size_t off = 0; file_ok && off + 100 < plain_len; off += 997) {
+            file_ok = sm4_gcmf_read(f, off, part.data(), 100) == 0 &&
+                memcmp(part.data(), plain.data() + off, 100) == 0;
+        }
+        if (f != NULL) sm4_gcmf_close(f);
+        file_ok = file_ok && write_file(pt_path, NULL, 0) == 0 &&
+            sm4_gcmf_encrypt_file(&gkey, pt_path, ct_path, chunk, 0) == 0 &&
+            sm4_gcmf_decrypt_file(&gkey, ct_path, out_path, 0) == 0 &&
+            read_file(out_path).empty();
+        remove(pt_path);
+        remove(ct_path);
+        remove(out_path);
+        printf("ļӿ: %s\n", file_ok ? "ͨ" : "ʧ");
+    }
+
+    // 4. : 64MBӽ, Լ 4KB ܵĿȽ
+    {
+        const size_t big_len = 64 << 20;
+        std::vector<uint8_t> big(big_len), big_out(big_len);
+        uint64_t big_enc_len = sm4_gcmf_encrypted_size(big_len, SM4_GCMF_DEFAULT_CHUNK);
+        std::vector<uint8_t> big_enc(big_enc_len);
+        clock_t start = clock();
+        sm4_gcmf_encrypt_buffer(&gkey, nonce, SM4_GCMF_DEFAULT_CHUNK, big.data(), big_len,
+            big_enc.data(), 0);
+        clock_t mid = clock();
+        sm4_gcmf_decrypt_buffer(&gkey, big_enc.data(), big_enc_len, big_out.data(), 0);
+        clock_t end = clock();
+        double t_dec = (double)(end - mid) / CLOCKS_PER_SEC;
+        printf("64MB:  %.2f MB/s,  %.2f MB/s\n",
+            big_len / 1e6 / ((double)(mid - start) / CLOCKS_PER_SEC), big_len / 1e6 / t_dec);
+
+        const int reads = 2000;
+        start = clock();
+        for (int r = 0; r < reads; r++) {
+            uint64_t off = ((uint64_t)r * 7919 * 4096) % (big_len - 4096);
+            sm4_gcmf_read_range(&gkey, big_enc.data(), big_enc_len, off, part.data(), 4096);
+        }
+        end = clock();
+        printf("4KB: ƽ %.1f ΢ ( %.1f )\n",
+            (double)(end - start) / CLOCKS_PER_SEC / reads * 1e6, t_dec * 1e3);
+    }
+
+    return 0;
+}
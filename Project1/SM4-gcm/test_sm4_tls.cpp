@@ -0,0 +1,239 @@
+#include "sm4_tls.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+// ¼ʾ: ֹƴ nonce/AAD/¼ͷ sm4_gcm_encrypt Ľֽڱȶ,
+// ٲװ֡ʹ۸ļ, Ƚ16KB1KB¼
+
+static const uint8_t test_key[16] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+static const uint8_t test_iv[12] = {
+    0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab };
+
+static void fill(uint8_t* p, size_t n, unsigned int seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        p[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+// ֹƴװһ¼ (ԭȵ): ĸƵ, ƴͷͱǩ
+static size_t manual_seal(const sm4_gcm_key* key, int version, uint64_t seq,
+    const uint8_t* plain, size_t len, uint8_t type, size_t pad, uint8_t* out) {
+    std::vector<uint8_t> inner(len + 1 + pad, 0);
+    uint8_t nonce[12], aad[13], tag[16];
+    sm4_gcm_ctx ctx;
+    memcpy(nonce, test_iv, 12);
+    if (version == SM4_TLS_VERSION_13) {
+        for (int i = 0; i < 8; i++) nonce[11 - i] ^= (uint8_t)(seq >> (8 * i));
+        memcpy(inner.data(), plain, len);
+        inner[len] = type;
+        size_t payload = inner.size() + 16;
+        uint8_t hdr[5] = { 23, 0x03, 0x03, (uint8_t)(payload >> 8), (uint8_t)payload };
+        memcpy(out, hdr, 5);
+        sm4_gcm_init(&ctx, key, nonce, 12);
+        sm4_gcm_encrypt(&ctx, out + 5, inner.data(), inner.size(), hdr, 5, tag);
+        memcpy(out + 5 + inner.size(), tag, 16);
+        return 5 + payload;
+    }
+    for (int i = 0; i < 8; i++) nonce[11 - i] = (uint8_t)(seq >> (8 * i));
+    for (int i = 0; i < 8; i++) aad[7 - i] = (uint8_t)(seq >> (8 * i));
+    aad[8] = type; aad[9] = 0x01; aad[10] = 0x01;
+    aad[11] = (uint8_t)(len >> 8); aad[12] = (uint8_t)len;
+    size_t payload = 8 + len + 16;
+    out[0] = type; out[1] = 0x01; out[2] = 0x01;
+    out[3] = (uint8_t)(payload >> 8); out[4] = (uint8_t)payload;
+    memcpy(out + 5, nonce + 4, 8);
+    sm4_gcm_init(&ctx, key, nonce, 12);
+    sm4_gcm_encrypt(&ctx, out + 13, plain, len, aad, 13, tag);
+    memcpy(out + 13 + len, tag, 16);
+    return 5 + payload;
+}
+
+// װֹһ, ⿪ĺȷ, ۸/Ŵλܾ
+static int check_single(int version) {
+    const size_t lens[] = { 0, 1, 15, 16, 17, 255, 1000, 4096, SM4_TLS_MAX_PLAINTEXT };
+    const size_t pads[] = { 0, 3, 0, 16, 0, 7, 0, 100, 0 };
+    sm4_gcm_key key;
+    sm4_tls_ctx tx, rx;
+    std::vector<uint8_t> plain(SM4_TLS_MAX_PLAINTEXT), rec(SM4_TLS_MAX_PLAINTEXT + 512),
+        ref(SM4_TLS_MAX_PLAINTEXT + 512);
+    int ok = 1;
+
+    sm4_gcm_key_init(&key, test_key);
+    sm4_tls_init(&tx, version, test_key, test_iv, version == SM4_TLS_VERSION_13 ? 12 : 4);
+    sm4_tls_init(&rx, version, test_key, test_iv, version == SM4_TLS_VERSION_13 ? 12 : 4);
+    size_t head = sm4_tls_headroom(&tx);
+    for (size_t t = 0; t < sizeof(lens) / sizeof(lens[0]); t++) {
+        size_t len = lens[t];
+        uint8_t type = (t % 2) ? SM4_TLS_CT_HANDSHAKE : SM4_TLS_CT_APPLICATION_DATA;
+        uint8_t got_type = 0;
+        fill(plain.data(), len, (unsigned int)t);
+        memcpy(rec.data() + head, plain.data(), len);
+        int n = sm4_tls_seal(&tx, rec.data(), len, type, pads[t]);
+        size_t m = manual_seal(&key, version, t, plain.data(), len, type, pads[t], ref.data());
+        ok = ok && n > 0 && (size_t)n == m && memcmp(rec.data(), ref.data(), m) == 0;
+        ok = ok && sm4_tls_record_size(&rx, rec.data(), n) == n;
+        if (t == 4) {
+            // һֽ: ʧŲ, ֮ԭ¼ܽ⿪
+            rec[head + 2] ^= 1;
+            ok = ok && sm4_tls_open(&rx, rec.data(), n, &got_type) == -1;
+            memcpy(rec.data(), ref.data(), m);
+        }
+        ok = ok && sm4_tls_open(&rx, rec.data(), n, &got_type) == (int)len &&
+            got_type == type && memcmp(rec.data() + head, plain.data(), len) == 0;
+    }
+    // , ԼնŴλ
+    ok = ok && sm4_tls_seal(&tx, rec.data(), SM4_TLS_MAX_PLAINTEXT + 1, 23, 0) == -1;
+    int n = sm4_tls_seal(&tx, rec.data(), 100, 23, 0);
+    rx.seq++;
+    uint8_t got_type;
+    ok = ok && sm4_tls_open(&rx, rec.data(), n, &got_type) == -1;
+    sm4_tls_cleanup(&tx);
+    sm4_tls_cleanup(&rx);
+    return ok;
+}
+
+// װװֽͬ; ¼βӷŽһ, ֡ԭؽ⿪
+static int check_batch(int version) {
+    const size_t count = 70;
+    sm4_tls_ctx a, b, rx;
+    std::vector<uint8_t> stream, ref;
+    std::vector<sm4_tls_record> recs(count);
+    std::vector<size_t> offs(count), lens(count);
+    int ok = 1;
+
+    size_t iv_len = (version == SM4_TLS_VERSION_13) ? 12 : 4;
+    sm4_tls_init(&a, version, test_key, test_iv, iv_len);
+    sm4_tls_init(&b, version, test_key, test_iv, iv_len);
+    sm4_tls_init(&rx, version, test_key, test_iv, iv_len);
+    a.seq = b.seq = rx.seq = 1000;
+    size_t head = sm4_tls_headroom(&a);
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        lens[i] = (i * 211) % 1500;
+        offs[i] = total;
+        total += head + lens[i] + sm4_tls_tailroom(&a, i % 5);
+    }
+    stream.resize(total);
+    ref.resize(total);
+    for (size_t i = 0; i < count; i++) {
+        fill(&stream[offs[i] + head], lens[i], (unsigned int)i);
+        memcpy(&ref[offs[i] + head], &stream[offs[i] + head], lens[i]);
+        recs[i].rec = &stream[offs[i]];
+        recs[i].len = lens[i];
+        recs[i].type = SM4_TLS_CT_APPLICATION_DATA;
+        recs[i].pad = i % 5;
+        int n = sm4_tls_seal(&b, &ref[offs[i]], lens[i], SM4_TLS_CT_APPLICATION_DATA, i % 5);
+        ok = ok && n == (int)(head + lens[i] + sm4_tls_tailroom(&a, i % 5));
+    }
+    ok = ok && sm4_tls_seal_batch(&a, recs.data(), count) == 0 && a.seq == b.seq &&
+        stream == ref;
+
+    // ¼Ѱʵʳź, ûп϶
+    size_t pos = 0, i = 0;
+    while (pos < total && ok) {
+        uint8_t type;
+        int size = sm4_tls_record_size(&rx, &stream[pos], total - pos);
+        ok = size > 0 && recs[i].rec_len == size &&
+            sm4_tls_open(&rx, &stream[pos], size, &type) == (int)lens[i];
+        fill(&ref[0], lens[i], (unsigned int)i);
+        ok = ok && memcmp(&stream[pos + head], &ref[0], lens[i]) == 0;
+        pos += size;
+        i++;
+    }
+    ok = ok && i == count && sm4_tls_record_size(&rx, &stream[0], 3) == 0;
+
+    // һʱ
+    recs[10].len = SM4_TLS_MAX_PLAINTEXT + 1;
+    uint64_t seq = a.seq;
+    ok = ok && sm4_tls_seal_batch(&a, recs.data(), count) == -1 && a.seq == seq;
+    return ok;
+}
+
+static void bench(int version, size_t rec_size, size_t nrec) {
+    sm4_gcm_key key;
+    sm4_tls_ctx tx, rx;
+    size_t iv_len = (version == SM4_TLS_VERSION_13) ? 12 : 4;
+    const size_t per_call = 64;
+    clock_t start, end;
+    double mb;
+
+    sm4_gcm_key_init(&key, test_key);
+    sm4_tls_init(&tx, version, test_key, test_iv, iv_len);
+    sm4_tls_init(&rx, version, test_key, test_iv, iv_len);
+    size_t stride = sm4_tls_headroom(&tx) + rec_size + sm4_tls_tailroom(&tx, 0);
+    std::vector<uint8_t> buf(stride * per_call), plain(rec_size), out(stride);
+    std::vector<sm4_tls_record> recs(per_call);
+    fill(plain.data(), rec_size, 7);
+    for (size_t i = 0; i < per_call; i++) {
+        recs[i].rec = &buf[i * stride];
+        recs[i].len = rec_size;
+        recs[i].type = SM4_TLS_CT_APPLICATION_DATA;
+        recs[i].pad = 0;
+    }
+    mb = (double)rec_size * nrec / (1024 * 1024);
+    printf("%s %zuֽڼ¼:\n", version == SM4_TLS_VERSION_13 ? "TLS 1.3" : "TLCP", rec_size);
+
+    start = clock();
+    for (size_t i = 0; i < nrec; i++) {
+        manual_seal(&key, version, i, plain.data(), rec_size, 23, 0, out.data());
+    }
+    end = clock();
+    printf("  ֹƴװ+   : %.2f MB/s\n", mb / ((double)(end - start) / CLOCKS_PER_SEC));
+
+    start = clock();
+    for (size_t i = 0; i < nrec; i++) {
+        sm4_tls_seal(&tx, &buf[0], rec_size, 23, 0);
+    }
+    end = clock();
+    printf("  ԭطװ        : %.2f MB/s\n", mb / ((double)(end - start) / CLOCKS_PER_SEC));
+
+    start = clock();
+    for (size_t i = 0; i < nrec; i += per_call) {
+        sm4_tls_seal_batch(&tx, recs.data(), per_call);
+    }
+    end = clock();
+    printf("  װ(%zu/): %.2f MB/s\n", per_call,
+        mb / ((double)(end - start) / CLOCKS_PER_SEC));
+
+    // ⿪ǺϷ¼: ȷװһ, ÿָƻȥ⿪ (Ƽʱ)
+    std::vector<uint8_t> sealed(buf.size());
+    sm4_tls_ctx tx2;
+    sm4_tls_init(&tx2, version, test_key, test_iv, iv_len);
+    uint8_t type;
+    start = clock();
+    for (size_t i = 0; i < nrec; i += per_call) {
+        if (i == 0) {
+            sm4_tls_seal_batch(&tx2, recs.data(), per_call);
+            memcpy(sealed.data(), buf.data(), buf.size());
+        }
+        else {
+            memcpy(buf.data(), sealed.data(), buf.size());
+        }
+        rx.seq = 0;
+        for (size_t j = 0; j < per_call; j++) {
+            sm4_tls_open(&rx, recs[j].rec, recs[j].rec_len, &type);
+        }
+    }
+    end = clock();
+    printf("  ԭؽ⿪        : %.2f MB/s\n", mb / ((double)(end - start) / CLOCKS_PER_SEC));
+}
+
+int main() {
+    printf("TLS 1.3 װ/⿪: %s\n", check_single(SM4_TLS_VERSION_13) ? "ͨ" : "ʧ");
+    printf("TLCP װ/⿪: %s\n", check_single(SM4_TLS_VERSION_TLCP) ? "ͨ" : "ʧ");
+    printf("TLS 1.3 װ֡: %s\n", check_batch(SM4_TLS_VERSION_13) ? "ͨ" : "ʧ");
+    printf("TLCP װ֡: %s\n", check_batch(SM4_TLS_VERSION_TLCP) ? "ͨ" : "ʧ");
+
+    printf("SM4: %s\n", SM4_BackendName(SM4_Backend()));
+    bench(SM4_TLS_VERSION_13, 16384, 4096);
+    bench(SM4_TLS_VERSION_13, 1024, 65536);
+    bench(SM4_TLS_VERSION_TLCP, 16384, 4096);
+    bench(SM4_TLS_VERSION_TLCP, 1024, 65536);
+    return 0;
+}
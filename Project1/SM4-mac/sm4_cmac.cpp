@@ -0,0 +1,145 @@
+#include "sm4_cmac.h"
+#include <string.h>
+#include <immintrin.h>
+
+// GF(2^128) ϳ x: 1λ, ƳλΪ1ʱֽ 0x87
+static void cmac_dbl(const uint8_t* in, uint8_t* out) {
+    uint8_t carry = in[0] >> 7;
+    for (int i = 0; i < 15; i++) {
+        out[i] = (uint8_t)((in[i] << 1) | (in[i + 1] >> 7));
+    }
+    out[15] = (uint8_t)((in[15] << 1) ^ (carry ? 0x87 : 0));
+}
+
+void sm4_cmac_key_init(sm4_cmac_key* ckey, const SM4_Key* key) {
+    uint8_t L[16] = { 0 };
+    ckey->key = key;
+    sm4_ecb_encrypt_blocks(key, L, L, 1);
+    cmac_dbl(L, ckey->K1);
+    cmac_dbl(ckey->K1, ckey->K2);
+}
+
+// һϢ CMAC ״̬: CBC ֵʣ, ĩڳʼʱͱ
+typedef struct {
+    sm4_cmac_msg* msg;
+    size_t nblocks;         // , Ϣһ
+    size_t next;            // һҪյķ
+    uint8_t last[16];       // ĩ:  K1 λ K2
+    uint8_t Y[16];          // ֵ
+} cmac_lane;
+
+static void cmac_lane_init(const sm4_cmac_key* ckey, cmac_lane* c, sm4_cmac_msg* msg) {
+    size_t len = msg->len;
+    size_t rem = len % 16;
+    c->msg = msg;
+    c->nblocks = (len == 0) ? 1 : (len + 15) / 16;
+    c->next = 0;
+    memset(c->Y, 0, 16);
+    if (len > 0 && rem == 0) {
+        for (int i = 0; i < 16; i++) {
+            c->last[i] = msg->msg[len - 16 + i] ^ ckey->K1[i];
+        }
+        return;
+    }
+    memset(c->last, 0, 16);
+    if (rem) {
+        memcpy(c->last, msg->msg + len - rem, rem);
+    }
+    c->last[rem] = 0x80;
+    for (int i = 0; i < 16; i++) {
+        c->last[i] ^= ckey->K2[i];
+    }
+}
+
+// ͨһܷ Y ^ M_i
+static void cmac_lane_block(cmac_lane* c, uint8_t* blk) {
+    const uint8_t* m = (c->next + 1 == c->nblocks) ? c->last : c->msg->msg + 16 * c->next;
+    _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(
+        _mm_loadu_si128((const __m128i*)c->Y), _mm_loadu_si128((const __m128i*)m)));
+    c->next++;
+}
+
+// ȶʱǰ˳
+static int cmac_finish(const cmac_lane* c, size_t tag_len, int verify) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++) {
+        if (verify) diff |= c->Y[i] ^ c->msg->tag[i];
+        else c->msg->tag[i] = c->Y[i];
+    }
+    return diff ? -1 : 0;
+}
+
+// ÿϢռһͨ. CBC , ÿϢÿֻƽһ, һֵ
+// ڻͨ; Ϣһ, ͨ
+static int cmac_run(const sm4_cmac_key* ckey, sm4_cmac_msg* msgs, size_t n, size_t tag_len,
+    int verify) {
+    cmac_lane lanes[16];
+    uint8_t buf[256];
+    int width = SM4_AESNI_Width();
+    int active = 0, failed = 0;
+    size_t next = 0;
+
+    if (tag_len < 1 || tag_len > 16) {
+        return -1;
+    }
+    memset(buf, 0, sizeof(buf));
+    while (active < width && next < n) {
+        cmac_lane_init(ckey, &lanes[active++], &msgs[next++]);
+    }
+    while (active > 0) {
+        for (int l = 0; l < active; l++) {
+            cmac_lane_block(&lanes[l], buf + 16 * l);
+        }
+        // βϢ½ active ں˿, ͨܵһ
+        //  buf еķ, ȡ
+        sm4_ecb_encrypt_blocks(ckey->key, buf, buf, (size_t)sm4_lane_batch((size_t)active));
+        for (int l = 0; l < active;) {
+            cmac_lane* c = &lanes[l];
+            memcpy(c->Y, buf + 16 * l, 16);
+            if (c->next < c->nblocks) {
+                l++;
+                continue;
+            }
+            int r = cmac_finish(c, tag_len, verify);
+            c->msg->result = r;
+            if (r != 0) failed++;
+            // һϢ, ûʱһͨϿλ
+            if (next < n) {
+                cmac_lane_init(ckey, c, &msgs[next++]);
+                l++;
+            }
+            else {
+                lanes[l] = lanes[--active];
+                memcpy(buf + 16 * l, buf + 16 * active, 16);
+            }
+        }
+    }
+    return failed;
+}
+
+int sm4_cmac_batch(const sm4_cmac_key* ckey, sm4_cmac_msg* msgs, size_t n, size_t tag_len) {
+    return cmac_run(ckey, msgs, n, tag_len, 0) < 0 ? -1 : 0;
+}
+
+int sm4_cmac_verify_batch(const sm4_cmac_key* ckey, sm4_cmac_msg* msgs, size_t n,
+    size_t tag_len) {
+    return cmac_run(ckey, msgs, n, tag_len, 1);
+}
+
+int sm4_cmac(const sm4_cmac_key* ckey, const uint8_t* msg, size_t len,
+    uint8_t* tag, size_t tag_len) {
+    sm4_cmac_msg m;
+    m.msg = msg;
+    m.len = len;
+    m.tag = tag;
+    return sm4_cmac_batch(ckey, &m, 1, tag_len);
+}
+
+int sm4_cmac_verify(const sm4_cmac_key* ckey, const uint8_t* msg, size_t len,
+    const uint8_t* tag, size_t tag_len) {
+    sm4_cmac_msg m;
+    m.msg = msg;
+    m.len = len;
+    m.tag = (uint8_t*)tag;  // Уֻǩ
+    return sm4_cmac_verify_batch(ckey, &m, 1, tag_len) == 0 ? 0 : -1;
+}
@@ -0,0 +1,44 @@
+#ifndef SM4_CMAC_H
+#define SM4_CMAC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../SM4-aesni/sm4_aesni.h"
+
+#define SM4_CMAC_TAG_SIZE 16
+
+// SM4-CMAC (NIST SP 800-38B). ֻõ÷ SM4_Key, CCM/GCMȹͬһԿ
+// ( sm4_gcm_key е sm4_key), key ʹڼ䱣Ч
+typedef struct {
+    const SM4_Key* key;
+    uint8_t K1[16];         // ĩʱԿ
+    uint8_t K2[16];         // ĩ鲹 10..0 Կ
+} sm4_cmac_key;
+
+// ӿеһϢ
+typedef struct {
+    const uint8_t* msg;
+    size_t len;
+    uint8_t* tag;           // ʱ, Уʱ
+    int result;             // У: 0 ɹ, -1 
+} sm4_cmac_msg;
+
+//  L = SM4(0^128) Կ, ÿԿһ
+void sm4_cmac_key_init(sm4_cmac_key* ckey, const SM4_Key* key);
+
+// CBC-MACÿϢֻܴ, ϢÿһSM4.
+// tag_len ȡ 1..16, ǩǰ tag_len ֽ; Ϸ-1
+int sm4_cmac(const sm4_cmac_key* ckey, const uint8_t* msg, size_t len,
+    uint8_t* tag, size_t tag_len);
+// ǩ-1
+int sm4_cmac_verify(const sm4_cmac_key* ckey, const uint8_t* msg, size_t len,
+    const uint8_t* tag, size_t tag_len);
+
+// ӿ: ϢCBC-MACռں˵Ĳͬͨƽ, һ
+// һ, ȲͬҲܱͨ.
+// ɷ0, У鷵زϢ; tag_len Ϸʱ-1 (κδ)
+int sm4_cmac_batch(const sm4_cmac_key* ckey, sm4_cmac_msg* msgs, size_t n, size_t tag_len);
+int sm4_cmac_verify_batch(const sm4_cmac_key* ckey, sm4_cmac_msg* msgs, size_t n,
+    size_t tag_len);
+
+#endif // SM4_CMAC_H
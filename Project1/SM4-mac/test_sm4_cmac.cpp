@@ -0,0 +1,99 @@
+#include "sm4_cmac.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void print_hex(const char* label, const uint8_t* data, size_t len) {
+    printf("%s: ", label);
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", data[i]);
+    }
+    printf("\n");
+}
+
+int main() {
+    // 1. : ϢΪ 00 01 02 ...,  0/16/40/64 (OpenSSL SM4-CBC CMAC Ľ)
+    uint8_t key[16] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    const size_t kat_len[4] = { 0, 16, 40, 64 };
+    const uint8_t kat_tag[4][16] = {
+        { 0x29, 0xe1, 0x54, 0x32, 0x2e, 0x5c, 0x7b, 0xd8,
+          0xee, 0x6a, 0x25, 0xba, 0x54, 0x9b, 0x24, 0xbc },
+        { 0x21, 0x53, 0xe9, 0xaa, 0x9d, 0xb6, 0x82, 0x53,
+          0xd0, 0x67, 0x75, 0xc0, 0x34, 0x83, 0xb3, 0xcc },
+        { 0x34, 0x55, 0x6c, 0x65, 0xe5, 0x1b, 0x9a, 0xd7,
+          0x47, 0x14, 0x08, 0x43, 0xd1, 0xc2, 0x03, 0x6c },
+        { 0xc7, 0x98, 0x9b, 0x59, 0x3d, 0x5c, 0xba, 0x8d,
+          0x9c, 0xb2, 0xce, 0xdc, 0x51, 0x5b, 0x4e, 0x88 } };
+    uint8_t msg[64], tag[16];
+    SM4_Key sm4_key;
+    sm4_cmac_key ckey;
+    int ok = 1;
+    for (int i = 0; i < 64; i++) msg[i] = (uint8_t)i;
+    SM4_KeyInit(key, &sm4_key);
+    sm4_cmac_key_init(&ckey, &sm4_key);
+    for (int k = 0; k < 4; k++) {
+        sm4_cmac(&ckey, msg, kat_len[k], tag, 16);
+        print_hex("Tag", tag, 16);
+        ok = ok && memcmp(tag, kat_tag[k], 16) == 0;
+        ok = ok && sm4_cmac_verify(&ckey, msg, kat_len[k], kat_tag[k], 8) == 0;
+    }
+    tag[3] ^= 1;
+    ok = ok && sm4_cmac_verify(&ckey, msg, 64, tag, 16) == -1;
+    ok = ok && sm4_cmac(&ckey, msg, 64, tag, 0) == -1 && sm4_cmac(&ckey, msg, 64, tag, 17) == -1;
+    printf(": %s\n", ok ? "ͨ" : "ʧ");
+
+    // 2. ӿ: ȸͬ(Ϣ), һ; ٴ۸һУ
+    static uint8_t src[100 * 700];
+    static uint8_t tags[100][16], tags_ref[100][16];
+    sm4_cmac_msg msgs[100];
+    for (size_t i = 0; i < sizeof(src); i++) src[i] = (uint8_t)(i * 31 + 7);
+    for (int m = 0; m < 100; m++) {
+        msgs[m].msg = src + m * 700;
+        msgs[m].len = (m % 10 == 0) ? (size_t)m * 4 : (size_t)(m * 97) % 700;
+        msgs[m].tag = tags[m];
+        sm4_cmac(&ckey, msgs[m].msg, msgs[m].len, tags_ref[m], 16);
+    }
+    sm4_cmac_batch(&ckey, msgs, 100, 16);
+    int batch_ok = memcmp(tags, tags_ref, sizeof(tags)) == 0;
+    tags[42][15] ^= 0x80;
+    int failed = sm4_cmac_verify_batch(&ckey, msgs, 100, 16);
+    for (int m = 0; m < 100; m++) {
+        batch_ok = batch_ok && msgs[m].result == ((m == 42) ? -1 : 0);
+    }
+    batch_ok = batch_ok && failed == 1;
+    printf("ӿ: %s ( %s, ͨ %d)\n", batch_ok ? "ͨ" : "ʧ",
+        SM4_BackendName(SM4_Backend()), SM4_AESNI_Width());
+
+    // 3. :  vs ͨ
+    const size_t sizes[] = { 16, 64, 1024 };
+    for (int k = 0; k < 3; k++) {
+        size_t len = sizes[k];
+        int rounds = (int)((32 << 20) / (len * 64));
+        for (int m = 0; m < 64; m++) {
+            msgs[m].msg = src + m * 700;
+            msgs[m].len = len;
+            msgs[m].tag = tags[m];
+        }
+        clock_t start = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int m = 0; m < 64; m++) {
+                sm4_cmac(&ckey, msgs[m].msg, len, tags[m], 16);
+            }
+        }
+        clock_t end = clock();
+        double t_single = ((double)(end - start)) / CLOCKS_PER_SEC;
+        start = clock();
+        for (int r = 0; r < rounds; r++) {
+            sm4_cmac_batch(&ckey, msgs, 64, 16);
+        }
+        end = clock();
+        double t_batch = ((double)(end - start)) / CLOCKS_PER_SEC;
+        double mb = (double)len * 64 * rounds / (1024 * 1024);
+        printf("%5dֽϢ:  %.2f MB/s,  %.2f MB/s\n",
+            (int)len, mb / t_single, mb / t_batch);
+    }
+
+    return (ok && batch_ok) ? 0 : 1;
+}
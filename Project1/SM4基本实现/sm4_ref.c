@@ -1,39 +1,5 @@
 #include "sm4_ref.h"
 #include <string.h>
-#include <stdio.h>
-#include <time.h>
-
-/*-------------  -------------*/
-static const uint8_t Sbox[256] = {
-    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2, 0x28, 0xfb, 0x2c, 0x05,
-    0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3, 0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99,
-    0x9c, 0x42, 0x50, 0xf4, 0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
-    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa, 0x75, 0x8f, 0x3f, 0xa6,
-    0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba, 0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8,
-    0x68, 0x6b, 0x81, 0xb2, 0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
-    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b, 0x01, 0x21, 0x78, 0x87,
-    0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52, 0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e,
-    0xea, 0xbf, 0x8a, 0xd2, 0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
-    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30, 0xf5, 0x8c, 0xb1, 0xe3,
-    0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60, 0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f,
-    0xd5, 0xdb, 0x37, 0x45, 0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
-    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41, 0x1f, 0x10, 0x5a, 0xd8,
-    0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd, 0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0,
-    0x89, 0x69, 0x97, 0x4a, 0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
-    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e, 0xd7, 0xcb, 0x39, 0x48
-};
-
-static const uint32_t FK[4] = { 0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc };
-static const uint32_t CK[32] = {
-    0x00070e15, 0x1c232a31, 0x383f464d, 0x545b6269,
-    0x70777e85, 0x8c939aa1, 0xa8afb6bd, 0xc4cbd2d9,
-    0xe0e7eef5, 0xfc030a11, 0x181f262d, 0x343b4249,
-    0x50575e65, 0x6c737a81, 0x888f969d, 0xa4abb2b9,
-    0xc0c7ced5, 0xdce3eaf1, 0xf8ff060d, 0x141b2229,
-    0x30373e45, 0x4c535a61, 0x686f767d, 0x848b9299,
-    0xa0a7aeb5, 0xbcc3cad1, 0xd8dfe6ed, 0xf4fb0209,
-    0x10171e25, 0x2c333a41, 0x484f565d, 0x646b7279
-};
 
 /*-------------  -------------*/
 static inline uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
@@ -42,10 +8,10 @@ static inline uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 -
 static inline uint32_t tau(uint32_t x)
 {
     uint32_t y = 0;
-    y |= ((uint32_t)Sbox[(x >> 24) & 0xff]) << 24;
-    y |= ((uint32_t)Sbox[(x >> 16) & 0xff]) << 16;
-    y |= ((uint32_t)Sbox[(x >> 8) & 0xff]) << 8;
-    y |= ((uint32_t)Sbox[(x >> 0) & 0xff]) << 0;
+    y |= ((uint32_t)SM4_SBOX[(x >> 24) & 0xff]) << 24;
+    y |= ((uint32_t)SM4_SBOX[(x >> 16) & 0xff]) << 16;
+    y |= ((uint32_t)SM4_SBOX[(x >> 8) & 0xff]) << 8;
+    y |= ((uint32_t)SM4_SBOX[(x >> 0) & 0xff]) << 0;
     return y;
 }
 
@@ -62,21 +28,19 @@ static inline uint32_t L(uint32_t B)
 /* T: T(X) = L((X)) */
 static inline uint32_t T(uint32_t X) { return L(tau(X)); }
 
-/*------------- Կչ -------------*/
-void sm4_setkey_enc(uint32_t rk[SM4_ROUNDS], const uint8_t key[SM4_KEY_LEN])
+/*------------- ֽ -------------*/
+static inline uint32_t load_be32(const uint8_t* p)
 {
-    uint32_t K[4];
-    memcpy(K, key, 16);
-
-    /*  FK  */
-    for (int i = 0; i < 4; ++i) K[i] ^= FK[i];
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
 
-    for (int i = 0; i < SM4_ROUNDS; ++i) {
-        uint32_t tmp = K[(i + 1) & 3] ^ K[(i + 2) & 3] ^ K[(i + 3) & 3] ^ CK[i];
-        tmp = T(tmp);
-        K[i & 3] ^= tmp;
-        rk[i] = K[i & 3];
-    }
+static inline void store_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
 }
 
 /*------------- /ܵ -------------*/
@@ -84,14 +48,11 @@ void sm4_crypt_ecb(const uint32_t rk[SM4_ROUNDS],
     const uint8_t in[SM4_BLOCK_LEN],
     uint8_t out[SM4_BLOCK_LEN])
 {
-    uint32_t X[4];
-    memcpy(X, in, 16);
-
-    /* ʼ任 */
-    uint32_t B0 = X[0] ^ rk[0];
-    uint32_t B1 = X[1] ^ rk[1];
-    uint32_t B2 = X[2] ^ rk[2];
-    uint32_t B3 = X[3] ^ rk[3];
+    /* ˶ 4  */
+    uint32_t B0 = load_be32(in);
+    uint32_t B1 = load_be32(in + 4);
+    uint32_t B2 = load_be32(in + 8);
+    uint32_t B3 = load_be32(in + 12);
 
     /* 32  Feistel */
     for (int i = 0; i < SM4_ROUNDS; ++i) {
@@ -103,58 +64,18 @@ void sm4_crypt_ecb(const uint32_t rk[SM4_ROUNDS],
         uint32_t t = B0; B0 = B1; B1 = B2; B2 = B3; B3 = t;
     }
 
-    /* 任 */
-    uint32_t Y[4] = { B3 ^ rk[31], B2 ^ rk[30], B1 ^ rk[29], B0 ^ rk[28] };
-    memcpy(out, Y, 16);
+    /* 任 R(X32..X35) = (X35, X34, X33, X32) */
+    store_be32(out, B3);
+    store_be32(out + 4, B2);
+    store_be32(out + 8, B1);
+    store_be32(out + 12, B0);
 }
 
-/*------------- Բ -------------*/
-int main(void)
+/*------------- ӿ (ο) -------------*/
+void sm4_ref_crypt_blocks(const SM4_Key* key, const uint8_t* in, uint8_t* out,
+    size_t nblocks, int enc)
 {
-    const uint8_t key[16] = { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
-                              0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10 };
-    const uint8_t plain[16] = { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
-                                0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10 };
-    uint8_t cipher[16], back[16];
-    uint32_t rk_enc[SM4_ROUNDS], rk_dec[SM4_ROUNDS];
-
-    clock_t start, end;
-    double cpu_time_used;
-    const int iterations = 100000; // ѭ
-
-    // Կչʱ
-    start = clock();
-    for (int i = 0; i < iterations; ++i) {
-        sm4_setkey_enc(rk_enc, key);
-    }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Կչƽʱ: %.8f \n", cpu_time_used / iterations);
-
-    // ʱ
-    start = clock();
-    for (int i = 0; i < iterations; ++i) {
-        sm4_crypt_ecb(rk_enc, plain, cipher);
-    }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
-
-    // ʱ
-    sm4_setkey_dec(rk_dec, rk_enc); // ȷԿ
-    start = clock();
-    for (int i = 0; i < iterations; ++i) {
-        sm4_crypt_ecb(rk_dec, cipher, back);
-    }
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
-
-    /* ֤ */
-    printf("cipher: ");
-    for (int i = 0; i < 16; ++i) printf("%02x", cipher[i]);
-    printf("\nplain : ");
-    for (int i = 0; i < 16; ++i) printf("%02x", back[i]);
-    printf("\n");
-    return 0;
+    const uint32_t* rk = (enc == 0) ? key->rk : key->rk_dec;
+    for (size_t i = 0; i < nblocks; ++i)
+        sm4_crypt_ecb(rk, in + SM4_BLOCK_LEN * i, out + SM4_BLOCK_LEN * i);
 }
\ No newline at end of file
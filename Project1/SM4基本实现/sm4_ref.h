@@ -2,24 +2,28 @@
 #define SM4_REF_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include "../SM4-aesni/sm4_aesni.h"
 
 #define SM4_KEY_LEN      16   /* 128 bit */
 #define SM4_BLOCK_LEN    16   /* 128 bit */
 #define SM4_ROUNDS       32   /* ̶ 32  */
 
-/*  128 bit ûԿ 32 չԿ rk[32] */
-void sm4_setkey_enc(uint32_t rk[SM4_ROUNDS], const uint8_t key[SM4_KEY_LEN]);
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-/* ʱֻ rk 򼴿 */
-static inline void sm4_setkey_dec(uint32_t rk[SM4_ROUNDS], const uint32_t enc_rk[SM4_ROUNDS])
-{
-    for (int i = 0; i < SM4_ROUNDS; ++i)
-        rk[i] = enc_rk[SM4_ROUNDS - 1 - i];
-}
+/* Կͳһ SM4_KeyInit ,  rk_dec */
 
-/* ECB ܣin/out ָ 16 byte */
+/* ECB 飺rk ʹ˳in/out ָ 16 byte */
 void sm4_crypt_ecb(const uint32_t rk[SM4_ROUNDS],
     const uint8_t in[SM4_BLOCK_LEN],
     uint8_t out[SM4_BLOCK_LEN]);
 
+/*  ECB Ĳο sm4_ref_crypt_blocks  sm4_aesni.h */
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* SM4_REF_H */
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "sm4_ref.h"
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    const uint8_t key[16] = { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+                              0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10 };
+    const uint8_t plain[16] = { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+                                0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10 };
+    uint8_t cipher[16], back[16];
+    SM4_Key sm4_key;
+
+    clock_t start, end;
+    double cpu_time_used;
+    const int iterations = 100000; // ѭ
+
+    // Կչʱ
+    start = clock();
+    for (int i = 0; i < iterations; ++i) {
+        SM4_KeyInit((uint8_t*)key, &sm4_key);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("Կչƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // ʱ
+    start = clock();
+    for (int i = 0; i < iterations; ++i) {
+        sm4_crypt_ecb(sm4_key.rk, plain, cipher);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    // ʱ
+    start = clock();
+    for (int i = 0; i < iterations; ++i) {
+        sm4_crypt_ecb(sm4_key.rk_dec, cipher, back);
+    }
+    end = clock();
+    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("ƽʱ: %.8f \n", cpu_time_used / iterations);
+
+    /* ֤ */
+    printf("cipher: ");
+    for (int i = 0; i < 16; ++i) printf("%02x", cipher[i]);
+    printf("\nplain : ");
+    for (int i = 0; i < 16; ++i) printf("%02x", back[i]);
+    printf("\n");
+    return 0;
+}
\ No newline at end of file